@@ -50,34 +50,153 @@ void window_load(Window *window);
 void window_unload(Window *window);
 void tick_handler(struct tm *tick_time, TimeUnits units_changed);
 void start_scba_layer(Layer *layer, uint8_t team);
+bool load_scba_team(uint8_t team);
+void update_clock(struct tm *tick_time);
+void mark_launch_phase(uint8_t phase);
+void first_frame_update_proc(Layer *layer, GContext *ctx);
+void deferred_launch(void *data);
+void open_app_message(void);
+void load_ui_state(void);
+void save_ui_state(void);
+void restore_screen_state(void);
 void click_down(void);
 void click_up(void);
 void click_select(void);
 void click_handler(uint8_t key);
-void switch_scba_selection(uint8_t key);
-void change_scba_nr(uint8_t key);
-void change_bottle_type(uint8_t key);
-void change_bottle_pressure(uint8_t key);
+uint8_t get_scba_team_guards(uint8_t team_nr);
+void action_none(void);
+void action_prev_team(void);
+void action_next_team(void);
+void action_ack_alarm(void);
+void action_open_cnfg(void);
+void action_open_pressure_update(void);
+void action_team_nr_up(void);
+void action_team_nr_down(void);
+void action_confirm_team_nr(void);
+void action_bottle_type_up(void);
+void action_bottle_type_down(void);
+void action_confirm_bottle_type(void);
+void action_pressure_up(void);
+void action_pressure_down(void);
+void action_start_team(void);
+void action_confirm_pressure(void);
+void action_ask_stop(void);
+void action_stop_team(void);
+void action_cancel_stop(void);
+void confirm_scba_team_pressure(void);
+void take_scba_team_reading(uint8_t team, time_t now);
+void show_cnfg_team_nr(void);
+void show_pressure_input(void);
+void get_pressure_input_range(uint16_t *min_pressure, uint16_t *max_pressure);
 void change_active_scba_icon(void);
 void set_text_layer_font(TextLayer *layer, GColor background_color, GColor text_color, GTextAlignment text_alignment, const char* font);
-void update_scba_team_info(uint8_t team_nr);
 bool update_scba_team_info_screen(uint8_t team_nr);
-void reduce_scba_team_air_volume(uint8_t team_nr);
+void show_scba_team_times(uint8_t team_nr);
+void show_scba_team_pressure(uint8_t team_nr);
+void show_scba_team_events(uint8_t team_nr, uint8_t events);
 void calc_scba_team_air_pressure(uint8_t team_nr);
 void update_scba_team_end_time(uint8_t team_nr);
 void calc_scba_team_air_volume(uint8_t team_nr);
 void long_click_select(void);
-void stop_scba_monitoring(uint8_t key);
 void multi_click_up(void);
 void multi_click_down(void);
+void multi_click_release(void);
+void start_auto_repeat(uint8_t key);
+void stop_auto_repeat(void);
 void load_app_configuration(void);
+bool apply_app_configuration(const scba_config_msg_t *config);
+void send_app_configuration(void);
 uint16_t increase_value(uint16_t min, uint16_t max, uint16_t value, bool overflow);
 uint16_t increase_value_with_factor(uint16_t min, uint16_t max, uint16_t value, uint8_t factor, bool overflow);
 uint16_t reduce_value(uint16_t min, uint16_t max, uint16_t value, bool overflow);
 uint16_t reduce_value_with_factor(uint16_t min, uint16_t max, uint16_t value, uint8_t factor, bool overflow);
 void initialize_scba_team(uint8_t team_nr);
+uint16_t get_scba_team_breathing_rate(uint8_t team_nr);
 void long_click_timer_callback(void *data);
 void convert_pressure(uint8_t team_nr);
+void load_icons(void);
+void destroy_icons(void);
+GBitmap* get_icon(GBitmap **icon, uint32_t resource_id);
+void create_scba_info_layer(uint8_t team);
+void destroy_scba_info_layer(uint8_t team);
+void destroy_scba_layer(uint8_t team);
+void show_scba_cnfg_layer(uint8_t team);
+void hide_scba_cnfg_layer(void);
+void destroy_scba_cnfg_layer(void);
+void receive_app_configuration(const Tuple *t);
+void load_sync_state(void);
+void publish_scba_team_change(uint8_t team, uint8_t type);
+void send_sync_deltas(void);
+uint8_t encode_sync_team(uint8_t team, uint8_t *buffer, uint8_t buffer_size);
+void get_sync_delta(uint8_t team, uint8_t type, scba_sync_delta_t *delta);
+void receive_sync_deltas(const Tuple *t);
+void apply_sync_delta(const scba_sync_delta_t *delta);
+void cancel_scba_team_input(uint8_t team);
+void show_scba_team_view(uint8_t team);
+void out_sent_handler(DictionaryIterator *iterator, void *context);
+void out_failed_handler(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+void sync_retry_timer_callback(void *data);
+void schedule_scba_team_check(uint8_t team);
+void arm_reminder_timer(void);
+void reminder_timer_callback(void *data);
+void show_scba_team_overdue(uint8_t team, bool overdue);
+void action_open_overview(void);
+void action_close_overview(void);
+void action_select_first_team(void);
+void update_scba_overview(uint8_t team);
+void update_scba_overview_row(uint8_t team);
+void destroy_scba_overview(void);
+void action_fast_start(void);
+void action_open_correction(void);
+void action_correct_team(void);
+uint8_t get_free_team_nr(uint8_t team);
+void load_scba_history(void);
+void add_scba_team_history(uint8_t team, bool forced);
+void action_open_detail(void);
+void action_close_detail(void);
+void update_scba_detail(void);
+void destroy_scba_detail(void);
+void sparkline_update_proc(Layer *layer, GContext *ctx);
+time_t scba_now(void);
+void write_persist_data(uint32_t key, const void *data, size_t size);
+void enable_scba_backlight(void);
+#ifdef SCBA_TRACE
+void log_scba_trace(void);
+void trace_update_proc(Layer *layer, GContext *ctx);
+#endif // #ifdef SCBA_TRACE
+void persist_scba_team(uint8_t team);
+void delete_scba_team(uint8_t team);
+bool drop_scba_drill_team_air(uint8_t team, time_t now);
+void action_open_drill_setup(void);
+void action_drill_scale(void);
+void action_drill_scenario(void);
+void action_start_drill(void);
+void action_cancel_drill(void);
+void action_end_drill(void);
+void action_ask_end_drill(void);
+void show_drill_setup(void);
+void show_drill_header(void);
+void action_open_handover(void);
+void action_close_handover(void);
+void handover_update_proc(Layer *layer, GContext *ctx);
+void load_scba_ack(void);
+void raise_scba_team_alarm(uint8_t team, uint8_t events);
+void confirm_scba_team_alarm(uint8_t team);
+void action_open_ack_summary(void);
+void action_close_ack_summary(void);
+void action_reset_ack_summary(void);
+void show_scba_ack_summary(void);
+void ack_summary_update_proc(Layer *layer, GContext *ctx);
+void load_scba_sectors(void);
+void action_next_sector(void);
+void action_sector_view(void);
+void layout_scba_overview(void);
+void overview_update_proc(Layer *layer, GContext *ctx);
+void load_scba_roster(void);
+void receive_scba_roster(const Tuple *t);
+void log_scba_team_crew(uint8_t team);
+void detail_update_proc(Layer *layer, GContext *ctx);
+void receive_scba_telemetry(const Tuple *t);
 
 //* -------- global variables ---------- *//
 //                                        //
@@ -86,47 +205,159 @@ Window *g_window;
 
 TextLayer *g_header_layer;
 TextLayer *g_clock_layer;
+char clock_text[] = "00:00";
 
 Layer *g_scba_one_layer;
 Layer *g_scba_two_layer;
 Layer *g_scba_three_layer;
 
+GBitmap *icon_atlas;
+// sub-bitmaps of icon_atlas
 GBitmap *icon_up;
 GBitmap *icon_down;
 GBitmap *icon_ok;
 GBitmap *icon_active_scba;
-GBitmap *icon_full_bottle;
-GBitmap *icon_scba_firefighter;
 GBitmap *icon_small_firefighter;
 GBitmap *icon_small_full_bottle;
 GBitmap *icon_small_third_full_bottle;
 GBitmap *icon_small_half_full_bottle;
 GBitmap *icon_small_third_empty_bottle;
 GBitmap *icon_small_empty_bottle;
-GBitmap *icon_small_stop_signe;
 GBitmap *icon_small_exclamation_mark;
-
-ActionBarLayer *g_action_bar;
-
-AppTimer *long_click_timer;
-
-bool multi_click_up_active = false;
-bool multi_click_down_active = false;
+// rarely used icons, loaded on first use by get_icon()
+GBitmap *icon_full_bottle = NULL;
+GBitmap *icon_scba_firefighter = NULL;
+GBitmap *icon_small_stop_signe = NULL;
+
+ActionBarLayer *g_action_bar = NULL;
+
+scba_cnfg_layer_t scba_cnfg_view;
+
+AppTimer *long_click_timer = NULL;
+uint8_t auto_repeat_key = CLICK_NONE;
+
+scba_sync_store_t scba_sync_data;
+// fields per team changed on this watch and not yet sent / waiting for the ack
+uint8_t scba_sync_pending[SCBA_TEAMS] = {0, 0, 0};
+uint8_t scba_sync_in_flight[SCBA_TEAMS] = {0, 0, 0};
+bool sync_sending = false;  // the outbox is busy, with team changes or the configuration
+bool sync_resend_request = false;
+bool sync_resend_in_flight = false;
+AppTimer *sync_retry_timer = NULL;
+// the configuration in use goes back to the phone after each configuration message
+bool config_reply_pending = false;
+bool config_reply_in_flight = false;
+
+scba_reminder_queue_t scba_reminders;
+AppTimer *reminder_timer = NULL;
+bool scba_team_overdue[SCBA_TEAMS] = {false, false, false};
+
+scba_overview_t scba_overview;
+time_t scba_team_end_time[SCBA_TEAMS] = {0, 0, 0};
+Layer *g_overview_layer = NULL;
+scba_overview_row_t scba_overview_rows[SCBA_TEAMS];
+
+// sector of every team and the aggregates per sector, the view is not kept
+scba_sectors_t scba_sectors;
+uint8_t scba_team_sector[SCBA_TEAMS] = {SCBA_SECTOR_NONE, SCBA_SECTOR_NONE, SCBA_SECTOR_NONE};
+uint8_t scba_sectors_collapsed = 0;
+
+// the running team as it was before its correction was opened
+scba_team_t scba_correction_backup;
+
+// stored as a whole under SCBA_STORE_KEY_HISTORY, 198 bytes
+scba_history_t scba_team_history[SCBA_TEAMS];
+Layer *g_detail_layer = NULL;
+TextLayer *g_detail_text_layer = NULL;
+Layer *g_sparkline_layer = NULL;
+char detail_text[20];
+
+// crew names by team number, sent by the phone, stored as a whole under SCBA_STORE_KEY_ROSTER
+scba_roster_t scba_roster;
+
+// training drill on a virtual clock, its teams live in RAM only
+scba_drill_t scba_drill = {false, 1, 0, 0, 0};
+uint8_t drill_scale_index = 0;     // kept for the next drill
+uint8_t drill_scenario_index = 0;
+uint8_t scba_drill_drops = 0;      // bit n set: team n had the drop of the scenario
+char drill_setup_text[24];
+char drill_header_text[12];
+
+// handover QR code of the running teams, built once when it is opened
+Layer *g_handover_layer = NULL;
+scba_qr_t handover_qr;
+char handover_text[20];
+
+// time from raising an alarm to its acknowledgement, kept across launches
+scba_ack_stats_t scba_ack;
+Layer *g_ack_layer = NULL;
+char ack_text[192];
+
+#ifdef SCBA_TRACE
+// topmost layer, drawn with every frame
+Layer *g_trace_layer = NULL;
+time_t backlight_time = 0;
+#endif // #ifdef SCBA_TRACE
+
+time_t launch_start_time = 0;
+uint16_t launch_start_ms = 0;
+uint16_t launch_profile[SCBA_LAUNCH_PHASES];
+bool first_frame_drawn = false;
+scba_ui_state_t saved_ui_state = {0, SCBA_START_SCREEN};
+
+// indexed by the SCBA_ACTION_* codes of the transition table
+void (* const scba_actions[SCBA_ACTIONS])(void) = {
+  action_none,
+  action_prev_team,
+  action_next_team,
+  action_ack_alarm,
+  action_open_cnfg,
+  action_open_pressure_update,
+  action_team_nr_up,
+  action_team_nr_down,
+  action_confirm_team_nr,
+  action_bottle_type_up,
+  action_bottle_type_down,
+  action_confirm_bottle_type,
+  action_pressure_up,
+  action_pressure_down,
+  action_start_team,
+  action_confirm_pressure,
+  action_ask_stop,
+  action_stop_team,
+  action_cancel_stop,
+  action_open_overview,
+  action_close_overview,
+  action_select_first_team,
+  action_fast_start,
+  action_open_correction,
+  action_correct_team,
+  action_open_detail,
+  action_close_detail,
+  action_open_drill_setup,
+  action_drill_scale,
+  action_drill_scenario,
+  action_start_drill,
+  action_cancel_drill,
+  action_end_drill,
+  action_open_handover,
+  action_close_handover,
+  action_open_ack_summary,
+  action_close_ack_summary,
+  action_reset_ack_summary,
+  action_next_sector,
+  action_sector_view,
+  action_ask_end_drill
+};
 
 uint8_t scba_default_bottle_type = SCBA_DATA_DEFAULT_BOTTLE_TYPE;
-uint8_t scba_bottle_type_available[SCBA_AVAILABLE_BOTTLE_TYPES] = {
-  1,
-  1, 
-  1,
-  1,
-  1,
-  1
-};
 
 uint8_t imperial_units = NOT_AVAILABLE;
 
 uint16_t scba_breathing_rate = SCBA_DEFAULT_AIR_CONSUMPTION;
-uint16_t scba_bottle_config_keys[SCBA_AVAILABLE_BOTTLE_TYPES] = {
+uint8_t scba_check_interval = 0; // in minutes, 0: no gauge check reminders
+scba_config_msg_t scba_config;  // the settings above as the phone sends them
+uint16_t scba_bottle_config_keys[SCBA_DEFAULT_BOTTLE_TYPES] = {
   SCBA_STORE_KEY_BOTTLE_ONE_AVAILABLE,
   SCBA_STORE_KEY_BOTTLE_TWO_AVAILABLE,
   SCBA_STORE_KEY_BOTTLE_THREE_AVAILABLE,
@@ -141,14 +372,6 @@ uint32_t scba_team_storage_keys[SCBA_TEAMS] = {
   SCBA_STORE_KEY_TEAM_THREE
 };
 
-scba_bottle_t  scba_bottle_types[SCBA_AVAILABLE_BOTTLE_TYPES] = {
-  {90,   300,  4500,  80,   (char*)("9l")},
-  {68,   300,  4500,  60,   (char*)("6,8l")}, 
-  {80,   200,  3000,  80,   (char*)("2x4l")},
-  {136,  300,  4500,  120,  (char*)("2x6,8l")},
-  {60,   300,  4500,  53,   (char*)("6l")},
-  {120,  300,  4500,  106,  (char*)("2x6l")}
-};
 //* ----------- functions -------------- *//
 //                                        //
 //* ------------------------------------ *//
@@ -161,9 +384,9 @@ void click_config_provider(void *context)
   window_single_click_subscribe(BUTTON_ID_DOWN, (ClickHandler) click_down);
   window_single_click_subscribe(BUTTON_ID_UP, (ClickHandler) click_up);
   window_single_click_subscribe(BUTTON_ID_SELECT, (ClickHandler) click_select);
-  window_long_click_subscribe(BUTTON_ID_SELECT, 1000, (ClickHandler)long_click_select, (ClickHandler)long_click_select);
-  window_long_click_subscribe(BUTTON_ID_UP, 500, (ClickHandler)multi_click_up, (ClickHandler)multi_click_up);
-  window_long_click_subscribe(BUTTON_ID_DOWN, 500, (ClickHandler)multi_click_down, (ClickHandler)multi_click_down);
+  window_long_click_subscribe(BUTTON_ID_SELECT, 1000, (ClickHandler)long_click_select, NULL);
+  window_long_click_subscribe(BUTTON_ID_UP, 500, (ClickHandler)multi_click_up, (ClickHandler)multi_click_release);
+  window_long_click_subscribe(BUTTON_ID_DOWN, 500, (ClickHandler)multi_click_down, (ClickHandler)multi_click_release);
 }
 
 /**
@@ -173,22 +396,26 @@ void long_click_timer_callback(void *data)
 {
   uint8_t click_delay = LONG_CLICK_CNT_DELAY;
   
-  if((multi_click_up_active == true) && ((screen_status == SCBA_CNFG_SCREEN_BOTTLE_PRESSURE) || (screen_status == SCBA_UPDATE_PRESSURE)))
+  SCBA_TRACE_ADD(SCBA_TRACE_REPEAT_TIMER, 1);
+  long_click_timer = NULL;
+  // the button is still held, repeat it as long as the screen allows it
+  if((auto_repeat_key == CLICK_NONE) || (scba_state_policies[screen_status].repeat_policy != SCBA_REPEAT_FAST))
   {
-    change_bottle_pressure(CLICK_UP);
+    auto_repeat_key = CLICK_NONE;
+    return;
   }
   
-  if((multi_click_down_active == true) && ((screen_status == SCBA_CNFG_SCREEN_BOTTLE_PRESSURE) || (screen_status == SCBA_UPDATE_PRESSURE)))
-  {
-    change_bottle_pressure(CLICK_DOWN);
-  }
+  click_handler(auto_repeat_key);
    
   if(imperial_units == AVAILABLE)
   {
     click_delay = LONG_CLICK_CNT_DELAY / 5;
   }
   
-  long_click_timer = app_timer_register(click_delay, (AppTimerCallback)long_click_timer_callback, NULL);  
+  if(auto_repeat_key != CLICK_NONE)
+  {
+    long_click_timer = app_timer_register(click_delay, (AppTimerCallback)long_click_timer_callback, NULL);  
+  }
 }
 
 /**
@@ -196,65 +423,113 @@ void long_click_timer_callback(void *data)
 */
 void in_recv_handler(DictionaryIterator *iterator, void *context)
 {
-  Tuple *t = dict_read_first(iterator);
-  uint8_t i = 0;
+  Tuple *t = dict_find(iterator, SCBA_MSG_KEY_CONFIG);
   
-  while(t != NULL)
+  SCBA_TRACE_ADD(SCBA_TRACE_MSG_IN, 1);
+  if(t != NULL)
   {
-    switch(t->key)
-    {
-      case SCBA_STORE_KEY_BREATHING_RATE:
-        scba_breathing_rate = atoi(t->value->cstring) * 10;
-        persist_write_int(SCBA_STORE_KEY_BREATHING_RATE, scba_breathing_rate);
-        break;
-      
-      case SCBA_STORE_KEY_BOTTLE_ONE_AVAILABLE:
-        scba_bottle_type_available[0] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_ONE_AVAILABLE, scba_bottle_type_available[0]);
-        break;
-
-      case SCBA_STORE_KEY_BOTTLE_TWO_AVAILABLE:
-        scba_bottle_type_available[1] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_TWO_AVAILABLE, scba_bottle_type_available[1]);
-        break;
-
-      case SCBA_STORE_KEY_BOTTLE_THREE_AVAILABLE:
-        scba_bottle_type_available[2] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_THREE_AVAILABLE, scba_bottle_type_available[2]);
-        break;
-
-      case SCBA_STORE_KEY_BOTTLE_FOUR_AVAILABLE:
-        scba_bottle_type_available[3] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_FOUR_AVAILABLE, scba_bottle_type_available[3]);
-        break;
-
-      case SCBA_STORE_KEY_BOTTLE_FIVE_AVAILABLE:
-        scba_bottle_type_available[4] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_FIVE_AVAILABLE, scba_bottle_type_available[4]);
-        break;
-
-      case SCBA_STORE_KEY_BOTTLE_SIX_AVAILABLE:
-        scba_bottle_type_available[5] = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_BOTTLE_SIX_AVAILABLE, scba_bottle_type_available[5]);
-        break;
-      
-      case SCBA_STORE_KEY_DEFAULT_BOTTLE:
-        scba_default_bottle_type = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_DEFAULT_BOTTLE, scba_default_bottle_type);
-        break;
+    SCBA_TRACE_ADD(SCBA_TRACE_MSG_IN_BYTES, t->length);
+    receive_app_configuration(t);
+  }
+  
+  t = dict_find(iterator, SCBA_MSG_KEY_SYNC);
+  
+  if(t != NULL)
+  {
+    SCBA_TRACE_ADD(SCBA_TRACE_MSG_IN_BYTES, t->length);
+    receive_sync_deltas(t);
+  }
+  
+  t = dict_find(iterator, SCBA_MSG_KEY_ROSTER);
+  
+  if(t != NULL)
+  {
+    SCBA_TRACE_ADD(SCBA_TRACE_MSG_IN_BYTES, t->length);
+    receive_scba_roster(t);
+  }
+  
+  t = dict_find(iterator, SCBA_MSG_KEY_TELEMETRY);
+  
+  if(t != NULL)
+  {
+    SCBA_TRACE_ADD(SCBA_TRACE_MSG_IN_BYTES, t->length);
+    receive_scba_telemetry(t);
+  }
+}
 
-      case SCBA_STORE_KEY_IMPERIAL_UNITS:
-        imperial_units = atoi(t->value->cstring);
-        persist_write_int(SCBA_STORE_KEY_IMPERIAL_UNITS, imperial_units);
-        break;
+/**
+*
+*/
+void receive_app_configuration(const Tuple *t)
+{
+  scba_config_msg_t config;
+  
+  if((t->type == TUPLE_BYTE_ARRAY) && (t->length == 1) && (t->value->data[0] == SCBA_CONFIG_REQUEST))
+  {
+    send_app_configuration();
+    return;
+  }
+  if((t->type != TUPLE_BYTE_ARRAY) || (t->length < SCBA_CONFIG_HEADER_SIZE) || (t->length > sizeof(config)))
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "configuration message rejected");
+    send_app_configuration();
+    return;
+  }
+  
+  memcpy(&config, t->value->data, t->length);
+  
+  if((t->length == SCBA_CONFIG_SIZE(config.bottle_count)) && (apply_app_configuration(&config) == true))
+  {
+    write_persist_data(SCBA_STORE_KEY_CONFIG, &config, t->length);
+  }
+  else
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "configuration message rejected");
+  }
+  // the phone keeps the settings only if the watch answers with them
+  send_app_configuration();
+}
 
-      default:
-        break;
+/**
+*
+*/
+bool apply_app_configuration(const scba_config_msg_t *config)
+{
+  uint8_t i = 0;
+  
+  // validate everything first, so a broken message never changes a single
+  // setting, scba_bottles_load() is the last check and only loads a valid catalog
+  if((config->version != SCBA_CONFIG_VERSION) ||
+     (config->breathing_rate < SCBA_MIN_BREATHING_RATE) || (config->breathing_rate > SCBA_MAX_BREATHING_RATE) ||
+     (config->default_bottle >= config->bottle_count) ||
+     ((config->bottle_mask & (1 << config->default_bottle)) == 0) ||
+     (config->imperial_units > AVAILABLE) ||
+     (config->check_interval > SCBA_MAX_CHECK_INTERVAL) ||
+     (config->bottle_count > SCBA_MAX_BOTTLE_TYPES))
+  {
+    return (false);
+  }
+  // the bottle of a running team must not change under it
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if((scba_team_data[i].scba_team_status != SCBA_NOT_STARTED) &&
+       (scba_bottle_unchanged(scba_team_data[i].scba_team_bottle_type, config->bottles, config->bottle_count) == false))
+    {
+      APP_LOG(APP_LOG_LEVEL_WARNING, "configuration changes the bottle of team %d", scba_team_data[i].scba_team_nr);
+      return (false);
     }
-    
-    t = dict_read_next(iterator);
+  }
+  if(scba_bottles_load(config->bottles, config->bottle_count, config->bottle_mask) == false)
+  {
+    return (false);
   }
   
+  scba_breathing_rate = config->breathing_rate * 10;
+  scba_default_bottle_type = config->default_bottle;
+  imperial_units = config->imperial_units;
+  scba_check_interval = config->check_interval;
+  memcpy(&scba_config, config, SCBA_CONFIG_SIZE(config->bottle_count));
+  
   for (i=0; i<SCBA_TEAMS; i++)
   {
     if(scba_team_data[i].scba_team_status == SCBA_NOT_STARTED)
@@ -265,7 +540,9 @@ void in_recv_handler(DictionaryIterator *iterator, void *context)
     {
       convert_pressure(i);
     }
+    schedule_scba_team_check(i);
   } 
+  return (true);
 }
 
 /**
@@ -273,6 +550,8 @@ void in_recv_handler(DictionaryIterator *iterator, void *context)
 */
 void handle_init(void) 
 {
+  launch_start_ms = time_ms(&launch_start_time, NULL);
+  
   g_window = window_create();
   
   window_set_window_handlers(g_window, (WindowHandlers) {
@@ -290,19 +569,52 @@ void handle_init(void)
   
   tick_timer_service_subscribe(SECOND_UNIT, (TickHandler)tick_handler);
   
+  mark_launch_phase(SCBA_LAUNCH_INIT);
+  // no push animation, the teams have to be readable right away
+  window_stack_push(g_window, false);
+}
+
+/**
+*
+*/
+void open_app_message(void)
+{
+  uint32_t inbox_size = 0;
+  uint32_t outbox_size = 0;
+  
   app_message_register_inbox_received((AppMessageInboxReceived) in_recv_handler);
-  app_message_open(app_message_inbox_size_maximum(), app_message_outbox_size_maximum());
+  app_message_register_outbox_sent((AppMessageOutboxSent) out_sent_handler);
+  app_message_register_outbox_failed((AppMessageOutboxFailed) out_failed_handler);
+  // the inbox takes the configuration or the team changes of another watch,
+  // the watch only sends its own team changes and its configuration
+  inbox_size = dict_calc_buffer_size(1, sizeof(scba_config_msg_t));
+  if(inbox_size < dict_calc_buffer_size(1, SCBA_SYNC_MAX_BATCH_SIZE))
+  {
+    inbox_size = dict_calc_buffer_size(1, SCBA_SYNC_MAX_BATCH_SIZE);
+  }
+  outbox_size = dict_calc_buffer_size(1, SCBA_SYNC_MAX_BATCH_SIZE);
+  app_message_open(inbox_size, outbox_size);
   
-  window_stack_push(g_window, true);
+#ifdef DEBUG
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "AppMessage buffers: %d bytes, %d bytes saved",
+          (int)(inbox_size + outbox_size),
+          (int)((app_message_inbox_size_maximum() + app_message_outbox_size_maximum()) - (inbox_size + outbox_size)));
+#endif // #ifdef DEBUG
 }
 
 /**
-*
+* Builds only what the first frame needs: header, clock and the running
+* teams. The rest follows in deferred_launch() once that frame is drawn.
 */
 void window_load(Window *window)
 {  
+  time_t now = time(NULL);
+  uint8_t i = 0;
+  
   screen_status = SCBA_START_SCREEN;
   active_scba = 0;
+  scba_overview_init(&scba_overview, SCBA_TEAMS);
+  scba_sector_init(&scba_sectors, SCBA_TEAMS);
   
   g_header_layer = text_layer_create(GRect(0,0,60,30));
   text_layer_set_background_color(g_header_layer, GColorClear);
@@ -312,41 +624,36 @@ void window_load(Window *window)
 
   g_clock_layer = text_layer_create(GRect(60,0,60,30));
   set_text_layer_font(g_clock_layer, GColorClear, GColorBlack, GTextAlignmentCenter, FONT_KEY_GOTHIC_18_BOLD);
+  update_clock(localtime(&now));
   
   g_scba_one_layer = layer_create(GRect(0,30,120,43));
   g_scba_two_layer = layer_create(GRect(0,74,120,43));
   g_scba_three_layer = layer_create(GRect(0,117,120,43));
-
-  icon_active_scba = gbitmap_create_with_resource(RESOURCE_ID_ACTIVE_SCBA);
-  icon_full_bottle = gbitmap_create_with_resource(RESOURCE_ID_FULL_BOTTLE);
-  icon_scba_firefighter = gbitmap_create_with_resource(RESOURCE_ID_SCBA_FIREFIGHTER);
-  icon_small_firefighter = gbitmap_create_with_resource(RESOURCE_ID_SMALL_SCBA_FIREFIGHTER);
-  icon_small_full_bottle = gbitmap_create_with_resource(RESOURCE_ID_SMALL_FULL_BOTTLE);
-  icon_small_third_full_bottle = gbitmap_create_with_resource(RESOURCE_ID_SMALL_THIRD_FULL_BOTTLE);
-  icon_small_half_full_bottle = gbitmap_create_with_resource(RESOURCE_ID_SMALL_HALF_FULL_BOTTLE);
-  icon_small_third_empty_bottle = gbitmap_create_with_resource(RESOURCE_ID_SMALL_THIRD_EMPTY_BOTTLE);
-  icon_small_empty_bottle = gbitmap_create_with_resource(RESOURCE_ID_SMALL_EMPTY_BOTTLE);
-  icon_small_stop_signe = gbitmap_create_with_resource(RESOURCE_ID_SMALL_STOP_SIGNE);
-  icon_small_exclamation_mark = gbitmap_create_with_resource(RESOURCE_ID_SMALL_EXCLAMATION_MARK);
+  scba_layer[0].scba_team_layer = g_scba_one_layer;
+  scba_layer[1].scba_team_layer = g_scba_two_layer;
+  scba_layer[2].scba_team_layer = g_scba_three_layer;
+  layer_set_update_proc(g_scba_one_layer, first_frame_update_proc);
   
   load_app_configuration();
+  mark_launch_phase(SCBA_LAUNCH_CONFIG);
   
-  start_scba_layer(g_scba_one_layer, 0);
-  start_scba_layer(g_scba_two_layer, 1);
-  start_scba_layer(g_scba_three_layer, 2);
+  load_icons();
+  mark_launch_phase(SCBA_LAUNCH_RESOURCES);
   
-  g_action_bar = action_bar_layer_create();
-  action_bar_layer_set_background_color(g_action_bar, GColorClear);
-  action_bar_layer_add_to_window(g_action_bar, window);
-  action_bar_layer_set_click_config_provider(g_action_bar, click_config_provider);
-
-  icon_up = gbitmap_create_with_resource(RESOURCE_ID_ARROW_UP);
-  icon_down = gbitmap_create_with_resource(RESOURCE_ID_ARROW_DOWN);
-  icon_ok = gbitmap_create_with_resource(RESOURCE_ID_OK_BTN);
+  load_ui_state();
+  load_scba_history();
+  load_scba_ack();
+  load_scba_sectors();
+  load_scba_roster();
   
-  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_UP, icon_up);
-  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_DOWN, icon_down);
-  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_SELECT, icon_ok);
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if(load_scba_team(i) == true)
+    {
+      start_scba_layer(scba_layer[i].scba_team_layer, i);
+      update_scba_team_info_screen(i);
+    }
+  }
   
   layer_add_child(window_get_root_layer(window), g_scba_one_layer);
   layer_add_child(window_get_root_layer(window), g_scba_two_layer);
@@ -354,32 +661,184 @@ void window_load(Window *window)
   layer_add_child(window_get_root_layer(window), text_layer_get_layer(g_header_layer));
   layer_add_child(window_get_root_layer(window), text_layer_get_layer(g_clock_layer));
   
-  change_active_scba_icon();
+#ifdef SCBA_TRACE
+  g_trace_layer = layer_create(GRect(0,0,1,1));
+  layer_set_update_proc(g_trace_layer, trace_update_proc);
+  layer_add_child(window_get_root_layer(window), g_trace_layer);
+#endif // #ifdef SCBA_TRACE
   
-  long_click_timer = app_timer_register(LONG_CLICK_CNT_DELAY, (AppTimerCallback)long_click_timer_callback, NULL);
+  change_active_scba_icon();
+  mark_launch_phase(SCBA_LAUNCH_LAYERS);
 }
 
 /**
 *
 */
-void start_scba_layer(Layer *layer, uint8_t team)
-{  
-  bool data_loaded = false;
-  // Set default values for the SCBA team
-  if(persist_exists(scba_team_storage_keys[team]))
+void first_frame_update_proc(Layer *layer, GContext *ctx)
+{
+  if(first_frame_drawn == true)
   {
-    persist_read_data(scba_team_storage_keys[team], &scba_team_data[team], sizeof(scba_team_data[team]));
-    
-    if(scba_team_data[team].scba_team_pressure_psi != imperial_units)
+    return;
+  }
+  first_frame_drawn = true;
+  mark_launch_phase(SCBA_LAUNCH_FIRST_FRAME);
+  app_timer_register(0, (AppTimerCallback)deferred_launch, NULL);
+}
+
+/**
+*
+*/
+void deferred_launch(void *data)
+{
+  uint8_t i = 0;
+  
+  SCBA_TRACE_ADD(SCBA_TRACE_TIMER, 1);
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if(scba_layer[i].start_layer == NULL)
     {
-      convert_pressure(team);
+      start_scba_layer(scba_layer[i].scba_team_layer, i);
     }
-    data_loaded = true;
   }
-  else
+  change_active_scba_icon();
+  
+  g_action_bar = action_bar_layer_create();
+  action_bar_layer_set_background_color(g_action_bar, GColorClear);
+  action_bar_layer_add_to_window(g_action_bar, g_window);
+  action_bar_layer_set_click_config_provider(g_action_bar, click_config_provider);
+
+  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_UP, icon_up);
+  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_DOWN, icon_down);
+  action_bar_layer_set_icon(g_action_bar, BUTTON_ID_SELECT, icon_ok);
+  
+  // the reminders are due relative to the stored reports, overdue teams
+  // get flagged right away
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    schedule_scba_team_check(i);
+  }
+  
+  load_sync_state();
+  open_app_message();
+  restore_screen_state();
+  mark_launch_phase(SCBA_LAUNCH_DEFERRED);
+  
+  APP_LOG(APP_LOG_LEVEL_INFO, "launch ms: init %d, config %d, resources %d, layers %d, first frame %d, deferred %d",
+          launch_profile[SCBA_LAUNCH_INIT], launch_profile[SCBA_LAUNCH_CONFIG], launch_profile[SCBA_LAUNCH_RESOURCES],
+          launch_profile[SCBA_LAUNCH_LAYERS], launch_profile[SCBA_LAUNCH_FIRST_FRAME], launch_profile[SCBA_LAUNCH_DEFERRED]);
+#ifdef DEBUG
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "heap after launch: %d bytes used, %d bytes free", (int)heap_bytes_used(), (int)heap_bytes_free());
+#endif // #ifdef DEBUG
+}
+
+/**
+*
+*/
+void mark_launch_phase(uint8_t phase)
+{
+  time_t seconds = 0;
+  uint16_t milliseconds = time_ms(&seconds, NULL);
+  
+  launch_profile[phase] = ((seconds - launch_start_time) * 1000) + milliseconds - launch_start_ms;
+}
+
+/**
+*
+*/
+void load_ui_state(void)
+{
+  if(persist_exists(SCBA_STORE_KEY_UI_STATE))
+  {
+    persist_read_data(SCBA_STORE_KEY_UI_STATE, &saved_ui_state, sizeof(saved_ui_state));
+  }
+  
+  if((saved_ui_state.active_scba >= SCBA_TEAMS) || (saved_ui_state.screen_status >= SCBA_SCREENS))
+  {
+    saved_ui_state.active_scba = 0;
+    saved_ui_state.screen_status = SCBA_START_SCREEN;
+  }
+  active_scba = saved_ui_state.active_scba;
+}
+
+/**
+*
+*/
+void save_ui_state(void)
+{
+  if((saved_ui_state.active_scba != active_scba) || (saved_ui_state.screen_status != screen_status))
+  {
+    saved_ui_state.active_scba = active_scba;
+    saved_ui_state.screen_status = screen_status;
+    write_persist_data(SCBA_STORE_KEY_UI_STATE, &saved_ui_state, sizeof(saved_ui_state));
+  }
+}
+
+/**
+* Reopens the input the app was left in. Unconfirmed values were never
+* stored, so the team configuration starts over and the pressure update
+* starts at the last confirmed pressure. The stop question is not restored.
+*/
+void restore_screen_state(void)
+{
+  bool started = (scba_team_data[active_scba].scba_team_status != SCBA_NOT_STARTED);
+  
+  switch(saved_ui_state.screen_status)
+  {
+    case SCBA_CNFG_SCREEN_NR:
+    case SCBA_CNFG_SCREEN_BOTTLE_TYPE:
+    case SCBA_CNFG_SCREEN_BOTTLE_PRESSURE:
+      if(started == false)
+      {
+        action_open_cnfg();
+        screen_status = SCBA_CNFG_SCREEN_NR;
+      }
+      break;
+    
+    case SCBA_UPDATE_PRESSURE:
+      if(started == true)
+      {
+        action_open_pressure_update();
+        screen_status = SCBA_UPDATE_PRESSURE;
+      }
+      break;
+    
+    default:
+      break;
+  }
+  save_ui_state();
+}
+
+/**
+* Reads the stored record of a team, returns true for a running team.
+*/
+bool load_scba_team(uint8_t team)
+{
+  if(persist_exists(scba_team_storage_keys[team]) == false)
   {
     initialize_scba_team(team);
+    return (false);
+  }
+  
+  // records of older versions are shorter, missing fields stay zero
+  memset(&scba_team_data[team], 0, sizeof(scba_team_data[team]));
+  persist_read_data(scba_team_storage_keys[team], &scba_team_data[team], sizeof(scba_team_data[team]));
+  
+  if(scba_team_data[team].scba_team_report_time == 0)
+  {
+    scba_team_data[team].scba_team_report_time = scba_team_data[team].scba_team_start_time;
   }
+  if(scba_team_data[team].scba_team_pressure_psi != imperial_units)
+  {
+    convert_pressure(team);
+  }
+  return (true);
+}
+
+/**
+*
+*/
+void start_scba_layer(Layer *layer, uint8_t team)
+{  
   // Add objects for SCBA start screen
   scba_layer[team].start_layer = text_layer_create(GRect(10,0,110,40));
   set_text_layer_font(scba_layer[team].start_layer, GColorClear, GColorBlack, GTextAlignmentCenter, FONT_KEY_GOTHIC_14);
@@ -387,19 +846,31 @@ void start_scba_layer(Layer *layer, uint8_t team)
   // Add object for active SCBA indicator
   scba_layer[team].active_layer = bitmap_layer_create(GRect(0,0,10,40));
   bitmap_layer_set_bitmap(scba_layer[team].active_layer, icon_active_scba);
-  // Add general objects for the configuration input
-  scba_layer[team].scba_cnfg_layer = layer_create(GRect(10,0,110,40));  
-  scba_layer[team].cnfg_text_layer = text_layer_create(GRect(30,0,40,40));
-  scba_layer[team].cnfg_text_layer_input = text_layer_create(GRect(70,0,40,40));
-  scba_layer[team].cnfg_bitmap_layer = bitmap_layer_create(GRect(0,0,30,40));
-  set_text_layer_font(scba_layer[team].cnfg_text_layer, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_14);
-  set_text_layer_font(scba_layer[team].cnfg_text_layer_input, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_18_BOLD);
-  text_layer_set_text(scba_layer[team].cnfg_text_layer, "TEAM\nNr.:");
-  bitmap_layer_set_bitmap(scba_layer[team].cnfg_bitmap_layer, icon_scba_firefighter);
-  layer_add_child(scba_layer[team].scba_cnfg_layer, bitmap_layer_get_layer(scba_layer[team].cnfg_bitmap_layer));
-  layer_add_child(scba_layer[team].scba_cnfg_layer, text_layer_get_layer(scba_layer[team].cnfg_text_layer_input));
-  layer_add_child(scba_layer[team].scba_cnfg_layer, text_layer_get_layer(scba_layer[team].cnfg_text_layer));
-  layer_set_hidden((Layer *)scba_layer[team].scba_cnfg_layer, true);
+  // Add all childs to the main layer
+  scba_layer[team].scba_team_layer = layer;
+  layer_add_child(layer, text_layer_get_layer(scba_layer[team].start_layer));
+  layer_add_child(layer, bitmap_layer_get_layer(scba_layer[team].active_layer));
+  // the info layer is only built for started teams, the configuration
+  // layer is shared and built when the first team gets configured
+  if(scba_team_data[team].scba_team_status != SCBA_NOT_STARTED)
+  {
+      layer_set_hidden((Layer *)scba_layer[team].start_layer, true);
+      create_scba_info_layer(team);
+      update_scba_team_end_time(team);
+      screen_status = SCBA_INFO_SCREEN;
+  } 
+}
+
+/**
+*
+*/
+void create_scba_info_layer(uint8_t team)
+{
+  if(scba_layer[team].scba_info_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_layer[team].scba_info_layer, false);
+    return;
+  }
   // Add info layer for showing the actual SCBA team information
   scba_layer[team].scba_info_layer = layer_create(GRect(10,0,110,43));
   scba_layer[team].scba_info_team_layer = bitmap_layer_create(GRect(0,0,20,19));  
@@ -445,72 +916,278 @@ void start_scba_layer(Layer *layer, uint8_t team)
   layer_add_child(scba_layer[team].scba_info_layer, text_layer_get_layer(scba_layer[team].scba_bottle_pressure));
   layer_add_child(scba_layer[team].scba_info_layer, bitmap_layer_get_layer(scba_layer[team].scba_bottle_layer));
 
-  layer_set_hidden((Layer *)scba_layer[team].scba_info_layer, true);  
-  // Add all childs to the main layer
-  layer_add_child(layer, text_layer_get_layer(scba_layer[team].start_layer));
-  layer_add_child(layer, bitmap_layer_get_layer(scba_layer[team].active_layer));
-  layer_add_child(layer, scba_layer[team].scba_info_layer);
-  layer_add_child(layer, scba_layer[team].scba_cnfg_layer);
+  layer_add_child(scba_layer[team].scba_team_layer, scba_layer[team].scba_info_layer);
+  show_scba_team_overdue(team, scba_team_overdue[team]);
+}
+
+/**
+*
+*/
+void destroy_scba_info_layer(uint8_t team)
+{
+  if(scba_layer[team].scba_info_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(scba_layer[team].scba_info_layer);
   
-  if(data_loaded == true)
+  bitmap_layer_destroy(scba_layer[team].scba_info_team_layer);
+  text_layer_destroy(scba_layer[team].scba_team_nr);
+  text_layer_destroy(scba_layer[team].scba_start_time_text);
+  text_layer_destroy(scba_layer[team].scba_end_time_text);
+  text_layer_destroy(scba_layer[team].scba_passed_time_text);
+  text_layer_destroy(scba_layer[team].scba_start_time);
+  text_layer_destroy(scba_layer[team].scba_end_time);
+  text_layer_destroy(scba_layer[team].scba_passed_time);
+  text_layer_destroy(scba_layer[team].scba_bottle_pressure);
+  bitmap_layer_destroy(scba_layer[team].scba_bottle_layer);
+  layer_destroy(scba_layer[team].scba_info_layer);
+  
+  scba_layer[team].scba_info_layer = NULL;
+}
+
+/**
+* Counterpart of start_scba_layer(), the team layer itself stays.
+*/
+void destroy_scba_layer(uint8_t team)
+{
+  destroy_scba_info_layer(team);
+  if(scba_layer[team].start_layer == NULL)
   {
-      layer_set_hidden((Layer *)scba_layer[team].start_layer, true);
-      layer_set_hidden((Layer *)scba_layer[team].scba_info_layer, false);  
-      update_scba_team_end_time(team);
-      screen_status = SCBA_INFO_SCREEN;
-  } 
+    return;
+  }
+  text_layer_destroy(scba_layer[team].start_layer);
+  bitmap_layer_destroy(scba_layer[team].active_layer);
+  scba_layer[team].start_layer = NULL;
+  scba_layer[team].active_layer = NULL;
 }
 
 /**
 *
 */
-void window_unload(Window *window)
+void show_scba_cnfg_layer(uint8_t team)
 {
-  text_layer_destroy(g_header_layer);
-  text_layer_destroy(g_clock_layer);
-  app_timer_cancel(long_click_timer);
+  // Add general objects for the configuration input, shared by all teams
+  if(scba_cnfg_view.scba_cnfg_layer == NULL)
+  {
+    scba_cnfg_view.scba_cnfg_layer = layer_create(GRect(10,0,110,40));  
+    scba_cnfg_view.cnfg_text_layer = text_layer_create(GRect(30,0,40,40));
+    scba_cnfg_view.cnfg_text_layer_input = text_layer_create(GRect(70,0,40,40));
+    scba_cnfg_view.cnfg_bitmap_layer = bitmap_layer_create(GRect(0,0,30,40));
+    set_text_layer_font(scba_cnfg_view.cnfg_text_layer, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_14);
+    set_text_layer_font(scba_cnfg_view.cnfg_text_layer_input, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_18_BOLD);
+    layer_add_child(scba_cnfg_view.scba_cnfg_layer, bitmap_layer_get_layer(scba_cnfg_view.cnfg_bitmap_layer));
+    layer_add_child(scba_cnfg_view.scba_cnfg_layer, text_layer_get_layer(scba_cnfg_view.cnfg_text_layer_input));
+    layer_add_child(scba_cnfg_view.scba_cnfg_layer, text_layer_get_layer(scba_cnfg_view.cnfg_text_layer));
+  }
+  else
+  {
+    layer_remove_from_parent(scba_cnfg_view.scba_cnfg_layer);
+  }
+  
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer, "TEAM\nNr.:");
+  bitmap_layer_set_bitmap(scba_cnfg_view.cnfg_bitmap_layer, get_icon(&icon_scba_firefighter, RESOURCE_ID_SCBA_FIREFIGHTER));
+  layer_add_child(scba_layer[team].scba_team_layer, scba_cnfg_view.scba_cnfg_layer);
+  layer_set_hidden((Layer *)scba_cnfg_view.scba_cnfg_layer, false);
 }
 
 /**
 *
 */
-void handle_deinit(void) 
+void hide_scba_cnfg_layer(void)
 {
-  window_destroy(g_window);
+  if(scba_cnfg_view.scba_cnfg_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_cnfg_view.scba_cnfg_layer, true);
+  }
 }
 
 /**
 *
 */
-void tick_handler(struct tm *tick_time, TimeUnits units_changed)
+void destroy_scba_cnfg_layer(void)
 {
-  static char buffer[] = "00:00";
-  static uint8_t cnt[3] = {0,0,0};
-  bool least_one_alarm_active = false;
-  bool temp_alarm = false;
-  uint8_t i=0;
+  if(scba_cnfg_view.scba_cnfg_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(scba_cnfg_view.scba_cnfg_layer);
+  text_layer_destroy(scba_cnfg_view.cnfg_text_layer);
+  text_layer_destroy(scba_cnfg_view.cnfg_text_layer_input);
+  bitmap_layer_destroy(scba_cnfg_view.cnfg_bitmap_layer);
+  layer_destroy(scba_cnfg_view.scba_cnfg_layer);
+  scba_cnfg_view.scba_cnfg_layer = NULL;
+}
+
+/**
+*
+*/
+void window_unload(Window *window)
+{
+  uint8_t i = 0;
+  
+  text_layer_destroy(g_header_layer);
+  text_layer_destroy(g_clock_layer);
+  stop_auto_repeat();
+  destroy_scba_cnfg_layer();
+  action_close_handover();
+  action_close_ack_summary();
+  destroy_scba_overview();
+  destroy_scba_detail();
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    destroy_scba_layer(i);
+  }
+  layer_destroy(g_scba_one_layer);
+  layer_destroy(g_scba_two_layer);
+  layer_destroy(g_scba_three_layer);
+  // the action bar is only built once the first frame was drawn
+  if(g_action_bar != NULL)
+  {
+    action_bar_layer_remove_from_window(g_action_bar);
+    action_bar_layer_destroy(g_action_bar);
+    g_action_bar = NULL;
+  }
+  // the layers above still showed the icons
+  destroy_icons();
+#ifdef SCBA_TRACE
+  layer_destroy(g_trace_layer);
+  g_trace_layer = NULL;
+#endif // #ifdef SCBA_TRACE
+}
+
+/**
+*
+*/
+void load_icons(void)
+{
+  // all frequently drawn icons share one decoded atlas bitmap
+  icon_atlas = gbitmap_create_with_resource(RESOURCE_ID_SCBA_ICONS);
+  
+  icon_up = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_ARROW_UP);
+  icon_down = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_ARROW_DOWN);
+  icon_ok = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_OK_BTN);
+  icon_active_scba = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_ACTIVE_SCBA);
+  icon_small_firefighter = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_SCBA_FIREFIGHTER);
+  icon_small_full_bottle = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_FULL_BOTTLE);
+  icon_small_third_full_bottle = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_THIRD_FULL_BOTTLE);
+  icon_small_half_full_bottle = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_HALF_FULL_BOTTLE);
+  icon_small_third_empty_bottle = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_THIRD_EMPTY_BOTTLE);
+  icon_small_empty_bottle = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_EMPTY_BOTTLE);
+  icon_small_exclamation_mark = gbitmap_create_as_sub_bitmap(icon_atlas, ICON_RECT_SMALL_EXCLAMATION_MARK);
+}
+
+/**
+*
+*/
+void destroy_icons(void)
+{
+  uint8_t i;
+  GBitmap **icons[] = {
+    &icon_up, &icon_down, &icon_ok, &icon_active_scba, &icon_small_firefighter,
+    &icon_small_full_bottle, &icon_small_third_full_bottle, &icon_small_half_full_bottle,
+    &icon_small_third_empty_bottle, &icon_small_empty_bottle, &icon_small_exclamation_mark,
+    &icon_full_bottle, &icon_scba_firefighter, &icon_small_stop_signe,
+    // the atlas has to outlive its sub-bitmaps
+    &icon_atlas
+  };
   
-  strftime(buffer, sizeof("00:00"), "%H:%M", tick_time);
+  for(i=0; i<ARRAY_LENGTH(icons); i++)
+  {
+    if(*icons[i] != NULL)
+    {
+      gbitmap_destroy(*icons[i]);
+      *icons[i] = NULL;
+    }
+  }
+}
+
+/**
+*
+*/
+GBitmap* get_icon(GBitmap **icon, uint32_t resource_id)
+{
+  if(*icon == NULL)
+  {
+    *icon = gbitmap_create_with_resource(resource_id);
+  }
+  return (*icon);
+}
+
+/**
+*
+*/
+void handle_deinit(void) 
+{
+  tick_timer_service_unsubscribe();
+  app_message_deregister_callbacks();
+  window_destroy(g_window);
+}
+
+/**
+*
+*/
+void tick_handler(struct tm *tick_time, TimeUnits units_changed)
+{
+  static uint16_t cnt[SCBA_TEAMS] = {0,0,0};
+  static time_t last_tick = 0;
+  time_t now = scba_now();
+  uint16_t seconds = 1;
+  bool least_one_alarm_active = false;
+  bool temp_alarm = false;
+  bool air_changed = false;
+  uint8_t i=0;
   
-  text_layer_set_text(g_clock_layer, buffer);
+  SCBA_TRACE_ADD(SCBA_TRACE_TICK, 1);
+  update_clock(localtime(&now));
+  
+  // in a drill one tick covers several seconds of the virtual clock, all
+  // of them are counted so no deduction is dropped
+  if((last_tick != 0) && (now > last_tick) && ((now - last_tick) <= SCBA_MAX_TICK_SECONDS))
+  {
+    seconds = now - last_tick;
+  }
+  last_tick = now;
   
   for(i=0; i< SCBA_TEAMS; i++)
   {
+    // a running team being corrected is left alone until the correction is confirmed
+    if((scba_state_policies[screen_status].tick_policy == SCBA_TICK_FREEZE_ACTIVE) && (i == active_scba))
+    {
+      continue;
+    }
     if(scba_team_data[i].scba_team_status != SCBA_NOT_STARTED)  
     {
-      if((cnt[i] >= 30) && (screen_status != SCBA_UPDATE_PRESSURE))
+      cnt[i] += seconds;
+      
+      if(scba_state_policies[screen_status].tick_policy == SCBA_TICK_FREEZE_AIR)
       {
-        reduce_scba_team_air_volume(i);
-        update_scba_team_end_time(i);
-        calc_scba_team_air_pressure(i);
-        persist_write_data(scba_team_storage_keys[i], &scba_team_data[i], sizeof(scba_team_data[i]));
-        cnt[i] = 0;
+        // the air is taken off as soon as the update is left
+        cnt[i] = (cnt[i] > SCBA_MODEL_BREATH_PERIOD) ? SCBA_MODEL_BREATH_PERIOD : cnt[i];
       }
       else
       {
-        cnt[i]++;
+        air_changed = drop_scba_drill_team_air(i, now);
+        
+        if(scba_model_breathe(&scba_team_data[i], &cnt[i], get_scba_team_breathing_rate(i)) == true)
+        {
+          air_changed = true;
+        }
+        if(air_changed == true)
+        {
+          update_scba_team_end_time(i);
+          calc_scba_team_air_pressure(i);
+          persist_scba_team(i);
+          add_scba_team_history(i, false);
+        }
       }
       
+      // the pressure being entered is a preview, it raises no alarm before it is confirmed
+      if((screen_status == SCBA_UPDATE_PRESSURE) && (i == active_scba))
+      {
+        show_scba_team_times(i);
+        continue;
+      }
       temp_alarm = update_scba_team_info_screen(i);
       
       if(temp_alarm == true)
@@ -526,8 +1203,24 @@ void tick_handler(struct tm *tick_time, TimeUnits units_changed)
   
   if(least_one_alarm_active == true)
   {
-    light_enable_interaction();  
+    enable_scba_backlight();
+  }
+  
+#ifdef SCBA_TRACE
+  if((scba_trace_get(SCBA_TRACE_TICK) % SCBA_TRACE_PERIOD) == 0)
+  {
+    log_scba_trace();
   }
+#endif // #ifdef SCBA_TRACE
+}
+
+/**
+*
+*/
+void update_clock(struct tm *tick_time)
+{
+  strftime(clock_text, sizeof(clock_text), "%H:%M", tick_time);
+  text_layer_set_text(g_clock_layer, clock_text);
 }
 
 /**
@@ -559,10 +1252,7 @@ void click_select(void)
 */
 void long_click_select(void)
 {
-  layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, false);
-  layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, true);  
-  text_layer_set_text(scba_layer[active_scba].start_layer, "Stop SCBA monitoring?");
-  screen_status = SCBA_STOP_MONITORING;
+  click_handler(CLICK_LONG_SELECT);
 }
 
 /**
@@ -570,257 +1260,2092 @@ void long_click_select(void)
 */
 void multi_click_up(void)
 {
-  if(multi_click_up_active == false)
+  // holding the button repeats it on input screens and is a click of its own elsewhere
+  if(scba_state_policies[screen_status].repeat_policy == SCBA_REPEAT_FAST)
   {
-    multi_click_up_active = true;
+    start_auto_repeat(CLICK_UP);
   }
   else
   {
-    multi_click_up_active = false;
+    click_handler(CLICK_LONG_UP);
+  }
+}
+
+/**
+*
+*/
+void multi_click_down(void)
+{
+  if(scba_state_policies[screen_status].repeat_policy == SCBA_REPEAT_FAST)
+  {
+    start_auto_repeat(CLICK_DOWN);
+  }
+  else
+  {
+    click_handler(CLICK_LONG_DOWN);
+  }
+}
+
+/**
+*
+*/
+void multi_click_release(void)
+{
+  stop_auto_repeat();
+}
+
+/**
+*
+*/
+void start_auto_repeat(uint8_t key)
+{
+  stop_auto_repeat();
+  
+  if(scba_state_policies[screen_status].repeat_policy == SCBA_REPEAT_FAST)
+  {
+    auto_repeat_key = key;
+    long_click_timer = app_timer_register(LONG_CLICK_CNT_DELAY, (AppTimerCallback)long_click_timer_callback, NULL);
+  }
+}
+
+/**
+*
+*/
+void stop_auto_repeat(void)
+{
+  if(long_click_timer != NULL)
+  {
+    app_timer_cancel(long_click_timer);
+    long_click_timer = NULL;
+  }
+  auto_repeat_key = CLICK_NONE;
+}
+
+/**
+*
+*/
+void click_handler(uint8_t key)
+{
+  const scba_transition_t *transition = scba_find_transition(screen_status, key, get_scba_team_guards(active_scba));
+  
+  if(transition != NULL)
+  {
+    scba_actions[transition->action]();
+    screen_status = transition->next_state;
+    save_ui_state();
+  }
+}
+
+/**
+*
+*/
+uint8_t get_scba_team_guards(uint8_t team_nr)
+{
+  uint8_t status = scba_team_data[team_nr].scba_team_status;
+  uint8_t common = (scba_sector_used(&scba_sectors) == true) ? SCBA_GUARD_SECTORS : 0;  // of every team
+  uint8_t i = 0;
+  
+  if(scba_drill.active == true)
+  {
+    common |= SCBA_GUARD_DRILL;
+  }
+  if(status == SCBA_NOT_STARTED)
+  {
+    if(scba_drill.active == true)
+    {
+      return (SCBA_GUARD_NOT_STARTED | SCBA_GUARD_DRILL_IDLE | common);
+    }
+    for(i=0; i<SCBA_TEAMS; i++)
+    {
+      if(scba_team_data[i].scba_team_status != SCBA_NOT_STARTED)
+      {
+        return (SCBA_GUARD_NOT_STARTED | common);
+      }
+    }
+    return (SCBA_GUARD_NOT_STARTED | SCBA_GUARD_ALL_IDLE | common);
+  }
+  else if(scba_model_confirmed_status(status) != status)
+  {
+    return (SCBA_GUARD_STARTED | SCBA_GUARD_ALARM_PENDING | common);
   }
+  return (SCBA_GUARD_STARTED | common);
+}
+
+/**
+*
+*/
+void action_none(void)
+{
+}
+
+/**
+*
+*/
+void action_prev_team(void)
+{
+  active_scba = reduce_value(0, (SCBA_TEAMS-1), active_scba, true);
+  change_active_scba_icon();
+}
+
+/**
+*
+*/
+void action_next_team(void)
+{
+  active_scba = increase_value(0, (SCBA_TEAMS-1), active_scba, true);
+  change_active_scba_icon();
+}
+
+/**
+*
+*/
+void action_ack_alarm(void)
+{
+  text_layer_set_text_color(scba_layer[active_scba].scba_team_nr, GColorBlack);
+  text_layer_set_background_color(scba_layer[active_scba].scba_team_nr, GColorClear);
+  scba_team_data[active_scba].scba_team_status = scba_model_confirmed_status(scba_team_data[active_scba].scba_team_status);
+  update_scba_overview(active_scba);
+  publish_scba_team_change(active_scba, SCBA_SYNC_ACK);
+  confirm_scba_team_alarm(active_scba);
+}
+
+/**
+*
+*/
+void action_open_cnfg(void)
+{
+  layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, true);
+  show_scba_cnfg_layer(active_scba);
+  show_cnfg_team_nr();
+}
+
+/**
+*
+*/
+void action_open_pressure_update(void)
+{
+  // the mayday has no acknowledgement of its own, the commander reacts to it here
+  confirm_scba_team_alarm(active_scba);
+#ifdef PBL_COLOR
+  text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorWhite);
+#else        
+  text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorClear);   
+#endif // #ifdef PBL_COLOR
+  text_layer_set_background_color(scba_layer[active_scba].scba_bottle_pressure, GColorBlack); 
+}
+
+/**
+*
+*/
+void action_team_nr_up(void)
+{
+  scba_team_data[active_scba].scba_team_nr = increase_value(1, SCBA_TEAM_HIGHEST_NR, scba_team_data[active_scba].scba_team_nr, true);
+  show_cnfg_team_nr();
+}
+
+/**
+*
+*/
+void action_team_nr_down(void)
+{
+  scba_team_data[active_scba].scba_team_nr = reduce_value(1, SCBA_TEAM_HIGHEST_NR, scba_team_data[active_scba].scba_team_nr, true);
+  show_cnfg_team_nr();
+}
+
+/**
+*
+*/
+void show_cnfg_team_nr(void)
+{
+  mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_nr);
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, text_buffer); 
+}
+
+/**
+*
+*/
+void action_confirm_team_nr(void)
+{
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer, "Size:");
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_name);
+  bitmap_layer_set_bitmap(scba_cnfg_view.cnfg_bitmap_layer, get_icon(&icon_full_bottle, RESOURCE_ID_FULL_BOTTLE));
+}
+
+/**
+*
+*/
+void action_bottle_type_up(void)
+{
+  scba_team_data[active_scba].scba_team_bottle_type = scba_bottle_next(scba_team_data[active_scba].scba_team_bottle_type);
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_name);  
+}
+
+/**
+*
+*/
+void action_bottle_type_down(void)
+{
+  scba_team_data[active_scba].scba_team_bottle_type = scba_bottle_prev(scba_team_data[active_scba].scba_team_bottle_type);
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_name);  
+}
+
+/**
+*
+*/
+void action_confirm_bottle_type(void)
+{
+  // set default pressure according to the selected bottle type
+  scba_team_data[active_scba].scba_team_bottle_pressure = scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].levels[imperial_units].full_pressure;
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer, "Pressure:");
+  mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_bottle_pressure);
+  text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, text_buffer);
+}
+
+/**
+*
+*/
+void action_pressure_up(void)
+{
+  uint16_t max_pressure = 0;
+  uint16_t min_pressure = 0;
+  
+  get_pressure_input_range(&min_pressure, &max_pressure);
+  scba_team_data[active_scba].scba_team_bottle_pressure = increase_value(min_pressure, max_pressure, scba_team_data[active_scba].scba_team_bottle_pressure, false);    
+  show_pressure_input();
+}
+
+/**
+*
+*/
+void action_pressure_down(void)
+{
+  uint16_t max_pressure = 0;
+  uint16_t min_pressure = 0;
+  
+  get_pressure_input_range(&min_pressure, &max_pressure);
+  scba_team_data[active_scba].scba_team_bottle_pressure = reduce_value(min_pressure, max_pressure, scba_team_data[active_scba].scba_team_bottle_pressure, false);    
+  show_pressure_input();
+}
+
+/**
+*
+*/
+void get_pressure_input_range(uint16_t *min_pressure, uint16_t *max_pressure)
+{
+  const scba_pressure_levels_t *levels = &scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].levels[imperial_units];
+  
+  *max_pressure = levels->max_input_pressure;
+  *min_pressure = levels->min_pressure;
+}
+
+/**
+*
+*/
+void show_pressure_input(void)
+{
+  if(screen_status == SCBA_UPDATE_PRESSURE)
+  {
+    show_scba_team_pressure(active_scba);
+  }
+  else
+  {
+    mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_bottle_pressure);
+    text_layer_set_text(scba_cnfg_view.cnfg_text_layer_input, text_buffer);
+  }
+}
+
+/**
+*
+*/
+void action_start_team(void)
+{
+  hide_scba_cnfg_layer();
+  create_scba_info_layer(active_scba);
+  scba_team_data[active_scba].scba_team_start_time = scba_now();
+  scba_drill_drops &= ~(1 << active_scba);
+  scba_team_data[active_scba].scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
+  scba_rate_reset(&scba_team_data[active_scba].scba_team_rate);
+  scba_history_reset(&scba_team_history[active_scba]);
+  confirm_scba_team_pressure();
+  publish_scba_team_change(active_scba, SCBA_SYNC_START);
+  log_scba_team_crew(active_scba);
+}
+
+/**
+* Starts the team right away with the next free team number and the
+* default bottle at its full pressure, the details can be corrected later.
+*/
+void action_fast_start(void)
+{
+  scba_team_t *data = &scba_team_data[active_scba];
+  
+  data->scba_team_nr = get_free_team_nr(active_scba);
+  data->scba_team_bottle_type = scba_default_bottle_type;
+  data->scba_team_bottle_pressure = scba_bottle_types[scba_default_bottle_type].levels[imperial_units].full_pressure;
+  
+  layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, true);
+  action_start_team();
+}
+
+/**
+* Lowest team number no other running team has, the slot number if all are taken.
+*/
+uint8_t get_free_team_nr(uint8_t team)
+{
+  uint8_t nr = 0;
+  uint8_t i = 0;
+  
+  for(nr=1; nr<=SCBA_TEAM_HIGHEST_NR; nr++)
+  {
+    for(i=0; i<SCBA_TEAMS; i++)
+    {
+      if((i != team) && (scba_team_data[i].scba_team_status != SCBA_NOT_STARTED) && (scba_team_data[i].scba_team_nr == nr))
+      {
+        break;
+      }
+    }
+    if(i == SCBA_TEAMS)
+    {
+      return (nr);
+    }
+  }
+  return (team + 1);
+}
+
+/**
+* Opens the team input for a running team, its clock keeps running.
+*/
+void action_open_correction(void)
+{
+  action_close_detail();
+  scba_correction_backup = scba_team_data[active_scba];
+  if(scba_layer[active_scba].scba_info_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, true);
+  }
+  action_open_cnfg();
+}
+
+/**
+* The entered pressure is the one the team started with, the air used
+* since the start time is taken off at the configured breathing rate.
+*/
+void action_correct_team(void)
+{
+  scba_team_t *data = &scba_team_data[active_scba];
+  time_t now = scba_now();
+  uint32_t used_air_volume = 0;
+  
+  stop_auto_repeat();
+  hide_scba_cnfg_layer();
+  
+  calc_scba_team_air_volume(active_scba);
+  scba_rate_reset(&data->scba_team_rate);
+  // the history starts over from the corrected start pressure
+  scba_history_reset(&scba_team_history[active_scba]);
+  scba_history_add(&scba_team_history[active_scba], 0, data->scba_team_bottle_air_volume / scba_bottle_types[data->scba_team_bottle_type].air_volume_in_dliter_per_bar, true);
+  if(now > data->scba_team_start_time)
+  {
+    used_air_volume = ((uint32_t)(now - data->scba_team_start_time) * get_scba_team_breathing_rate(active_scba)) / 60;
+  }
+  data->scba_team_bottle_air_volume = (data->scba_team_bottle_air_volume > used_air_volume) ? (data->scba_team_bottle_air_volume - used_air_volume) : 0;
+  calc_scba_team_air_pressure(active_scba);
+  // alarms are raised again for the corrected pressure
+  data->scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
+  data->scba_team_pressure_psi = imperial_units;
+  data->scba_team_report_time = now;
+  
+  create_scba_info_layer(active_scba);
+  update_scba_team_end_time(active_scba);
+  update_scba_team_info_screen(active_scba);
+  show_scba_team_view(active_scba);
+  schedule_scba_team_check(active_scba);
+  persist_scba_team(active_scba);
+  add_scba_team_history(active_scba, true);
+  publish_scba_team_change(active_scba, SCBA_SYNC_START);
+  log_scba_team_crew(active_scba);
+}
+
+/**
+*
+*/
+void action_confirm_pressure(void)
+{
+  confirm_scba_team_pressure();
+  publish_scba_team_change(active_scba, SCBA_SYNC_PRESSURE);
+}
+
+/**
+*
+*/
+void confirm_scba_team_pressure(void)
+{
+  stop_auto_repeat();
+  take_scba_team_reading(active_scba, scba_now());
+  
+  text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorBlack);
+  text_layer_set_background_color(scba_layer[active_scba].scba_bottle_pressure, GColorClear);      
+}
+
+/**
+* Takes the pressure of the team as a gauge reading made at now, entered
+* by hand or reported by the cylinder.
+*/
+void take_scba_team_reading(uint8_t team, time_t now)
+{
+  calc_scba_team_air_volume(team); 
+  // every gauge reading is a measurement of the team's consumption
+  scba_rate_add_reading(&scba_team_data[team].scba_team_rate, now, scba_team_data[team].scba_team_bottle_air_volume);
+  scba_team_data[team].scba_team_report_time = now;
+  schedule_scba_team_check(team);
+  update_scba_team_end_time(team);
+  update_scba_team_info_screen(team);
+  
+  scba_team_data[team].scba_team_pressure_psi = imperial_units;
+
+  persist_scba_team(team);
+  add_scba_team_history(team, true);
+}
+
+/**
+*
+*/
+void action_ask_stop(void)
+{
+  confirm_scba_team_alarm(active_scba);
+  layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, false);
+  if(scba_layer[active_scba].scba_info_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, true);  
+  }
+  text_layer_set_text(scba_layer[active_scba].start_layer, (scba_drill.active == true) ? "Stop SCBA? Hold: end drill" : "Stop SCBA monitoring?");
+}
+
+/**
+*
+*/
+void action_stop_team(void)
+{
+  text_layer_set_text(scba_layer[active_scba].start_layer, "Start SCBA");
+  destroy_scba_info_layer(active_scba);
+  initialize_scba_team(active_scba);
+  schedule_scba_team_check(active_scba);
+  delete_scba_team(active_scba);
+  publish_scba_team_change(active_scba, SCBA_SYNC_STOP);
+}
+
+/**
+*
+*/
+void action_cancel_stop(void)
+{
+  if(scba_layer[active_scba].scba_info_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, true);
+    layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, false);  
+  }
+  else
+  {
+    text_layer_set_text(scba_layer[active_scba].start_layer, "Start SCBA");
+  }
+}
+
+/**
+*
+*/
+void load_sync_state(void)
+{
+  memset(&scba_sync_data, 0, sizeof(scba_sync_data));
+  
+  if(persist_exists(SCBA_STORE_KEY_SYNC))
+  {
+    persist_read_data(SCBA_STORE_KEY_SYNC, &scba_sync_data, sizeof(scba_sync_data));
+  }
+  else
+  {
+    // ties between changes of the same second are broken by this id
+    srand(time(NULL));
+    scba_sync_data.origin = rand() & 0xFF;
+    write_persist_data(SCBA_STORE_KEY_SYNC, &scba_sync_data, sizeof(scba_sync_data));
+  }
+}
+
+/**
+* Records a change made on this watch and sends it to the other watches.
+*/
+void publish_scba_team_change(uint8_t team, uint8_t type)
+{
+  scba_sync_delta_t delta;
+  
+  // drill teams are not announced, the other watches track real teams
+  if(scba_drill.active == true)
+  {
+    return;
+  }
+  delta.type = type;
+  delta.team = team;
+  delta.run = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_RUN];
+  delta.clock = scba_sync_local_clock(scba_sync_data.clocks[team], type, time(NULL), scba_sync_data.origin);
+  scba_sync_merge(scba_sync_data.clocks[team], &delta);
+  write_persist_data(SCBA_STORE_KEY_SYNC, &scba_sync_data, sizeof(scba_sync_data));
+  
+  scba_sync_pending[team] |= scba_sync_fields(type);
+  send_sync_deltas();
+}
+
+/**
+* Sends the pending fields of all teams in one message. The deltas are built
+* from the current team data, so several pressure updates made while the
+* outbox was busy go out as one.
+*/
+void send_sync_deltas(void)
+{
+  DictionaryIterator *iterator = NULL;
+  uint8_t buffer[SCBA_SYNC_MAX_BATCH_SIZE];
+  uint8_t length = 0;
+  uint8_t i = 0;
+  
+  // the deltas are built from the team data, during a drill that are the drill teams
+  if((sync_sending == true) || (sync_retry_timer != NULL) || (scba_drill.active == true))
+  {
+    return;
+  }
+  
+  // asking the others for their teams goes first and alone
+  if(sync_resend_request == true)
+  {
+    buffer[length++] = SCBA_SYNC_RESEND_REQUEST;
+  }
+  else
+  {
+    for(i=0; i<SCBA_TEAMS; i++)
+    {
+      length += encode_sync_team(i, &buffer[length], sizeof(buffer) - length);
+    }
+  }
+  
+  if(length == 0)
+  {
+    return;
+  }
+  
+  if((app_message_outbox_begin(&iterator) != APP_MSG_OK) ||
+     (dict_write_data(iterator, SCBA_MSG_KEY_SYNC, buffer, length) != DICT_OK) ||
+     (app_message_outbox_send() != APP_MSG_OK))
+  {
+    sync_retry_timer = app_timer_register(SCBA_SYNC_RETRY_DELAY, (AppTimerCallback)sync_retry_timer_callback, NULL);
+    return;
+  }
+  SCBA_TRACE_ADD(SCBA_TRACE_MSG_OUT, 1);
+  SCBA_TRACE_ADD(SCBA_TRACE_MSG_OUT_BYTES, length);
+  
+  if(sync_resend_request == true)
+  {
+    sync_resend_in_flight = true;
+    sync_resend_request = false;
+  }
+  else
+  {
+    for(i=0; i<SCBA_TEAMS; i++)
+    {
+      scba_sync_in_flight[i] = scba_sync_pending[i];
+      scba_sync_pending[i] = 0;
+    }
+  }
+  sync_sending = true;
+}
+
+/**
+*
+*/
+uint8_t encode_sync_team(uint8_t team, uint8_t *buffer, uint8_t buffer_size)
+{
+  const scba_sync_clock_t *clocks = scba_sync_data.clocks[team];
+  uint8_t pending = scba_sync_pending[team];
+  bool started = (scba_team_data[team].scba_team_status != SCBA_NOT_STARTED);
+  scba_sync_delta_t delta;
+  uint8_t length = 0;
+  uint8_t i = 0;
+  
+  if((pending & (1 << SCBA_SYNC_FIELD_RUN)) != 0)
+  {
+    get_sync_delta(team, (started == true) ? SCBA_SYNC_START : SCBA_SYNC_STOP, &delta);
+    length += scba_sync_encode(&delta, &buffer[length], buffer_size - length);
+    
+    // start and stop carry the other fields unless they changed afterwards
+    for(i=0; i<SCBA_SYNC_FIELDS; i++)
+    {
+      if((clocks[i].stamp == clocks[SCBA_SYNC_FIELD_RUN].stamp) && (clocks[i].origin == clocks[SCBA_SYNC_FIELD_RUN].origin))
+      {
+        pending &= ~(1 << i);
+      }
+    }
+  }
+  
+  if(started == false)
+  {
+    return (length);
+  }
+  
+  if((pending & (1 << SCBA_SYNC_FIELD_AIR)) != 0)
+  {
+    get_sync_delta(team, SCBA_SYNC_PRESSURE, &delta);
+    length += scba_sync_encode(&delta, &buffer[length], buffer_size - length);
+  }
+  
+  if((pending & (1 << SCBA_SYNC_FIELD_STATUS)) != 0)
+  {
+    get_sync_delta(team, SCBA_SYNC_ACK, &delta);
+    length += scba_sync_encode(&delta, &buffer[length], buffer_size - length);
+  }
+  return (length);
+}
+
+/**
+*
+*/
+void get_sync_delta(uint8_t team, uint8_t type, scba_sync_delta_t *delta)
+{
+  const scba_team_t *data = &scba_team_data[team];
+  
+  memset(delta, 0, sizeof(*delta));
+  delta->type = type;
+  delta->team = team;
+  
+  switch(type)
+  {
+    case SCBA_SYNC_START:
+      delta->clock = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_RUN];
+      delta->team_nr = data->scba_team_nr;
+      delta->bottle_type = data->scba_team_bottle_type;
+      delta->start_time = data->scba_team_start_time;
+      delta->air_volume = data->scba_team_bottle_air_volume;
+      break;
+    
+    case SCBA_SYNC_STOP:
+      delta->clock = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_RUN];
+      break;
+    
+    case SCBA_SYNC_PRESSURE:
+      delta->clock = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_AIR];
+      delta->run = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_RUN];
+      delta->air_volume = data->scba_team_bottle_air_volume;
+      break;
+    
+    case SCBA_SYNC_ACK:
+      delta->clock = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_STATUS];
+      delta->run = scba_sync_data.clocks[team][SCBA_SYNC_FIELD_RUN];
+      delta->status = data->scba_team_status;
+      break;
+    
+    default:
+      break;
+  }
+}
+
+/**
+*
+*/
+void receive_sync_deltas(const Tuple *t)
+{
+  scba_sync_delta_t delta;
+  uint16_t offset = 0;
+  uint8_t used = 0;
+  
+  if(t->type != TUPLE_BYTE_ARRAY)
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "sync message rejected");
+    return;
+  }
+  
+  // the drill teams occupy the slots, the missed changes are asked for once it ends
+  if(scba_drill.active == true)
+  {
+    return;
+  }
+  
+  // another watch joined, it needs to know all teams
+  if((t->length == 1) && (t->value->data[0] == SCBA_SYNC_RESEND_REQUEST))
+  {
+    for(offset=0; offset<SCBA_TEAMS; offset++)
+    {
+      if(scba_sync_data.clocks[offset][SCBA_SYNC_FIELD_RUN].stamp != 0)
+      {
+        scba_sync_pending[offset] |= SCBA_SYNC_ALL_FIELDS;
+      }
+    }
+    send_sync_deltas();
+    return;
+  }
+  
+  while(offset < t->length)
+  {
+    used = scba_sync_decode(&t->value->data[offset], t->length - offset, &delta);
+    
+    if(used == 0)
+    {
+      APP_LOG(APP_LOG_LEVEL_WARNING, "sync message rejected");
+      return;
+    }
+    offset += used;
+    
+    if(delta.team < SCBA_TEAMS)
+    {
+      apply_sync_delta(&delta);
+    }
+  }
+}
+
+/**
+* Applies the fields of a team change from another watch that are newer
+* than the ones known here.
+*/
+void apply_sync_delta(const scba_sync_delta_t *delta)
+{
+  uint8_t team = delta->team;
+  scba_team_t *data = &scba_team_data[team];
+  uint8_t won = 0;
+  
+  if(((delta->type == SCBA_SYNC_START) && ((delta->team_nr == 0) || (delta->team_nr > SCBA_TEAM_HIGHEST_NR))) ||
+     ((delta->type == SCBA_SYNC_ACK) && ((delta->status == SCBA_NOT_STARTED) || (delta->status > SCBA_EMPTY_BOTTLE_ALARM_CONFIRMED))))
+  {
+    return;
+  }
+  
+  if(scba_sync_missing_run(scba_sync_data.clocks[team], delta) == true)
+  {
+    sync_resend_request = true;
+    send_sync_deltas();
+    return;
+  }
+  
+  won = scba_sync_merge(scba_sync_data.clocks[team], delta);
+  
+  if((won == 0) || ((delta->type != SCBA_SYNC_START) && (delta->type != SCBA_SYNC_STOP) && (data->scba_team_status == SCBA_NOT_STARTED)))
+  {
+    return;
+  }
+  write_persist_data(SCBA_STORE_KEY_SYNC, &scba_sync_data, sizeof(scba_sync_data));
+  // the other watch wins over a change that is being entered here
+  cancel_scba_team_input(team);
+  
+  switch(delta->type)
+  {
+    case SCBA_SYNC_STOP:
+      destroy_scba_info_layer(team);
+      initialize_scba_team(team);
+      schedule_scba_team_check(team);
+      delete_scba_team(team);
+      show_scba_team_view(team);
+      return;
+    
+    case SCBA_SYNC_START:
+      data->scba_team_nr = delta->team_nr;
+      // the watches are expected to share the bottle catalog
+      data->scba_team_bottle_type = (delta->bottle_type < scba_bottle_type_count) ? delta->bottle_type : scba_default_bottle_type;
+      data->scba_team_start_time = delta->start_time;
+      data->scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
+      data->scba_team_pressure_psi = imperial_units;
+      scba_rate_reset(&data->scba_team_rate);
+      scba_history_reset(&scba_team_history[team]);
+      break;
+    
+    case SCBA_SYNC_ACK:
+      data->scba_team_status = delta->status;
+      // acknowledged on another watch, the commander there reacted
+      confirm_scba_team_alarm(team);
+      break;
+    
+    default:
+      break;
+  }
+  
+  if((won & (1 << SCBA_SYNC_FIELD_AIR)) != 0)
+  {
+    data->scba_team_bottle_air_volume = delta->air_volume;
+    calc_scba_team_air_pressure(team);
+    scba_rate_add_reading(&data->scba_team_rate, delta->clock.stamp, data->scba_team_bottle_air_volume);
+    // a report through another watch counts as well
+    data->scba_team_report_time = delta->clock.stamp;
+  }
+  
+  create_scba_info_layer(team);
+  update_scba_team_end_time(team);
+  update_scba_team_info_screen(team);
+  show_scba_team_view(team);
+  persist_scba_team(team);
+  if((won & (1 << SCBA_SYNC_FIELD_AIR)) != 0)
+  {
+    schedule_scba_team_check(team);
+    add_scba_team_history(team, true);
+  }
+}
+
+/**
+*
+*/
+void cancel_scba_team_input(uint8_t team)
+{
+  if((team != active_scba) || (screen_status == SCBA_START_SCREEN) || (screen_status == SCBA_INFO_SCREEN) ||
+     (screen_status == SCBA_OVERVIEW_SCREEN) || (screen_status == SCBA_DETAIL_SCREEN) ||
+     (screen_status == SCBA_HANDOVER_SCREEN) || (screen_status == SCBA_ACK_SCREEN))
+  {
+    return;
+  }
+  
+  stop_auto_repeat();
+  hide_scba_cnfg_layer();
+  
+  // a correction that was not confirmed is dropped
+  if((scba_team_data[team].scba_team_status != SCBA_NOT_STARTED) &&
+     (scba_state_policies[screen_status].tick_policy == SCBA_TICK_FREEZE_ACTIVE))
+  {
+    scba_team_data[team] = scba_correction_backup;
+  }
+  // so is the pressure being entered, nothing may raise alarms on it or store it
+  else if(screen_status == SCBA_UPDATE_PRESSURE)
+  {
+    calc_scba_team_air_pressure(team);
+  }
+  
+  if(scba_layer[team].scba_info_layer != NULL)
+  {
+    text_layer_set_text_color(scba_layer[team].scba_bottle_pressure, GColorBlack);
+    text_layer_set_background_color(scba_layer[team].scba_bottle_pressure, GColorClear);
+  }
+  screen_status = SCBA_INFO_SCREEN;
+}
+
+/**
+*
+*/
+void show_scba_team_view(uint8_t team)
+{
+  if(scba_layer[team].scba_info_layer != NULL)
+  {
+    layer_set_hidden((Layer *)scba_layer[team].start_layer, true);
+    layer_set_hidden((Layer *)scba_layer[team].scba_info_layer, false);
+  }
+  else
+  {
+    text_layer_set_text(scba_layer[team].start_layer, "Start SCBA");
+    layer_set_hidden((Layer *)scba_layer[team].start_layer, false);
+  }
+}
+
+/**
+*
+*/
+void out_sent_handler(DictionaryIterator *iterator, void *context)
+{
+  uint8_t i = 0;
+  
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    scba_sync_in_flight[i] = 0;
+  }
+  sync_resend_in_flight = false;
+  sync_sending = false;
+  config_reply_in_flight = false;
+  if(config_reply_pending == true)
+  {
+    send_app_configuration();
+  }
+  send_sync_deltas();
+}
+
+/**
+*
+*/
+void out_failed_handler(DictionaryIterator *iterator, AppMessageResult reason, void *context)
+{
+  uint8_t i = 0;
+  
+  // the phone is not reachable, keep the fields and try again later
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    scba_sync_pending[i] |= scba_sync_in_flight[i];
+    scba_sync_in_flight[i] = 0;
+  }
+  sync_resend_request |= sync_resend_in_flight;
+  sync_resend_in_flight = false;
+  sync_sending = false;
+  config_reply_pending |= config_reply_in_flight;
+  config_reply_in_flight = false;
+  
+  if(sync_retry_timer == NULL)
+  {
+    sync_retry_timer = app_timer_register(SCBA_SYNC_RETRY_DELAY, (AppTimerCallback)sync_retry_timer_callback, NULL);
+  }
+}
+
+/**
+*
+*/
+void sync_retry_timer_callback(void *data)
+{
+  SCBA_TRACE_ADD(SCBA_TRACE_TIMER, 1);
+  sync_retry_timer = NULL;
+  if(config_reply_pending == true)
+  {
+    send_app_configuration();
+  }
+  send_sync_deltas();
+}
+
+/**
+* Shares the outbox with the team changes, the configuration goes first.
+*/
+void send_app_configuration(void)
+{
+  DictionaryIterator *iterator = NULL;
+  uint8_t length = SCBA_CONFIG_SIZE(scba_config.bottle_count);
+  
+  config_reply_pending = true;
+  if((sync_sending == true) || (sync_retry_timer != NULL))
+  {
+    return;
+  }
+  if((app_message_outbox_begin(&iterator) != APP_MSG_OK) ||
+     (dict_write_data(iterator, SCBA_MSG_KEY_CONFIG, (uint8_t *)&scba_config, length) != DICT_OK) ||
+     (app_message_outbox_send() != APP_MSG_OK))
+  {
+    sync_retry_timer = app_timer_register(SCBA_SYNC_RETRY_DELAY, (AppTimerCallback)sync_retry_timer_callback, NULL);
+    return;
+  }
+  SCBA_TRACE_ADD(SCBA_TRACE_MSG_OUT, 1);
+  SCBA_TRACE_ADD(SCBA_TRACE_MSG_OUT_BYTES, length);
+  config_reply_pending = false;
+  config_reply_in_flight = true;
+  sync_sending = true;
+}
+
+/**
+* Starts the check interval of a team again from its last gauge report,
+* teams that are not running have no reminder.
+*/
+void schedule_scba_team_check(uint8_t team)
+{
+  if((scba_check_interval == 0) || (scba_team_data[team].scba_team_status == SCBA_NOT_STARTED))
+  {
+    scba_reminders_cancel(&scba_reminders, team);
+  }
+  else
+  {
+    scba_reminders_set(&scba_reminders, team, scba_team_data[team].scba_team_report_time + (scba_check_interval * 60));
+  }
+  show_scba_team_overdue(team, false);
+  arm_reminder_timer();
+}
+
+/**
+* One timer for all teams, due when the earliest reminder is.
+*/
+void arm_reminder_timer(void)
+{
+  time_t due = 0;
+  time_t now = scba_now();
+  uint32_t delay = 0;
+
+  if(scba_reminders_next(&scba_reminders, &due) == false)
+  {
+    if(reminder_timer != NULL)
+    {
+      app_timer_cancel(reminder_timer);
+      reminder_timer = NULL;
+    }
+    return;
+  }
+
+  if(due > now)
+  {
+    delay = scba_drill_real_ms(&scba_drill, (due - now) * 1000);
+  }
+  if((reminder_timer == NULL) || (app_timer_reschedule(reminder_timer, delay) == false))
+  {
+    reminder_timer = app_timer_register(delay, (AppTimerCallback)reminder_timer_callback, NULL);
+  }
+}
+
+/**
+*
+*/
+void reminder_timer_callback(void *data)
+{
+  uint8_t team = 0;
+  bool reminded = false;
+
+  SCBA_TRACE_ADD(SCBA_TRACE_TIMER, 1);
+  reminder_timer = NULL;
+  // the team stays flagged until its next report schedules it again
+  while(scba_reminders_pop_due(&scba_reminders, scba_now(), &team) == true)
+  {
+    show_scba_team_overdue(team, true);
+    reminded = true;
+  }
+
+  if(reminded == true)
+  {
+    SCBA_TRACE_ADD(SCBA_TRACE_VIBE_SHORT, 1);
+    vibes_short_pulse();
+    enable_scba_backlight();
+  }
+  arm_reminder_timer();
+}
+
+/**
+* An overdue team shows its passed time inverted.
+*/
+void show_scba_team_overdue(uint8_t team, bool overdue)
+{
+  scba_team_overdue[team] = overdue;
+
+  if(scba_layer[team].scba_info_layer == NULL)
+  {
+    return;
+  }
+
+  if(overdue == true)
+  {
+    text_layer_set_text_color(scba_layer[team].scba_passed_time, GColorWhite);
+#ifdef PBL_COLOR
+    text_layer_set_background_color(scba_layer[team].scba_passed_time, GColorRed);
+#else
+    text_layer_set_background_color(scba_layer[team].scba_passed_time, GColorBlack);
+#endif // #ifdef PBL_COLOR
+  }
+  else
+  {
+    text_layer_set_text_color(scba_layer[team].scba_passed_time, GColorBlack);
+    text_layer_set_background_color(scba_layer[team].scba_passed_time, GColorClear);
+  }
+}
+
+/**
+* Replaces the team rows by the teams ordered by urgency.
+*/
+void action_open_overview(void)
+{
+  uint8_t i = 0;
+
+  // taller than the teams, the sector rows go in between
+  g_overview_layer = layer_create(GRect(0,30,120,layer_get_bounds(window_get_root_layer(g_window)).size.h - 30));
+  layer_set_update_proc(g_overview_layer, overview_update_proc);
+
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    scba_overview_rows[i].row_layer = layer_create(GRect(0, scba_overview_position(&scba_overview, i) * SCBA_OVERVIEW_ROW_HEIGHT, 120, SCBA_OVERVIEW_ROW_HEIGHT));
+    scba_overview_rows[i].icon_layer = bitmap_layer_create(GRect(0,7,30,30));
+    scba_overview_rows[i].text_layer = text_layer_create(GRect(35,0,85,SCBA_OVERVIEW_ROW_HEIGHT));
+    set_text_layer_font(scba_overview_rows[i].text_layer, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_18_BOLD);
+    scba_overview_rows[i].text[0] = '\0';
+
+    layer_add_child(scba_overview_rows[i].row_layer, bitmap_layer_get_layer(scba_overview_rows[i].icon_layer));
+    layer_add_child(scba_overview_rows[i].row_layer, text_layer_get_layer(scba_overview_rows[i].text_layer));
+    layer_add_child(g_overview_layer, scba_overview_rows[i].row_layer);
+    update_scba_overview_row(i);
+
+    layer_set_hidden(scba_layer[i].scba_team_layer, true);
+  }
+  layout_scba_overview();
+  layer_add_child(window_get_root_layer(g_window), g_overview_layer);
+}
+
+/**
+*
+*/
+void action_close_overview(void)
+{
+  uint8_t i = 0;
+
+  destroy_scba_overview();
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    layer_set_hidden(scba_layer[i].scba_team_layer, false);
+  }
+}
+
+/**
+* Closes the overview with the most urgent running team active.
+*/
+void action_select_first_team(void)
+{
+  uint8_t team = scba_overview.order[0];
+
+  if(scba_team_data[team].scba_team_status != SCBA_NOT_STARTED)
+  {
+    active_scba = team;
+    change_active_scba_icon();
+  }
+  action_close_overview();
+}
+
+/**
+* Takes a changed prediction or alarm of a team into the order and into the
+* aggregate of its sector. Without sectors only the rows between its old
+* and its new position are moved.
+*/
+void update_scba_overview(uint8_t team)
+{
+  const scba_team_t *data = &scba_team_data[team];
+  const scba_pressure_levels_t *levels = &scba_bottle_types[data->scba_team_bottle_type].levels[imperial_units];
+  uint8_t first = 0;
+  uint8_t last = 0;
+  uint8_t i = 0;
+  uint8_t sector = scba_sectors.teams[team].sector;
+  uint8_t changed = 0;
+  bool moved = false;
+  bool pinned = ((get_scba_team_guards(team) & SCBA_GUARD_ALARM_PENDING) != 0);
+  time_t end_time = (data->scba_team_status != SCBA_NOT_STARTED) ? scba_team_end_time[team] : 0;
+
+  moved = scba_overview_update(&scba_overview, team, pinned, end_time, &first, &last);
+  changed = scba_sector_update(&scba_sectors, team, scba_team_sector[team], scba_model_level(data->scba_team_bottle_pressure, levels), end_time);
+  if(g_overview_layer == NULL)
+  {
+    return;
+  }
+
+  if((sector != scba_sectors.teams[team].sector) || ((moved == true) && (scba_sector_used(&scba_sectors) == true)))
+  {
+    layout_scba_overview();
+  }
+  else if(moved == true)
+  {
+    for(i=first; i<=last; i++)
+    {
+      layer_set_frame(scba_overview_rows[scba_overview.order[i]].row_layer, GRect(0, i * SCBA_OVERVIEW_ROW_HEIGHT, 120, SCBA_OVERVIEW_ROW_HEIGHT));
+    }
+  }
+  else if(changed != 0)
+  {
+    // only the sector row shows something new
+    layer_mark_dirty(g_overview_layer);
+  }
+  update_scba_overview_row(team);
+}
+
+/**
+* Places the team rows below their sector rows, the teams of a collapsed
+* sector are hidden.
+*/
+void layout_scba_overview(void)
+{
+  uint8_t items[SCBA_TEAMS + SCBA_SECTORS];
+  uint8_t count = scba_sector_layout(&scba_sectors, scba_overview.order, scba_sectors_collapsed, items);
+  int16_t y = 0;
+  uint8_t i = 0;
+
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    layer_set_hidden(scba_overview_rows[i].row_layer, true);
+  }
+  for(i=0; i<count; i++)
+  {
+    if((items[i] & SCBA_SECTOR_ITEM) != 0)
+    {
+      y += SCBA_SECTOR_ROW_HEIGHT;
+      continue;
+    }
+    layer_set_frame(scba_overview_rows[items[i]].row_layer, GRect(0, y, 120, SCBA_OVERVIEW_ROW_HEIGHT));
+    layer_set_hidden(scba_overview_rows[items[i]].row_layer, false);
+    y += SCBA_OVERVIEW_ROW_HEIGHT;
+  }
+  layer_mark_dirty(g_overview_layer);
+}
+
+/**
+* Draws the sector rows, the team rows are child layers.
+*/
+void overview_update_proc(Layer *layer, GContext *ctx)
+{
+  uint8_t items[SCBA_TEAMS + SCBA_SECTORS];
+  uint8_t count = 0;
+  uint8_t sector = 0;
+  int16_t y = 0;
+  uint8_t i = 0;
+  char text[24];
+  time_t now = 0;
+
+  if(scba_sector_used(&scba_sectors) == false)
+  {
+    return;
+  }
+  now = scba_now();
+  count = scba_sector_layout(&scba_sectors, scba_overview.order, scba_sectors_collapsed, items);
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_context_set_text_color(ctx, GColorWhite);
+  for(i=0; i<count; i++)
+  {
+    if((items[i] & SCBA_SECTOR_ITEM) == 0)
+    {
+      y += SCBA_OVERVIEW_ROW_HEIGHT;
+      continue;
+    }
+    sector = (items[i] & ~SCBA_SECTOR_ITEM) + 1;
+    scba_sector_format(&scba_sectors, sector, ((scba_sectors_collapsed & (1 << (sector - 1))) != 0), now, text, sizeof(text));
+    graphics_fill_rect(ctx, GRect(0, y, 120, SCBA_SECTOR_ROW_HEIGHT - 1), 0, GCornerNone);
+    graphics_draw_text(ctx, text, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD), GRect(2, y, 116, SCBA_SECTOR_ROW_HEIGHT),
+                       GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+    y += SCBA_SECTOR_ROW_HEIGHT;
+  }
+}
+
+/**
+* Sectors of the running teams, checked against the teams as they load.
+*/
+void load_scba_sectors(void)
+{
+  uint8_t i = 0;
+  
+  if(persist_exists(SCBA_STORE_KEY_SECTORS))
+  {
+    persist_read_data(SCBA_STORE_KEY_SECTORS, scba_team_sector, sizeof(scba_team_sector));
+  }
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if(scba_team_sector[i] > SCBA_SECTORS)
+    {
+      scba_team_sector[i] = SCBA_SECTOR_NONE;
+    }
+  }
+}
+
+/**
+* Crew names may be missing, the pool is checked as a whole.
+*/
+void load_scba_roster(void)
+{
+  if(persist_exists(SCBA_STORE_KEY_ROSTER))
+  {
+    persist_read_data(SCBA_STORE_KEY_ROSTER, &scba_roster, sizeof(scba_roster));
+  }
+  if(scba_roster_valid(&scba_roster) == false)
+  {
+    scba_roster_reset(&scba_roster);
+  }
+}
+
+/**
+* Crew of one team number, see scba_roster.c for the message.
+*/
+void receive_scba_roster(const Tuple *t)
+{
+  uint8_t i = 0;
+  
+  if((t->type != TUPLE_BYTE_ARRAY) || (t->length == 0) || (t->length > (1 + (SCBA_ROSTER_CREW * SCBA_ROSTER_NAME_LEN))))
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "roster message rejected");
+    return;
+  }
+  if(scba_roster_set_crew(&scba_roster, t->value->data[0], &t->value->data[1], t->length - 1) == false)
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "roster of team %d incomplete", t->value->data[0]);
+  }
+  write_persist_data(SCBA_STORE_KEY_ROSTER, &scba_roster, sizeof(scba_roster));
+  
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if((scba_team_data[i].scba_team_status != SCBA_NOT_STARTED) && (scba_team_data[i].scba_team_nr == t->value->data[0]))
+    {
+      log_scba_team_crew(i);
+    }
+  }
+  if(g_detail_layer != NULL)
+  {
+    layer_mark_dirty(g_detail_layer);
+  }
+}
+
+/**
+* The crew of a running team goes to the app log with the exported history.
+*/
+void log_scba_team_crew(uint8_t team)
+{
+  char text[SCBA_ROSTER_CREW * (SCBA_ROSTER_NAME_LEN + 1)];
+  
+  scba_roster_format(&scba_roster, scba_team_data[team].scba_team_nr, text, sizeof(text), ", ");
+  APP_LOG(APP_LOG_LEVEL_INFO, "crew team %d: %s", scba_team_data[team].scba_team_nr, text);
+}
+
+/**
+* Crew names of the active team below the pressure.
+*/
+void detail_update_proc(Layer *layer, GContext *ctx)
+{
+  char text[SCBA_ROSTER_CREW * (SCBA_ROSTER_NAME_LEN + 1)];
+  
+  if(scba_roster_format(&scba_roster, scba_team_data[active_scba].scba_team_nr, text, sizeof(text), ", ") == 0)
+  {
+    return;
+  }
+  graphics_context_set_text_color(ctx, GColorBlack);
+  graphics_draw_text(ctx, text, fonts_get_system_font(FONT_KEY_GOTHIC_14), GRect(5, 24, 110, 18),
+                     GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+}
+
+/**
+* Takes a batch of cylinder pressures, see scba_telemetry.c. A team whose
+* pressure is being entered by hand keeps the input, the drill teams only
+* breathe as their scenario says.
+*/
+void receive_scba_telemetry(const Tuple *t)
+{
+  scba_telemetry_reading_t readings[SCBA_TELEMETRY_MAX_READINGS];
+  const scba_pressure_levels_t *levels = NULL;
+  uint8_t count = 0;
+  uint8_t team = 0;
+  uint8_t i = 0;
+  time_t now = scba_now();
+  time_t reading_time = 0;
+  
+  if(t->type == TUPLE_BYTE_ARRAY)
+  {
+    count = scba_telemetry_decode(t->value->data, t->length, readings, SCBA_TELEMETRY_MAX_READINGS);
+  }
+  if(count == 0)
+  {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "telemetry message rejected");
+    return;
+  }
+  if(scba_drill.active == true)
+  {
+    return;
+  }
+  
+  for(i=0; i<count; i++)
+  {
+    for(team=0; team<SCBA_TEAMS; team++)
+    {
+      if((scba_team_data[team].scba_team_status != SCBA_NOT_STARTED) && (scba_team_data[team].scba_team_nr == readings[i].team_nr))
+      {
+        break;
+      }
+    }
+    // the pressure of a team being entered is the input value itself
+    if((team == SCBA_TEAMS) ||
+       ((team == active_scba) && ((scba_state_policies[screen_status].tick_policy == SCBA_TICK_FREEZE_ACTIVE) || (screen_status == SCBA_UPDATE_PRESSURE))))
+    {
+      continue;
+    }
+    
+    levels = &scba_bottle_types[scba_team_data[team].scba_team_bottle_type].levels[NOT_AVAILABLE];
+    if(readings[i].pressure > levels->max_input_pressure)
+    {
+      continue;
+    }
+    scba_team_data[team].scba_team_bottle_pressure = (imperial_units == AVAILABLE) ? (uint16_t)(readings[i].pressure * BAR_TO_PSI_FACTOR) : readings[i].pressure;
+    // a reading never goes back behind the last report
+    reading_time = now - readings[i].age;
+    if(reading_time < scba_team_data[team].scba_team_report_time)
+    {
+      reading_time = scba_team_data[team].scba_team_report_time;
+    }
+    take_scba_team_reading(team, reading_time);
+    publish_scba_team_change(team, SCBA_SYNC_PRESSURE);
+  }
+}
+
+/**
+* Moves the active team to the next sector, after the last one it has none.
+*/
+void action_next_sector(void)
+{
+  scba_team_sector[active_scba] = (scba_team_sector[active_scba] + 1) % (SCBA_SECTORS + 1);
+  if(scba_drill.active == false)
+  {
+    write_persist_data(SCBA_STORE_KEY_SECTORS, scba_team_sector, sizeof(scba_team_sector));
+  }
+  update_scba_overview(active_scba);
+  update_scba_detail();
+}
+
+/**
+* Collapses the sectors one after the other, see scba_sector_next_view().
+*/
+void action_sector_view(void)
+{
+  scba_sectors_collapsed = scba_sector_next_view(&scba_sectors, scba_sectors_collapsed);
+  layout_scba_overview();
+}
+
+/**
+* Icon by the alarm state, minutes left until the predicted end. The text
+* layer is only marked dirty when the minutes changed.
+*/
+void update_scba_overview_row(uint8_t team)
+{
+  const scba_team_t *data = &scba_team_data[team];
+  const scba_pressure_levels_t *levels = &scba_bottle_types[data->scba_team_bottle_type].levels[imperial_units];
+  GBitmap *icon = NULL;
+  char text[sizeof(scba_overview_rows[team].text)];
+  time_t now = scba_now();
+
+  if(data->scba_team_status == SCBA_NOT_STARTED)
+  {
+    mini_snprintf(text, sizeof(text), "Team %d\n-", data->scba_team_nr);
+  }
+  else
+  {
+    mini_snprintf(text, sizeof(text), "Team %d\n%d min", data->scba_team_nr,
+                  (int)((scba_team_end_time[team] > now) ? ((scba_team_end_time[team] - now) / 60) : 0));
+
+    if(scba_overview.keys[team].pinned == true)
+    {
+      icon = icon_small_exclamation_mark;
+    }
+    else if(data->scba_team_bottle_pressure < levels->empty_pressure)
+    {
+      icon = get_icon(&icon_small_stop_signe, RESOURCE_ID_SMALL_STOP_SIGNE);
+    }
+    else if(data->scba_team_status >= SCBA_MIN_BOTTLE_PRESSURE_ALARM)
+    {
+      icon = icon_small_empty_bottle;
+    }
+    else if(data->scba_team_status >= SCBA_THIRD_EMPTY_BOTTLE_ALARM)
+    {
+      icon = icon_small_third_empty_bottle;
+    }
+    else if(data->scba_team_status >= SCBA_HALF_FULL_BOTTLE_ALARM)
+    {
+      icon = icon_small_half_full_bottle;
+    }
+    else if(data->scba_team_status >= SCBA_THIRD_FULL_BOTTLE_ALARM)
+    {
+      icon = icon_small_third_full_bottle;
+    }
+    else
+    {
+      icon = icon_small_full_bottle;
+    }
+  }
+
+  bitmap_layer_set_bitmap(scba_overview_rows[team].icon_layer, icon);
+  if(strcmp(text, scba_overview_rows[team].text) != 0)
+  {
+    strcpy(scba_overview_rows[team].text, text);
+    text_layer_set_text(scba_overview_rows[team].text_layer, scba_overview_rows[team].text);
+  }
+}
+
+/**
+*
+*/
+void destroy_scba_overview(void)
+{
+  uint8_t i = 0;
+
+  if(g_overview_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(g_overview_layer);
+
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    bitmap_layer_destroy(scba_overview_rows[i].icon_layer);
+    text_layer_destroy(scba_overview_rows[i].text_layer);
+    layer_destroy(scba_overview_rows[i].row_layer);
+  }
+  layer_destroy(g_overview_layer);
+  g_overview_layer = NULL;
+}
+
+/**
+* Restores the samples of the running teams, idle teams are reset when loaded.
+*/
+void load_scba_history(void)
+{
+  uint8_t i = 0;
+  
+  if(persist_exists(SCBA_STORE_KEY_HISTORY))
+  {
+    persist_read_data(SCBA_STORE_KEY_HISTORY, scba_team_history, sizeof(scba_team_history));
+  }
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    if((scba_team_history[i].count > SCBA_HISTORY_SAMPLES) || (scba_team_history[i].interval == 0))
+    {
+      scba_history_reset(&scba_team_history[i]);
+    }
+  }
+}
+
+/**
+* Takes a pressure sample of a team, forced at every reading, from the
+* tick only when the interval of the history passed.
+*/
+void add_scba_team_history(uint8_t team, bool forced)
+{
+  const scba_team_t *data = &scba_team_data[team];
+  time_t now = scba_now();
+  uint16_t minute = (now > data->scba_team_start_time) ? ((now - data->scba_team_start_time) / 60) : 0;
+  uint16_t pressure = data->scba_team_bottle_air_volume / scba_bottle_types[data->scba_team_bottle_type].air_volume_in_dliter_per_bar;
+  
+  if(scba_history_add(&scba_team_history[team], minute, pressure, forced) == false)
+  {
+    return;
+  }
+  if(scba_drill.active == false)
+  {
+    write_persist_data(SCBA_STORE_KEY_HISTORY, scba_team_history, sizeof(scba_team_history));
+  }
+  
+  if((g_detail_layer != NULL) && (team == active_scba))
+  {
+    update_scba_detail();
+  }
+}
+
+/**
+* Replaces the team rows by the pressure history of the active team.
+*/
+void action_open_detail(void)
+{
+  uint8_t i = 0;
+  
+  g_detail_layer = layer_create(GRect(0,30,120,SCBA_TEAMS * SCBA_OVERVIEW_ROW_HEIGHT));
+  layer_set_update_proc(g_detail_layer, detail_update_proc);
+  g_detail_text_layer = text_layer_create(GRect(5,0,110,24));
+  set_text_layer_font(g_detail_text_layer, GColorClear, GColorBlack, GTextAlignmentLeft, FONT_KEY_GOTHIC_18_BOLD);
+  // the crew line is drawn by the detail layer between the text and the sparkline
+  g_sparkline_layer = layer_create(GRect(5,44,110,(SCBA_TEAMS * SCBA_OVERVIEW_ROW_HEIGHT) - 48));
+  layer_set_update_proc(g_sparkline_layer, sparkline_update_proc);
+  
+  layer_add_child(g_detail_layer, text_layer_get_layer(g_detail_text_layer));
+  layer_add_child(g_detail_layer, g_sparkline_layer);
+  
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    layer_set_hidden(scba_layer[i].scba_team_layer, true);
+  }
+  layer_add_child(window_get_root_layer(g_window), g_detail_layer);
+  update_scba_detail();
+}
+
+/**
+*
+*/
+void action_close_detail(void)
+{
+  uint8_t i = 0;
+  
+  if(g_detail_layer == NULL)
+  {
+    return;
+  }
+  destroy_scba_detail();
+  for(i=0; i<SCBA_TEAMS; i++)
+  {
+    layer_set_hidden(scba_layer[i].scba_team_layer, false);
+  }
+}
+
+/**
+*
+*/
+void update_scba_detail(void)
+{
+  if(scba_team_sector[active_scba] != SCBA_SECTOR_NONE)
+  {
+    mini_snprintf(detail_text, sizeof(detail_text), "Team %d %c: %d %s", scba_team_data[active_scba].scba_team_nr,
+                  'A' + scba_team_sector[active_scba] - 1, scba_team_data[active_scba].scba_team_bottle_pressure,
+                  (imperial_units == AVAILABLE) ? "psi" : "bar");
+  }
+  else
+  {
+    mini_snprintf(detail_text, sizeof(detail_text), "Team %d: %d %s", scba_team_data[active_scba].scba_team_nr,
+                  scba_team_data[active_scba].scba_team_bottle_pressure, (imperial_units == AVAILABLE) ? "psi" : "bar");
+  }
+  text_layer_set_text(g_detail_text_layer, detail_text);
+  layer_mark_dirty(g_sparkline_layer);
+}
+
+/**
+* Pressure over time from 0 to the highest input pressure of the bottle,
+* the dotted line is the return pressure.
+*/
+void sparkline_update_proc(Layer *layer, GContext *ctx)
+{
+  GRect bounds = layer_get_bounds(layer);
+  scba_history_point_t points[SCBA_HISTORY_SAMPLES];
+  const scba_pressure_levels_t *levels = &scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].levels[NOT_AVAILABLE];
+  uint8_t count = scba_history_points(&scba_team_history[active_scba], bounds.size.w, bounds.size.h, levels->max_input_pressure, points);
+  int16_t y = (bounds.size.h - 1) - ((levels->min_pressure * (bounds.size.h - 1)) / levels->max_input_pressure);
+  int16_t x = 0;
+  uint8_t i = 0;
+  
+  graphics_context_set_stroke_color(ctx, GColorBlack);
+  graphics_draw_rect(ctx, bounds);
+  
+  for(x=0; x<bounds.size.w; x+=4)
+  {
+    graphics_draw_pixel(ctx, GPoint(x, y));
+  }
+  
+  if(count == 1)
+  {
+    graphics_draw_pixel(ctx, GPoint(points[0].x, points[0].y));
+  }
+  for(i=1; i<count; i++)
+  {
+    graphics_draw_line(ctx, GPoint(points[i-1].x, points[i-1].y), GPoint(points[i].x, points[i].y));
+  }
+}
+
+/**
+*
+*/
+void destroy_scba_detail(void)
+{
+  if(g_detail_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(g_detail_layer);
+  text_layer_destroy(g_detail_text_layer);
+  layer_destroy(g_sparkline_layer);
+  layer_destroy(g_detail_layer);
+  g_detail_layer = NULL;
+}
+
+/**
+* Covers the screen with a QR code of all running teams, see
+* scba_snapshot.c for the content. The code is not updated while shown.
+*/
+void action_open_handover(void)
+{
+  uint8_t buffer[SCBA_SNAPSHOT_MAX_SIZE];
+  scba_snapshot_t snapshot;
+  scba_snapshot_team_t *data = NULL;
+  uint8_t length = 0;
+  uint8_t team = 0;
+#ifdef DEBUG
+  time_t seconds = 0;
+  uint16_t milliseconds = time_ms(&seconds, NULL);
+  time_t end_seconds = 0;
+  uint16_t end_milliseconds = 0;
+#endif // #ifdef DEBUG
+
+  snapshot.time = scba_now();
+  snapshot.count = 0;
+  for(team=0; team<SCBA_TEAMS; team++)
+  {
+    if(scba_team_data[team].scba_team_status == SCBA_NOT_STARTED)
+    {
+      continue;
+    }
+    data = &snapshot.teams[snapshot.count++];
+    data->slot = team;
+    data->team_nr = scba_team_data[team].scba_team_nr;
+    data->bottle_type = scba_team_data[team].scba_team_bottle_type;
+    data->status = scba_team_data[team].scba_team_status;
+    data->start_time = scba_team_data[team].scba_team_start_time;
+    data->report_time = scba_team_data[team].scba_team_report_time;
+    data->air_volume = scba_team_data[team].scba_team_bottle_air_volume;
+    data->pressure = scba_model_pressure(&scba_team_data[team], &scba_bottle_types[data->bottle_type], SCBA_UNIT_BAR);
+  }
+  length = scba_snapshot_encode(&snapshot, buffer, sizeof(buffer));
+  scba_qr_encode(&handover_qr, buffer, length);
+
+#ifdef DEBUG
+  end_milliseconds = time_ms(&end_seconds, NULL);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "handover: %d teams, %d bytes, mask %d, %d ms", snapshot.count, length, handover_qr.mask,
+          (int)(((end_seconds - seconds) * 1000) + end_milliseconds - milliseconds));
+#endif // #ifdef DEBUG
+
+  mini_snprintf(handover_text, sizeof(handover_text), "Handover %s", clock_text);
+  g_handover_layer = layer_create(layer_get_bounds(window_get_root_layer(g_window)));
+  layer_set_update_proc(g_handover_layer, handover_update_proc);
+  layer_add_child(window_get_root_layer(g_window), g_handover_layer);
+}
+
+/**
+*
+*/
+void action_close_handover(void)
+{
+  if(g_handover_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(g_handover_layer);
+  layer_destroy(g_handover_layer);
+  g_handover_layer = NULL;
+}
+
+/**
+* Validated as a whole, the teams were not loaded yet.
+*/
+void load_scba_ack(void)
+{
+  uint8_t i = 0;
+  
+  if(persist_exists(SCBA_STORE_KEY_ACK))
+  {
+    persist_read_data(SCBA_STORE_KEY_ACK, &scba_ack, sizeof(scba_ack));
+  }
+  for(i=0; i<SCBA_ACK_TEAMS; i++)
+  {
+    if((scba_ack.level[i] > SCBA_ACK_LEVELS) || (scba_ack.pending >= (1 << SCBA_ACK_TEAMS)))
+    {
+      scba_ack_reset(&scba_ack);
+    }
+  }
+}
+
+/**
+* Starts the clock of an alarm. Alarms of a drill are not counted, they
+* would skew the times of real incidents.
+*/
+void raise_scba_team_alarm(uint8_t team, uint8_t events)
+{
+  const scba_pressure_levels_t *levels = &scba_bottle_types[scba_team_data[team].scba_team_bottle_type].levels[imperial_units];
+  uint8_t level = ((events & SCBA_MODEL_EVENT_MAYDAY) != 0) ? SCBA_LEVEL_MAYDAY : scba_model_level(scba_team_data[team].scba_team_bottle_pressure, levels);
+  
+  if((events == 0) || (scba_drill.active == true) || (scba_ack_raise(&scba_ack, team, level, time(NULL)) == false))
+  {
+    return;
+  }
+  write_persist_data(SCBA_STORE_KEY_ACK, &scba_ack, sizeof(scba_ack));
+}
+
+/**
+* The summary goes to the log with every acknowledgement, it is exported
+* with the rest of the history there.
+*/
+void confirm_scba_team_alarm(uint8_t team)
+{
+  if((scba_drill.active == true) || (scba_ack_confirm(&scba_ack, team, time(NULL)) == false))
+  {
+    return;
+  }
+  write_persist_data(SCBA_STORE_KEY_ACK, &scba_ack, sizeof(scba_ack));
+  scba_ack_format(&scba_ack, ack_text, sizeof(ack_text), "; ");
+  APP_LOG(APP_LOG_LEVEL_INFO, "ack %s", ack_text);
+  show_scba_ack_summary();
+}
+
+/**
+* Covers the overview with the count, median and worst time per level.
+*/
+void action_open_ack_summary(void)
+{
+  g_ack_layer = layer_create(layer_get_bounds(window_get_root_layer(g_window)));
+  layer_set_update_proc(g_ack_layer, ack_summary_update_proc);
+  layer_add_child(window_get_root_layer(g_window), g_ack_layer);
+  show_scba_ack_summary();
+}
+
+/**
+*
+*/
+void action_close_ack_summary(void)
+{
+  if(g_ack_layer == NULL)
+  {
+    return;
+  }
+  layer_remove_from_parent(g_ack_layer);
+  layer_destroy(g_ack_layer);
+  g_ack_layer = NULL;
+}
+
+/**
+* Holding select starts the measurement over.
+*/
+void action_reset_ack_summary(void)
+{
+  scba_ack_clear(&scba_ack);
+  write_persist_data(SCBA_STORE_KEY_ACK, &scba_ack, sizeof(scba_ack));
+  show_scba_ack_summary();
+}
+
+/**
+*
+*/
+void show_scba_ack_summary(void)
+{
+  int length = 0;
+  
+  if(g_ack_layer == NULL)
+  {
+    return;
+  }
+  length = mini_snprintf(ack_text, sizeof(ack_text), "Time to acknowledge\n");
+  scba_ack_format(&scba_ack, &ack_text[length], sizeof(ack_text) - length, "\n");
+  layer_mark_dirty(g_ack_layer);
+}
+
+/**
+* A plain layer, a text layer would not fit the heap budget of aplite.
+*/
+void ack_summary_update_proc(Layer *layer, GContext *ctx)
+{
+  GRect bounds = layer_get_bounds(layer);
+  
+  graphics_context_set_fill_color(ctx, GColorWhite);
+  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorBlack);
+  graphics_draw_text(ctx, ack_text, fonts_get_system_font(FONT_KEY_GOTHIC_14), GRect(2, 0, bounds.size.w - 4, bounds.size.h),
+                     GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+}
+
+/**
+* Dark modules are drawn as runs per row, with a light quiet zone around.
+*/
+void handover_update_proc(Layer *layer, GContext *ctx)
+{
+  GRect bounds = layer_get_bounds(layer);
+  int16_t size = SCBA_QR_SIZE * SCBA_HANDOVER_MODULE_SIZE;
+  int16_t left = (bounds.size.w - size) / 2;
+  int16_t top = bounds.size.h - size - left;
+  uint8_t x = 0;
+  uint8_t y = 0;
+  uint8_t run = 0;
+
+  graphics_context_set_fill_color(ctx, GColorWhite);
+  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorBlack);
+  graphics_draw_text(ctx, handover_text, fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD), GRect(0, 2, bounds.size.w, 22),
+                     GTextOverflowModeTrailingEllipsis, GTextAlignmentCenter, NULL);
+
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  for(y=0; y<SCBA_QR_SIZE; y++)
+  {
+    for(x=0; x<=SCBA_QR_SIZE; x++)
+    {
+      if((x < SCBA_QR_SIZE) && (scba_qr_module(&handover_qr, x, y) == true))
+      {
+        run++;
+        continue;
+      }
+      if(run > 0)
+      {
+        graphics_fill_rect(ctx, GRect(left + ((x - run) * SCBA_HANDOVER_MODULE_SIZE), top + (y * SCBA_HANDOVER_MODULE_SIZE),
+                                      run * SCBA_HANDOVER_MODULE_SIZE, SCBA_HANDOVER_MODULE_SIZE), 0, GCornerNone);
+        run = 0;
+      }
+    }
+  }
+}
+
+/**
+* Time of the team timing, runs faster during a drill.
+*/
+time_t scba_now(void)
+{
+  time_t seconds = 0;
+  uint16_t milliseconds = time_ms(&seconds, NULL);
+  
+  return (scba_drill_time(&scba_drill, seconds, milliseconds));
+}
+
+/**
+* All writes to the flash go through here, so the trace counts them.
+*/
+void write_persist_data(uint32_t key, const void *data, size_t size)
+{
+  SCBA_TRACE_ADD(SCBA_TRACE_PERSIST, 1);
+  SCBA_TRACE_ADD(SCBA_TRACE_PERSIST_BYTES, size);
+  persist_write_data(key, data, size);
+}
+
+/**
+* The trace counts the seconds the backlight is on: every interaction
+* keeps it on until SCBA_LIGHT_TIMEOUT after it, so it adds the time since
+* the one before, at most the timeout.
+*/
+void enable_scba_backlight(void)
+{
+#ifdef SCBA_TRACE
+  time_t now = time(NULL);
+  
+  SCBA_TRACE_ADD(SCBA_TRACE_LIGHT_SECONDS, ((now - backlight_time) < SCBA_LIGHT_TIMEOUT) ? (now - backlight_time) : SCBA_LIGHT_TIMEOUT);
+  backlight_time = now;
+#endif // #ifdef SCBA_TRACE
+  light_enable_interaction();
+}
+
+#ifdef SCBA_TRACE
+/**
+*
+*/
+void log_scba_trace(void)
+{
+  char line[240];
+  
+  scba_trace_format(line, sizeof(line), time(NULL) - launch_start_time);
+  APP_LOG(APP_LOG_LEVEL_INFO, "%s", line);
+}
+
+/**
+* Draws nothing, but is drawn with every frame of the window.
+*/
+void trace_update_proc(Layer *layer, GContext *ctx)
+{
+  SCBA_TRACE_ADD(SCBA_TRACE_REDRAW, 1);
+}
+#endif // #ifdef SCBA_TRACE
+
+/**
+* Drill teams are never stored, so a relaunch never shows them as real ones.
+*/
+void persist_scba_team(uint8_t team)
+{
+  if(scba_drill.active == false)
+  {
+    write_persist_data(scba_team_storage_keys[team], &scba_team_data[team], sizeof(scba_team_data[team]));
+  }
+}
+
+/**
+*
+*/
+void delete_scba_team(uint8_t team)
+{
+  if(scba_drill.active == false)
+  {
+    persist_delete(scba_team_storage_keys[team]);
+  }
+}
+
+/**
+* Takes the sudden pressure loss of the drill scenario off once per team,
+* returns true if it did.
+*/
+bool drop_scba_drill_team_air(uint8_t team, time_t now)
+{
+  scba_team_t *data = &scba_team_data[team];
+  uint32_t drop = 0;
+  
+  if(((scba_drill_drops & (1 << team)) != 0) || (scba_drill_drop_due(&scba_drill, data->scba_team_start_time, now) == false))
+  {
+    return (false);
+  }
+  scba_drill_drops |= (1 << team);
+  
+  drop = (uint32_t)scba_drill_scenarios[scba_drill.scenario].drop_pressure * scba_bottle_types[data->scba_team_bottle_type].air_volume_in_dliter_per_bar;
+  data->scba_team_bottle_air_volume = (data->scba_team_bottle_air_volume > drop) ? (data->scba_team_bottle_air_volume - drop) : 0;
+  return (true);
+}
+
+/**
+* The setup is shown in the row of the active team, all teams are idle.
+*/
+void action_open_drill_setup(void)
+{
+  show_drill_setup();
+}
+
+/**
+*
+*/
+void action_drill_scale(void)
+{
+  drill_scale_index = increase_value(0, (SCBA_DRILL_SCALES-1), drill_scale_index, true);
+  show_drill_setup();
 }
 
 /**
 *
 */
-void multi_click_down(void)
+void action_drill_scenario(void)
 {
-  if(multi_click_down_active == false)
-  {
-    multi_click_down_active = true;
-  }
-  else
-  {
-    multi_click_down_active = false;
-  }
+  drill_scenario_index = increase_value(0, (SCBA_DRILL_SCENARIOS-1), drill_scenario_index, true);
+  show_drill_setup();
 }
 
 /**
 *
 */
-void click_handler(uint8_t key)
+void show_drill_setup(void)
 {
-  switch(screen_status)
-  {    
-    case SCBA_CNFG_SCREEN_NR:
-      change_scba_nr(key);
-      break;
-
-    case SCBA_CNFG_SCREEN_BOTTLE_TYPE:
-      change_bottle_type(key);
-      break;
-
-    case SCBA_CNFG_SCREEN_BOTTLE_PRESSURE:
-      change_bottle_pressure(key);
-      break;
+  mini_snprintf(drill_setup_text, sizeof(drill_setup_text), "Drill x%d\n%s",
+                scba_drill_scales[drill_scale_index], scba_drill_scenarios[drill_scenario_index].name);
+  text_layer_set_text(scba_layer[active_scba].start_layer, drill_setup_text);
+}
 
-    case SCBA_START_SCREEN:
-    case SCBA_INFO_SCREEN:
-      switch_scba_selection(key);
-      break;
-    
-    case SCBA_UPDATE_PRESSURE:
-      change_bottle_pressure(key);
-      break;
-    
-    case SCBA_STOP_MONITORING:
-      stop_scba_monitoring(key);
-      break;
-    
-    default:
-      break;
-  }
+/**
+* From here on the team timing runs on the virtual clock and nothing of
+* the teams is stored or sent to the other watches.
+*/
+void action_start_drill(void)
+{
+  time_t seconds = 0;
+  uint16_t milliseconds = time_ms(&seconds, NULL);
+  
+  scba_drill_start(&scba_drill, scba_drill_scales[drill_scale_index], drill_scenario_index, seconds, milliseconds);
+  scba_drill_drops = 0;
+  text_layer_set_text(scba_layer[active_scba].start_layer, "Start SCBA");
+  show_drill_header();
 }
 
 /**
 *
 */
-void switch_scba_selection(uint8_t key)
+void action_cancel_drill(void)
 {
-  uint8_t temp_scba = active_scba;
-  switch(key)
-  {
-    case CLICK_UP:
-      active_scba = reduce_value(0, 2, temp_scba, true);
-      break;
-
-    case CLICK_DOWN:
-      active_scba = increase_value(0, 2, temp_scba, true);
-      break;
-    
-    case CLICK_SELECT:
-      if((scba_team_data[active_scba].scba_team_status == SCBA_THIRD_FULL_BOTTLE_ALARM) || (scba_team_data[active_scba].scba_team_status == SCBA_HALF_FULL_BOTTLE_ALARM) ||
-         (scba_team_data[active_scba].scba_team_status == SCBA_THIRD_EMPTY_BOTTLE_ALARM) || (scba_team_data[active_scba].scba_team_status == SCBA_EMPTY_BOTTLE_ALARM))
-      {
-        text_layer_set_text_color(scba_layer[active_scba].scba_team_nr, GColorBlack);
-        text_layer_set_background_color(scba_layer[active_scba].scba_team_nr, GColorClear);
-        scba_team_data[active_scba].scba_team_status ++;
-      }
-      else if(scba_team_data[active_scba].scba_team_status == SCBA_NOT_STARTED)
-      {
-        layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, true);
-        layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, true);  
-        layer_set_hidden((Layer *)scba_layer[active_scba].scba_cnfg_layer, false);
-        mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_nr);
-        text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, text_buffer);
-        screen_status = SCBA_CNFG_SCREEN_NR;
-      }
-      else
-      {
-#ifdef PBL_COLOR
-        text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorWhite);
-#else        
-        text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorClear);   
-#endif // #ifdef PBL_COLOR
-        text_layer_set_background_color(scba_layer[active_scba].scba_bottle_pressure, GColorBlack); 
-        screen_status = SCBA_UPDATE_PRESSURE;  
-      }
-      break;
-    
-    default:
-      break;
-  }
-  change_active_scba_icon();
+  text_layer_set_text(scba_layer[active_scba].start_layer, "Start SCBA");
 }
 
 /**
-*
+* Asked in the row of the active team, from an idle row or from the stop
+* question of a running one.
 */
-void change_scba_nr(uint8_t key)
+void action_ask_end_drill(void)
 {
-  uint8_t temp_team = scba_team_data[active_scba].scba_team_nr;
-  switch(key)
-  {
-    case CLICK_UP:
-      scba_team_data[active_scba].scba_team_nr = increase_value(1, SCBA_TEAM_HIGHEST_NR, temp_team, true);
-      break;
-    
-    case CLICK_DOWN:
-      scba_team_data[active_scba].scba_team_nr = reduce_value(1, SCBA_TEAM_HIGHEST_NR, temp_team, true);
-      break;
-    
-    case CLICK_SELECT:
-      text_layer_set_text(scba_layer[active_scba].cnfg_text_layer, "Size:");
-      text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_name);
-      bitmap_layer_set_bitmap(scba_layer[active_scba].cnfg_bitmap_layer, icon_full_bottle);
-      screen_status = SCBA_CNFG_SCREEN_BOTTLE_TYPE;
-      break;
-  }
-  
-  if((key == CLICK_UP) || (key == CLICK_DOWN))
+  layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, false);
+  if(scba_layer[active_scba].scba_info_layer != NULL)
   {
-    mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_nr);
-    text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, text_buffer); 
+    layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, true);  
   }
+  text_layer_set_text(scba_layer[active_scba].start_layer, "End the drill?");
 }
 
 /**
-*
+* Drops all drill teams, the real state is restored from the other
+* watches since their changes were ignored during the drill.
 */
-void change_bottle_type(uint8_t key)
+void action_end_drill(void)
 {
-  uint8_t temp_bottle = 0;
-  switch(key)
-  {
-    case CLICK_UP:
-      do
-      {
-        temp_bottle = scba_team_data[active_scba].scba_team_bottle_type;
-        scba_team_data[active_scba].scba_team_bottle_type = increase_value(0, (SCBA_AVAILABLE_BOTTLE_TYPES-1), temp_bottle, true);
-      }while(scba_bottle_type_available[scba_team_data[active_scba].scba_team_bottle_type] == 0);
-      break;
-    
-    case CLICK_DOWN:
-      do
-      {
-        temp_bottle = scba_team_data[active_scba].scba_team_bottle_type;
-        scba_team_data[active_scba].scba_team_bottle_type = reduce_value(0, (SCBA_AVAILABLE_BOTTLE_TYPES-1), temp_bottle, true);
-      }while(scba_bottle_type_available[scba_team_data[active_scba].scba_team_bottle_type] == 0);
-      break;
-    
-    case CLICK_SELECT:
-      // set default pressure according to the selected bottle type
-      if(imperial_units == AVAILABLE)
-      {
-        scba_team_data[active_scba].scba_team_bottle_pressure = scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_default_pressure_in_psi;                    
-      }
-      else
-      {
-        scba_team_data[active_scba].scba_team_bottle_pressure = scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_default_pressure;     
-      }
-      text_layer_set_text(scba_layer[active_scba].cnfg_text_layer, "Pressure:");
-      mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_bottle_pressure);
-      text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, text_buffer);
-      screen_status = SCBA_CNFG_SCREEN_BOTTLE_PRESSURE;
-      break;
-  }
+  uint8_t i = 0;
+  
+  scba_drill.active = false;
   
-  if((key == CLICK_UP) || (key == CLICK_DOWN))
+  for(i=0; i<SCBA_TEAMS; i++)
   {
-    text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_name);  
+    destroy_scba_info_layer(i);
+    initialize_scba_team(i);
+    schedule_scba_team_check(i);
+    show_scba_team_view(i);
   }
+  show_drill_header();
+  
+  sync_resend_request = true;
+  send_sync_deltas();
 }
 
 /**
-*
+* A drill is marked in the header as long as it runs.
 */
-void change_bottle_pressure(uint8_t key)
+void show_drill_header(void)
 {
-  uint16_t max_pressure = 0;
-  uint16_t min_pressure = 0;
-  uint16_t temp_pressure = scba_team_data[active_scba].scba_team_bottle_pressure;
-  
-  if(imperial_units == AVAILABLE)
+  if(scba_drill.active == true)
   {
-    max_pressure = ((uint32_t)scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_default_pressure_in_psi * 110 ) / 100;
-    min_pressure = SCBA_BOTTLE_MIN_PRESSURE * BAR_TO_PSI_FACTOR;
+    mini_snprintf(drill_header_text, sizeof(drill_header_text), "DRILL x%d", scba_drill.scale);
+    text_layer_set_text(g_header_layer, drill_header_text);
+    text_layer_set_text_color(g_header_layer, GColorWhite);
+#ifdef PBL_COLOR
+    text_layer_set_background_color(g_header_layer, GColorRed);
+#else
+    text_layer_set_background_color(g_header_layer, GColorBlack);
+#endif // #ifdef PBL_COLOR
   }
   else
   {
-    max_pressure = (scba_bottle_types[scba_team_data[active_scba].scba_team_bottle_type].bottle_default_pressure * 110 ) / 100;
-    min_pressure = SCBA_BOTTLE_MIN_PRESSURE;
-  }
-
-  switch(key)
-  {
-    case CLICK_UP:
-      scba_team_data[active_scba].scba_team_bottle_pressure = increase_value(min_pressure, max_pressure, temp_pressure, false);    
-      break;
-    
-    case CLICK_DOWN:
-      scba_team_data[active_scba].scba_team_bottle_pressure = reduce_value(min_pressure, max_pressure, temp_pressure, false);    
-      break;
-    
-    case CLICK_SELECT:
-      if(screen_status != SCBA_UPDATE_PRESSURE)
-      {
-        layer_set_hidden((Layer *)scba_layer[active_scba].scba_cnfg_layer, true);
-        layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, false);
-        time(&scba_team_data[active_scba].scba_team_start_time);
-        scba_team_data[active_scba].scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
-      }
-      calc_scba_team_air_volume(active_scba); 
-      update_scba_team_end_time(active_scba);
-      update_scba_team_info_screen(active_scba);
-      
-      text_layer_set_text_color(scba_layer[active_scba].scba_bottle_pressure, GColorBlack);
-      text_layer_set_background_color(scba_layer[active_scba].scba_bottle_pressure, GColorClear);      
-      
-      scba_team_data[active_scba].scba_team_pressure_psi = imperial_units;
-    
-      persist_write_data(scba_team_storage_keys[active_scba], &scba_team_data[active_scba], sizeof(scba_team_data[active_scba]));   
-      screen_status = SCBA_INFO_SCREEN;
-      break;
-  }
-  
-  if((key == CLICK_UP) || (key == CLICK_DOWN))
-  {
-    mini_snprintf(text_buffer, sizeof(text_buffer), "%d", scba_team_data[active_scba].scba_team_bottle_pressure);
-    text_layer_set_text(scba_layer[active_scba].cnfg_text_layer_input, text_buffer);
-    if(screen_status == SCBA_UPDATE_PRESSURE)
-    {
-      update_scba_team_info_screen(active_scba);
-    }
+    text_layer_set_text(g_header_layer, "SCBA Tracker");
+    text_layer_set_text_color(g_header_layer, GColorBlack);
+    text_layer_set_background_color(g_header_layer, GColorClear);
   }
 }
 
@@ -833,6 +3358,11 @@ void change_active_scba_icon(void)
   
   for(i=0; i<SCBA_TEAMS; i++)
   {
+    // not started teams are built after the first frame
+    if(scba_layer[i].active_layer == NULL)
+    {
+      continue;
+    }
     if(active_scba == i)
     {
         layer_set_hidden((Layer *)scba_layer[i].active_layer, false);
@@ -844,34 +3374,6 @@ void change_active_scba_icon(void)
   }
 }
 
-/**
-*
-*/
-void stop_scba_monitoring(uint8_t key)
-{
-  switch(key)
-  {
-    case CLICK_SELECT:
-      text_layer_set_text(scba_layer[active_scba].start_layer, "Start SCBA");
-      text_layer_set_text(scba_layer[active_scba].cnfg_text_layer, "TEAM\nNr.:");
-      bitmap_layer_set_bitmap(scba_layer[active_scba].cnfg_bitmap_layer, icon_scba_firefighter);
-      initialize_scba_team(active_scba);
-      persist_delete(scba_team_storage_keys[active_scba]);
-      screen_status = SCBA_INFO_SCREEN;
-      break;
-    
-    case CLICK_UP:
-    case CLICK_DOWN:
-      layer_set_hidden((Layer *)scba_layer[active_scba].start_layer, true);
-      layer_set_hidden((Layer *)scba_layer[active_scba].scba_info_layer, false);  
-      screen_status = SCBA_INFO_SCREEN;
-      break;
-    
-    default:
-      break;
-  }
-}
-
 /**
 *
 */
@@ -884,139 +3386,87 @@ void set_text_layer_font(TextLayer *layer, GColor background_color, GColor text_
 }
 
 /**
-*
+* Runs the alarm rules of the model for the team and shows the result,
+* returns true while an alarm is not acknowledged.
 */
 bool update_scba_team_info_screen(uint8_t team_nr)
 {
-  time_t temp_time = 0;
-  time_t absolute_delta_time = 0;
-  static uint8_t cnt[SCBA_TEAMS] = {19, 19, 19};
-  uint16_t team_default_pressure = 0;
-  uint16_t team_pressure = scba_team_data[team_nr].scba_team_bottle_pressure;
-  uint16_t team_pressure_third = 0;
-  uint16_t low_level_pressure = 0;
-  uint16_t empty_bottle_pressure = 0;
-  bool alarm = false;
+  const scba_pressure_levels_t *levels = &scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].levels[imperial_units];
+  uint8_t events = scba_model_evaluate(&scba_team_data[team_nr], levels);
+  
+  raise_scba_team_alarm(team_nr, events);
+  show_scba_team_times(team_nr);
+  show_scba_team_pressure(team_nr);
+  show_scba_team_events(team_nr, events);
+  update_scba_overview(team_nr);
+  return ((events & SCBA_MODEL_EVENT_ALARM) != 0);
+}
 
-  if(imperial_units == AVAILABLE)
-  {
-    team_default_pressure = scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].bottle_default_pressure_in_psi;
-    low_level_pressure = SCBA_BOTTLE_MIN_PRESSURE * BAR_TO_PSI_FACTOR;
-    empty_bottle_pressure = (low_level_pressure * 80) / 100;
-    team_pressure_third = (team_default_pressure - low_level_pressure) / 4;
-  }
-  else
-  {
-    team_default_pressure = scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].bottle_default_pressure;
-    low_level_pressure = SCBA_BOTTLE_MIN_PRESSURE;
-    empty_bottle_pressure = (low_level_pressure * 80) / 100;
-    team_pressure_third = (team_default_pressure - low_level_pressure) / 4;    
-  }
-   
-  time(&temp_time);
-  absolute_delta_time = temp_time - scba_team_data[team_nr].scba_team_start_time;
+/**
+*
+*/
+void show_scba_team_times(uint8_t team_nr)
+{
+  time_t absolute_delta_time = scba_now() - scba_team_data[team_nr].scba_team_start_time;
   
-  mini_snprintf(scba_layer[team_nr].text_pressure, sizeof(scba_layer[team_nr].text_pressure), "%d", scba_team_data[team_nr].scba_team_bottle_pressure);
-  mini_snprintf(scba_layer[team_nr].text_team_nr, sizeof(scba_layer[team_nr].text_team_nr), "%d", scba_team_data[team_nr].scba_team_nr);
   strftime(scba_layer[team_nr].text_start_time, sizeof("00:00"), "%H:%M", localtime(&scba_team_data[team_nr].scba_team_start_time));
   strftime(scba_layer[team_nr].text_passed_time, sizeof("00"), "%M", localtime(&absolute_delta_time));
+}
+
+/**
+* Also the preview while a pressure is entered, it raises no alarm.
+*/
+void show_scba_team_pressure(uint8_t team_nr)
+{
+  mini_snprintf(scba_layer[team_nr].text_pressure, sizeof(scba_layer[team_nr].text_pressure), "%d", scba_team_data[team_nr].scba_team_bottle_pressure);
+  mini_snprintf(scba_layer[team_nr].text_team_nr, sizeof(scba_layer[team_nr].text_team_nr), "%d", scba_team_data[team_nr].scba_team_nr);
+  
+  if(scba_layer[team_nr].scba_info_layer != NULL)
+  {
+    layer_mark_dirty(text_layer_get_layer(scba_layer[team_nr].scba_bottle_pressure));
+  }
+}
+
+/**
+* Bottle icon by the pressure level, vibrates for alarms and repeats the
+* mayday vibration every 20 calls.
+*/
+void show_scba_team_events(uint8_t team_nr, uint8_t events)
+{
+  static uint8_t cnt[SCBA_TEAMS] = {19, 19, 19};
+  GBitmap * const bottle_icons[SCBA_LEVELS] = {
+    icon_small_full_bottle, icon_small_third_full_bottle, icon_small_half_full_bottle,
+    icon_small_third_empty_bottle, icon_small_empty_bottle, icon_small_empty_bottle
+  };
+  const scba_pressure_levels_t *levels = &scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].levels[imperial_units];
+  uint8_t level = scba_model_level(scba_team_data[team_nr].scba_team_bottle_pressure, levels);
   
-  // set actions according to the bottle pressure
-  // mayday alarm
-  if(team_pressure < empty_bottle_pressure)
+  if((events & SCBA_MODEL_EVENT_MAYDAY) != 0)
   {
-    bitmap_layer_set_bitmap(scba_layer[team_nr].scba_info_team_layer, icon_small_stop_signe);
+    bitmap_layer_set_bitmap(scba_layer[team_nr].scba_info_team_layer, get_icon(&icon_small_stop_signe, RESOURCE_ID_SMALL_STOP_SIGNE));
     cnt[team_nr] ++;
     
     if(cnt[team_nr] >= 20)
     {
+      SCBA_TRACE_ADD(SCBA_TRACE_VIBE_DOUBLE, 1);
       vibes_double_pulse(); 
       cnt[team_nr] = 0; 
     }
     bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_empty_bottle);
   }
-  // return team pressure alarm 
-  else if(team_pressure < low_level_pressure)
-  {
-    if(scba_team_data[team_nr].scba_team_status < SCBA_EMPTY_BOTTLE_ALARM_CONFIRMED)
-    {
-      scba_team_data[team_nr].scba_team_status = SCBA_EMPTY_BOTTLE_ALARM;
-      alarm = true;
-    }
-    else
-    {
-      bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_empty_bottle);
-    }
-  }
-  // third third alarm
-  else if(team_pressure < (team_default_pressure - (3 * team_pressure_third)))
-  {
-    if (scba_team_data[team_nr].scba_team_status < SCBA_THIRD_EMPTY_BOTTLE_ALARM_CONFIRMED)
-    {
-      scba_team_data[team_nr].scba_team_status = SCBA_THIRD_EMPTY_BOTTLE_ALARM;
-      alarm = true;
-    }
-    else
-    {
-      bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_third_empty_bottle);
-    }
-  }
-  // second third alarm
-  else if(team_pressure < (team_default_pressure - (2 * team_pressure_third)))
-  {
-    if(scba_team_data[team_nr].scba_team_status < SCBA_HALF_FULL_BOTTLE_ALARM_CONFIRMED)
-    {
-      scba_team_data[team_nr].scba_team_status = SCBA_HALF_FULL_BOTTLE_ALARM;
-      alarm = true;
-    }
-    else
-    {
-      bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_half_full_bottle);
-    }
-  }
-  // first third alarm
-  else if(team_pressure < (team_default_pressure - team_pressure_third))
-  {
-    if(scba_team_data[team_nr].scba_team_status < SCBA_THIRD_FULL_BOTTLE_ALARM_CONFIRMED)
-    {
-      scba_team_data[team_nr].scba_team_status = SCBA_THIRD_FULL_BOTTLE_ALARM;
-      alarm = true;
-    }
-    else
-    {
-      bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_third_full_bottle);
-    }
-  }
-  else
-  {
-    bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_full_bottle);
-  }
-  
-  if(alarm == true)
+  else if((events & SCBA_MODEL_EVENT_ALARM) != 0)
   {
+    SCBA_TRACE_ADD(SCBA_TRACE_VIBE_SHORT, 1);
     vibes_short_pulse();
     bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, icon_small_exclamation_mark);
   }
-  else if(team_pressure >= empty_bottle_pressure)
-  {
-    bitmap_layer_set_bitmap(scba_layer[team_nr].scba_info_team_layer, icon_small_firefighter);
-  }
-  
-  return (alarm);
-}
-
-/**
-*
-*/
-void reduce_scba_team_air_volume(uint8_t team_nr)
-{
-  if(scba_team_data[team_nr].scba_team_bottle_air_volume >= (scba_breathing_rate / 2))
-  {
-    scba_team_data[team_nr].scba_team_bottle_air_volume -= (scba_breathing_rate / 2);  
-  }
   else
   {
-    scba_team_data[team_nr].scba_team_bottle_air_volume = 0;
+    bitmap_layer_set_bitmap(scba_layer[team_nr].scba_bottle_layer, bottle_icons[level]);
+    if(level != SCBA_LEVEL_MAYDAY)
+    {
+      bitmap_layer_set_bitmap(scba_layer[team_nr].scba_info_team_layer, icon_small_firefighter);
+    }
   }
 }
 
@@ -1025,14 +3475,7 @@ void reduce_scba_team_air_volume(uint8_t team_nr)
 */
 void calc_scba_team_air_pressure(uint8_t team_nr)
 {
-  if(imperial_units == AVAILABLE)
-  {
-    scba_team_data[team_nr].scba_team_bottle_pressure = (scba_team_data[team_nr].scba_team_bottle_air_volume * BAR_TO_PSI_FACTOR) / scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].air_volume_in_dliter_per_bar;           
-  }
-  else
-  {
-    scba_team_data[team_nr].scba_team_bottle_pressure = (scba_team_data[team_nr].scba_team_bottle_air_volume ) / scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].air_volume_in_dliter_per_bar;       
-  }
+  scba_team_data[team_nr].scba_team_bottle_pressure = scba_model_pressure(&scba_team_data[team_nr], &scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type], imperial_units);
 }
 
 /**
@@ -1040,45 +3483,18 @@ void calc_scba_team_air_pressure(uint8_t team_nr)
 */
 void calc_scba_team_air_volume(uint8_t team_nr)
 {
-  uint32_t temp_pressure = 0;
-  
-  if(imperial_units == AVAILABLE)
-  {
-    temp_pressure = scba_team_data[team_nr].scba_team_bottle_pressure / BAR_TO_PSI_FACTOR;
-  }
-  else
-  {
-    temp_pressure = scba_team_data[team_nr].scba_team_bottle_pressure;
-  }
-  
-  scba_team_data[team_nr].scba_team_bottle_air_volume =  temp_pressure * scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type].air_volume_in_dliter_per_bar;
+  scba_team_data[team_nr].scba_team_bottle_air_volume = scba_model_air_volume(&scba_team_data[team_nr], &scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type], imperial_units);
 }
 
 /**
-*
+* Out of air, the prediction stays at the moment it was reached.
 */
 void update_scba_team_end_time(uint8_t team_nr)
 {
-  time_t temp_time = 0;
-  time_t expected_end_time = 0;
-  uint16_t safety_volume = scba_bottle_types[team_nr].air_volume_in_dliter_per_bar * SCBA_BOTTLE_MIN_PRESSURE;
-  uint16_t min_pressure = 0;
-  
-  time(&temp_time);
-  
-  if(imperial_units == AVAILABLE)
-  {
-    min_pressure = SCBA_BOTTLE_MIN_PRESSURE * BAR_TO_PSI_FACTOR;
-  }
-  else
+  if(scba_model_end_time(&scba_team_data[team_nr], &scba_bottle_types[scba_team_data[team_nr].scba_team_bottle_type], imperial_units,
+                         get_scba_team_breathing_rate(team_nr), scba_now(), &scba_team_end_time[team_nr]) == true)
   {
-    min_pressure = SCBA_BOTTLE_MIN_PRESSURE;  
-  }
-  
-  if(scba_team_data[team_nr].scba_team_bottle_pressure >= min_pressure)
-  {
-    expected_end_time = (temp_time + ( 60 * ((scba_team_data[team_nr].scba_team_bottle_air_volume - safety_volume) / scba_breathing_rate )));
-    strftime(scba_layer[team_nr].text_stop_time, sizeof("00:00"), "%H:%M", localtime(&expected_end_time));    
+    strftime(scba_layer[team_nr].text_stop_time, sizeof("00:00"), "%H:%M", localtime(&scba_team_end_time[team_nr]));
   }
 }
 
@@ -1088,29 +3504,67 @@ void update_scba_team_end_time(uint8_t team_nr)
 void load_app_configuration()
 {
   uint8_t i = 0;
+  uint8_t bottle_mask = (1 << SCBA_DEFAULT_BOTTLE_TYPES) - 1;
+  int32_t default_bottle = 0;
+  scba_config_msg_t config;
+  
+  if(persist_exists(SCBA_STORE_KEY_CONFIG))
+  {
+    memset(&config, 0, sizeof(config));
+    persist_read_data(SCBA_STORE_KEY_CONFIG, &config, sizeof(config));
+    // a blob of any other version is invalid, apply_app_configuration() rejects it
+    if(apply_app_configuration(&config) == true)
+    {
+      return;
+    }
+  }
   
+  // settings stored by versions before the binary configuration message
   if(persist_exists(SCBA_STORE_KEY_BREATHING_RATE))
   {
     scba_breathing_rate = persist_read_int(SCBA_STORE_KEY_BREATHING_RATE);
   }
 
-  for(i=0; i<SCBA_AVAILABLE_BOTTLE_TYPES; i++)
+  for(i=0; i<SCBA_DEFAULT_BOTTLE_TYPES; i++)
   {
-    if(persist_exists(scba_bottle_config_keys[i]))
+    if(persist_exists(scba_bottle_config_keys[i]) && (persist_read_int(scba_bottle_config_keys[i]) == NOT_AVAILABLE))
     {
-      scba_bottle_type_available[i] = persist_read_int(scba_bottle_config_keys[i]);      
+      bottle_mask &= ~(1 << i);
     } 
   }
+  
+  if(scba_bottles_load(scba_default_bottle_catalog, SCBA_DEFAULT_BOTTLE_TYPES, bottle_mask) == false)
+  {
+    scba_bottles_load(scba_default_bottle_catalog, SCBA_DEFAULT_BOTTLE_TYPES, (1 << SCBA_DEFAULT_BOTTLE_TYPES) - 1);
+  }
 
   if(persist_exists(SCBA_STORE_KEY_DEFAULT_BOTTLE))
   {
-    scba_default_bottle_type = persist_read_int(SCBA_STORE_KEY_DEFAULT_BOTTLE);
+    default_bottle = persist_read_int(SCBA_STORE_KEY_DEFAULT_BOTTLE);
+    if((default_bottle < SCBA_DEFAULT_BOTTLE_TYPES) && (scba_bottle_enabled(default_bottle) == true))
+    {
+      scba_default_bottle_type = default_bottle;
+    }
   }
   
-  if(persist_exists(SCBA_STORE_KEY_IMPERIAL_UNITS))
+  if(persist_exists(SCBA_STORE_KEY_IMPERIAL_UNITS) && (persist_read_int(SCBA_STORE_KEY_IMPERIAL_UNITS) == AVAILABLE))
   {
-    imperial_units = persist_read_int(SCBA_STORE_KEY_IMPERIAL_UNITS);
+    imperial_units = AVAILABLE;
   }    
+  
+  // reported to the phone in the layout of a configuration message
+  scba_config.version = SCBA_CONFIG_VERSION;
+  scba_config.breathing_rate = scba_breathing_rate / 10;
+  scba_config.bottle_mask = 0;
+  for(i=0; i<SCBA_DEFAULT_BOTTLE_TYPES; i++)
+  {
+    scba_config.bottle_mask |= (scba_bottle_enabled(i) == true) ? (1 << i) : 0;
+  }
+  scba_config.default_bottle = scba_default_bottle_type;
+  scba_config.imperial_units = imperial_units;
+  scba_config.bottle_count = SCBA_DEFAULT_BOTTLE_TYPES;
+  scba_config.check_interval = scba_check_interval;
+  memcpy(scba_config.bottles, scba_default_bottle_catalog, sizeof(scba_default_bottle_catalog));
 }
 
 /**
@@ -1203,6 +3657,31 @@ void initialize_scba_team(uint8_t team_nr)
   scba_team_data[team_nr].scba_team_bottle_type = scba_default_bottle_type;
   scba_team_data[team_nr].scba_team_status = SCBA_NOT_STARTED;
   scba_team_data[team_nr].scba_team_pressure_psi = imperial_units;
+  scba_rate_reset(&scba_team_data[team_nr].scba_team_rate);
+  scba_team_end_time[team_nr] = 0;
+  scba_history_reset(&scba_team_history[team_nr]);
+  if(scba_ack_drop(&scba_ack, team_nr) == true)
+  {
+    write_persist_data(SCBA_STORE_KEY_ACK, &scba_ack, sizeof(scba_ack));
+  }
+  if(scba_team_sector[team_nr] != SCBA_SECTOR_NONE)
+  {
+    scba_team_sector[team_nr] = SCBA_SECTOR_NONE;
+    if(scba_drill.active == false)
+    {
+      write_persist_data(SCBA_STORE_KEY_SECTORS, scba_team_sector, sizeof(scba_team_sector));
+    }
+  }
+  update_scba_overview(team_nr);
+}
+
+/**
+*
+*/
+uint16_t get_scba_team_breathing_rate(uint8_t team_nr)
+{
+  // drill teams breathe as their scenario says
+  return (scba_rate_get(&scba_team_data[team_nr].scba_team_rate, scba_drill_rate(&scba_drill, scba_breathing_rate)));
 }
 
 /**
@@ -1223,7 +3702,7 @@ void convert_pressure(uint8_t team_nr)
   scba_team_data[team_nr].scba_team_bottle_pressure = temp_pressure;
 
   scba_team_data[team_nr].scba_team_pressure_psi = imperial_units;
-  persist_write_data(scba_team_storage_keys[team_nr], &scba_team_data[team_nr], sizeof(scba_team_data[team_nr]));
+  persist_scba_team(team_nr);
 }
 
 //* ----------- main call -------------- *//
@@ -1234,4 +3713,5 @@ int main(void)
   handle_init();
   app_event_loop();
   handle_deinit();
+  return (0);
 }
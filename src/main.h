@@ -3,32 +3,27 @@
 //* ------------------------------------ *//
 #include <pebble.h>
 #include "mini-printf.h"
+#include "scba_icons.h"
+#include "scba_states.h"
+#include "scba_bottles.h"
+#include "scba_rate.h"
+#include "scba_sync.h"
+#include "scba_reminders.h"
+#include "scba_overview.h"
+#include "scba_history.h"
+#include "scba_drill.h"
+#include "scba_trace.h"
+#include "scba_model.h"
+#include "scba_snapshot.h"
+#include "scba_qr.h"
+#include "scba_ack.h"
+#include "scba_sector.h"
+#include "scba_roster.h"
+#include "scba_telemetry.h"
 
 //* -------- general definitions ------- *//
 //                                        //
 //* ------------------------------------ *//
-#define SCBA_START_SCREEN  0x00
-#define SCBA_CNFG_SCREEN_NR  0x01
-#define SCBA_CNFG_SCREEN_BOTTLE_TYPE  0x02
-#define SCBA_CNFG_SCREEN_BOTTLE_PRESSURE  0x03
-#define SCBA_INFO_SCREEN  0x04
-#define SCBA_ALARM  0x05
-#define SCBA_UPDATE_PRESSURE  0x06
-#define SCBA_STOP_MONITORING  0x07
-  
-#define SCBA_NOT_STARTED 0x00
-#define SCBA_FULL_BOTTLE_NO_ALARM 0x01
-#define SCBA_THIRD_FULL_BOTTLE_ALARM 0x02
-#define SCBA_THIRD_FULL_BOTTLE_ALARM_CONFIRMED 0x03
-#define SCBA_HALF_FULL_BOTTLE_ALARM 0x04
-#define SCBA_HALF_FULL_BOTTLE_ALARM_CONFIRMED 0x05
-#define SCBA_THIRD_EMPTY_BOTTLE_ALARM 0x06
-#define SCBA_THIRD_EMPTY_BOTTLE_ALARM_CONFIRMED 0x07
-#define SCBA_MIN_BOTTLE_PRESSURE_ALARM 0x08
-#define SCBA_MIN_BOTTLE_PRESSURE_ALARM_CONFIRMED 0x09
-#define SCBA_EMPTY_BOTTLE_ALARM 0x0A
-#define SCBA_EMPTY_BOTTLE_ALARM_CONFIRMED 0x0B
-  
 #define SCBA_STORE_KEY_TEAM_ONE   0x0001
 #define SCBA_STORE_KEY_TEAM_TWO   0x0010
 #define SCBA_STORE_KEY_TEAM_THREE 0x0100
@@ -41,40 +36,69 @@
 #define SCBA_STORE_KEY_BOTTLE_SIX_AVAILABLE 0x0009
 #define SCBA_STORE_KEY_DEFAULT_BOTTLE 0x0007
 #define SCBA_STORE_KEY_IMPERIAL_UNITS 0x000A
+#define SCBA_STORE_KEY_CONFIG 0x000B
+#define SCBA_STORE_KEY_SYNC 0x000C
+#define SCBA_STORE_KEY_UI_STATE 0x000D
+#define SCBA_STORE_KEY_HISTORY 0x000E
+#define SCBA_STORE_KEY_ACK 0x000F
+#define SCBA_STORE_KEY_SECTORS 0x0011
+#define SCBA_STORE_KEY_ROSTER 0x0012
+
+#define SCBA_MSG_KEY_CONFIG 0x000B
+#define SCBA_MSG_KEY_SYNC 0x000C
+#define SCBA_MSG_KEY_ROSTER 0x000D  // one team number per message, fits the inbox of the others
+#define SCBA_MSG_KEY_TELEMETRY 0x000E
+#define SCBA_CONFIG_VERSION 3
+#define SCBA_CONFIG_REQUEST 0x00    // a configuration message of this byte alone asks for the configuration
+#define SCBA_MIN_BREATHING_RATE 10  // in liter per minute
+#define SCBA_MAX_BREATHING_RATE 150 // in liter per minute
+#define SCBA_MAX_CHECK_INTERVAL 60  // in minutes
   
 #define SCBA_TEAMS 3
   
 #define SCBA_DATA_DEFAULT_PRESSURE 300
 #define SCBA_DATA_DEFAULT_BOTTLE_TYPE  0
 #define SCBA_DEFAULT_AIR_CONSUMPTION 500  // in dliter per minute
-#define SCBA_BOTTLE_MIN_PRESSURE 50 // in bar
-#define SCBA_AVAILABLE_BOTTLE_TYPES 6
 #define SCBA_TEAM_HIGHEST_NR  10
 
+#define SCBA_SYNC_MAX_BATCH_SIZE (SCBA_TEAMS * SCBA_SYNC_MAX_TEAM_SIZE)
+#define SCBA_SYNC_RETRY_DELAY 30000 // in ms
+
+#define SCBA_MAX_TICK_SECONDS 120  // a longer gap between two ticks is a clock change, not missed ticks
+
+// launch phases, each measured in ms since handle_init() started
+#define SCBA_LAUNCH_INIT 0x00
+#define SCBA_LAUNCH_CONFIG 0x01
+#define SCBA_LAUNCH_RESOURCES 0x02
+#define SCBA_LAUNCH_LAYERS 0x03
+#define SCBA_LAUNCH_FIRST_FRAME 0x04   // first frame showing the running teams
+#define SCBA_LAUNCH_DEFERRED 0x05      // everything else is built
+#define SCBA_LAUNCH_PHASES 0x06
+
+#define SCBA_OVERVIEW_ROW_HEIGHT 43
+#define SCBA_SECTOR_ROW_HEIGHT 20
+#define SCBA_HANDOVER_MODULE_SIZE 4  // in pixels, the code takes 116 of the 144 x 168
+
 #define NUM_ACTION_BAR_ITEMS   3
   
-#define CLICK_UP 0x02
-#define CLICK_DOWN 0x01
-#define CLICK_SELECT 0x00
 #define ORDINARY_CLICK 0x01
 #define MULTI_CLICK 0x0A
 #define LONG_CLICK_CNT_DELAY 50 // in ms
-#define BAR_TO_PSI_FACTOR 14.503773773
 #define NOT_AVAILABLE 0
 #define AVAILABLE 1
 #define DEBUG
+//#define SCBA_TRACE  // logs the energy trace for tools/energy_report.py
+#define SCBA_LIGHT_TIMEOUT 3 // in s, the backlight stays on after an interaction
   
 //* ------- structure definitions ------ *//
 //                                        //
 //* ------------------------------------ *//
 typedef  struct
 {
+  Layer *scba_team_layer;
   Layer *scba_info_layer;
-  Layer *scba_cnfg_layer;
   TextLayer  *start_layer;
   TextLayer  *cnfg_scba_nr;
-  TextLayer  *cnfg_text_layer;
-  TextLayer  *cnfg_text_layer_input;
   TextLayer  *cnfg_bottle_type;
   TextLayer  *cnfg_bottle_pressure;
   TextLayer  *scba_start_time;
@@ -87,7 +111,6 @@ typedef  struct
   TextLayer  *scba_bottle_pressure;  
   BitmapLayer  *scba_info_team_layer;
   BitmapLayer  *scba_bottle_layer;
-  BitmapLayer  *cnfg_bitmap_layer;
   BitmapLayer  *active_layer;
   char text_start_time[6];
   char text_stop_time[6];
@@ -96,25 +119,53 @@ typedef  struct
   char text_pressure[5];
 }scba_layer_t;
 
+// one team on the commander overview, moved as a whole when the order changes
+typedef  struct
+{
+  Layer *row_layer;
+  BitmapLayer *icon_layer;
+  TextLayer *text_layer;
+  char text[16];
+}scba_overview_row_t;
+
+typedef  struct
+{
+  Layer *scba_cnfg_layer;
+  TextLayer  *cnfg_text_layer;
+  TextLayer  *cnfg_text_layer_input;
+  BitmapLayer  *cnfg_bitmap_layer;
+}scba_cnfg_layer_t;
+
+// payload of SCBA_MSG_KEY_CONFIG, also stored as is under SCBA_STORE_KEY_CONFIG,
+// only the first bottle_count entries of the catalog are transferred
+typedef struct
+{
+  uint8_t  version;
+  uint8_t  breathing_rate;  // in liter per minute
+  uint8_t  bottle_mask;     // bit n set: bottles[n] is selectable
+  uint8_t  default_bottle;
+  uint8_t  imperial_units;
+  uint8_t  bottle_count;
+  uint8_t  check_interval;  // gauge check reminder in minutes, 0: off
+  scba_bottle_cnfg_t bottles[SCBA_MAX_BOTTLE_TYPES];
+}__attribute__((__packed__)) scba_config_msg_t;
+
+#define SCBA_CONFIG_HEADER_SIZE offsetof(scba_config_msg_t, bottles)
+#define SCBA_CONFIG_SIZE(bottle_count) (SCBA_CONFIG_HEADER_SIZE + ((bottle_count) * sizeof(scba_bottle_cnfg_t)))
+
+// stored under SCBA_STORE_KEY_UI_STATE on every change, restored at launch
 typedef struct
 {
-  uint8_t  scba_team_nr;
-  time_t   scba_team_start_time;
-  uint16_t scba_team_bottle_pressure;
-  uint16_t scba_team_bottle_air_volume;
-  uint8_t  scba_team_bottle_type;
-  uint8_t  scba_team_status;
-  uint8_t  scba_team_pressure_psi;
-}__attribute__((__packed__)) scba_team_t;
+  uint8_t active_scba;
+  uint8_t screen_status;
+}__attribute__((__packed__)) scba_ui_state_t;
 
+// stored under SCBA_STORE_KEY_SYNC, the clocks outlive the team records
 typedef struct
 {
-  uint8_t  bottle_volume_in_dliter;
-  uint16_t bottle_default_pressure;
-  uint16_t bottle_default_pressure_in_psi;
-  uint16_t air_volume_in_dliter_per_bar;
-  char*    bottle_name;
-}scba_bottle_t;
+  uint8_t  origin;  // id of this watch
+  scba_sync_clock_t clocks[SCBA_TEAMS][SCBA_SYNC_FIELDS];
+}__attribute__((__packed__)) scba_sync_store_t;
 
 //* ---------- global variables -------- *//
 //                                        //
@@ -0,0 +1,176 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Time from raising an alarm to its acknowledgement, per alarm level.
+//  Every team has at most one pending alarm. A higher alarm raised
+//  before the pending one was acknowledged counts that one as missed, it
+//  adds no time, so the slowest acknowledgements do not show up shorter
+//  than they were. The mayday has no acknowledgement of its own, the
+//  first press on the team closes it. The median is taken over the latest
+//  SCBA_ACK_SAMPLES times of a level, the worst time over all of them.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <string.h>
+#include "scba_ack.h"
+#include "mini-printf.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+static char* const scba_ack_names[SCBA_ACK_LEVELS] = {
+  "1/3 full", "1/2 full", "1/3 empty", "return", "mayday"
+};
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void scba_ack_add(scba_ack_stats_t *stats, uint8_t team, time_t now);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_ack_reset(scba_ack_stats_t *stats)
+{
+  memset(stats, 0, sizeof(scba_ack_stats_t));
+}
+
+/**
+* Forgets the recorded times, the alarms still pending are kept.
+*/
+void scba_ack_clear(scba_ack_stats_t *stats)
+{
+  memset(stats->samples, 0, sizeof(stats->samples));
+  memset(stats->worst, 0, sizeof(stats->worst));
+  memset(stats->count, 0, sizeof(stats->count));
+  memset(stats->missed, 0, sizeof(stats->missed));
+}
+
+/**
+* Takes the alarm of level (SCBA_LEVEL_* of scba_model.h) of a team, an
+* alarm the team already had is ignored. Returns true if it was taken.
+*/
+bool scba_ack_raise(scba_ack_stats_t *stats, uint8_t team, uint8_t level, time_t now)
+{
+  if((team >= SCBA_ACK_TEAMS) || (level == 0) || (level > SCBA_ACK_LEVELS) || (level <= stats->level[team]))
+  {
+    return (false);
+  }
+  if(((stats->pending & (1 << team)) != 0) && (stats->missed[stats->level[team]-1] < 0xFFFF))
+  {
+    stats->missed[stats->level[team]-1]++;
+  }
+  stats->level[team] = level;
+  stats->raised[team] = now;
+  stats->pending |= (1 << team);
+  return (true);
+}
+
+/**
+* Returns true if the team had an alarm pending.
+*/
+bool scba_ack_confirm(scba_ack_stats_t *stats, uint8_t team, time_t now)
+{
+  if((team >= SCBA_ACK_TEAMS) || ((stats->pending & (1 << team)) == 0))
+  {
+    return (false);
+  }
+  scba_ack_add(stats, team, now);
+  stats->pending &= ~(1 << team);
+  return (true);
+}
+
+/**
+* Forgets the alarms of a team that stopped or started again, returns true
+* if anything changed.
+*/
+bool scba_ack_drop(scba_ack_stats_t *stats, uint8_t team)
+{
+  if((team >= SCBA_ACK_TEAMS) || ((stats->level[team] == 0) && ((stats->pending & (1 << team)) == 0)))
+  {
+    return (false);
+  }
+  stats->level[team] = 0;
+  stats->pending &= ~(1 << team);
+  return (true);
+}
+
+/**
+* Median of the kept times of a level index (0: third full), 0 without any.
+*/
+uint16_t scba_ack_median(const scba_ack_stats_t *stats, uint8_t level)
+{
+  uint16_t sorted[SCBA_ACK_SAMPLES];
+  uint16_t value = 0;
+  uint8_t count = (stats->count[level] < SCBA_ACK_SAMPLES) ? stats->count[level] : SCBA_ACK_SAMPLES;
+  uint8_t i = 0;
+  uint8_t j = 0;
+
+  if(count == 0)
+  {
+    return (0);
+  }
+  for(i=0; i<count; i++)
+  {
+    value = stats->samples[level][i];
+    for(j=i; (j > 0) && (sorted[j-1] > value); j--)
+    {
+      sorted[j] = sorted[j-1];
+    }
+    sorted[j] = value;
+  }
+  return (((count % 2) != 0) ? sorted[count / 2] : ((sorted[(count / 2) - 1] + sorted[count / 2]) / 2));
+}
+
+/**
+* One entry per level: name, count, median and worst time in m:ss and the
+* missed alarms if there were any, the entries are joined by separator.
+*/
+int scba_ack_format(const scba_ack_stats_t *stats, char *buffer, size_t buffer_size, char *separator)
+{
+  int length = 0;
+  uint16_t median = 0;
+  uint8_t i = 0;
+
+  buffer[0] = '\0';
+  for(i=0; (i<SCBA_ACK_LEVELS) && (length < (int)buffer_size); i++)
+  {
+    median = scba_ack_median(stats, i);
+    length += mini_snprintf(&buffer[length], buffer_size - length, "%s%s %dx %d:%02d %d:%02d", (i > 0) ? separator : "",
+                            scba_ack_names[i], stats->count[i], median / 60, median % 60, stats->worst[i] / 60, stats->worst[i] % 60);
+    if(stats->missed[i] > 0)
+    {
+      length += mini_snprintf(&buffer[length], buffer_size - length, " %d missed", stats->missed[i]);
+    }
+  }
+  return (length);
+}
+
+/**
+* Records the time the pending alarm of a team waited.
+*/
+static void scba_ack_add(scba_ack_stats_t *stats, uint8_t team, time_t now)
+{
+  uint8_t level = stats->level[team] - 1;
+  time_t waited = now - stats->raised[team];
+  uint16_t seconds = (waited < 0) ? 0 : ((waited > SCBA_ACK_MAX_TIME) ? SCBA_ACK_MAX_TIME : (uint16_t)waited);
+
+  stats->samples[level][stats->count[level] % SCBA_ACK_SAMPLES] = seconds;
+  if(seconds > stats->worst[level])
+  {
+    stats->worst[level] = seconds;
+  }
+  if(stats->count[level] < 0xFFFF)
+  {
+    stats->count[level]++;
+  }
+}
@@ -0,0 +1,47 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_ACK__
+#define __SCBA_ACK__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// one per alarm of scba_model.h: SCBA_LEVEL_THIRD_FULL up to SCBA_LEVEL_MAYDAY
+#define SCBA_ACK_LEVELS 5
+#define SCBA_ACK_SAMPLES 7       // latest times per level kept for the median
+#define SCBA_ACK_TEAMS 3
+#define SCBA_ACK_MAX_TIME 0xFFFF // in seconds, longer times are cut
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// stored as a whole, 116 bytes
+typedef struct
+{
+  uint16_t samples[SCBA_ACK_LEVELS][SCBA_ACK_SAMPLES];  // in seconds, ring of the latest
+  uint16_t worst[SCBA_ACK_LEVELS];
+  uint16_t count[SCBA_ACK_LEVELS];   // acknowledged alarms, the next sample goes to count % SCBA_ACK_SAMPLES
+  time_t   raised[SCBA_ACK_TEAMS];   // when the pending alarm of a team was raised
+  uint8_t  level[SCBA_ACK_TEAMS];    // highest level raised since the team started, 0: none
+  uint8_t  pending;                  // bit n set: team n has an alarm that is not acknowledged
+  uint16_t missed[SCBA_ACK_LEVELS];  // alarms followed by a higher one before they were acknowledged
+}__attribute__((__packed__)) scba_ack_stats_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_ack_reset(scba_ack_stats_t *stats);
+void scba_ack_clear(scba_ack_stats_t *stats);
+bool scba_ack_raise(scba_ack_stats_t *stats, uint8_t team, uint8_t level, time_t now);
+bool scba_ack_confirm(scba_ack_stats_t *stats, uint8_t team, time_t now);
+bool scba_ack_drop(scba_ack_stats_t *stats, uint8_t team);
+uint16_t scba_ack_median(const scba_ack_stats_t *stats, uint8_t level);
+int scba_ack_format(const scba_ack_stats_t *stats, char *buffer, size_t buffer_size, char *separator);
+
+#endif
@@ -0,0 +1,200 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER                                     
+//                                                                                  
+//  DESCRIPTION: 
+//
+//  Catalog of the SCBA bottle types. The phone sends up to
+//  SCBA_MAX_BOTTLE_TYPES cylinders (volume, fill pressure and name). All
+//  values needed while tracking a team (air per bar, pressure levels of
+//  the alarms in bar and psi) are derived once when the catalog is
+//  loaded. The selectable cylinders are kept in a packed list, so the
+//  bottle selection steps through them without skipping disabled ones.
+//                                                                          
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <string.h>
+#include "scba_bottles.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void scba_bottle_derive(const scba_bottle_cnfg_t *cnfg, scba_bottle_t *bottle);
+static void scba_pressure_levels_derive(uint16_t full_pressure, uint16_t min_pressure, scba_pressure_levels_t *levels);
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+const scba_bottle_cnfg_t scba_default_bottle_catalog[SCBA_DEFAULT_BOTTLE_TYPES] = {
+  {90,   300,  "9l"},
+  {68,   300,  "6,8l"},
+  {80,   200,  "2x4l"},
+  {136,  300,  "2x6,8l"},
+  {60,   300,  "6l"},
+  {120,  300,  "2x6l"}
+};
+
+scba_bottle_t scba_bottle_types[SCBA_MAX_BOTTLE_TYPES];
+uint8_t scba_bottle_type_count = 0;
+
+// packed list of the selectable bottle types and the position of each
+// bottle type inside this list
+static uint8_t scba_enabled_bottles[SCBA_MAX_BOTTLE_TYPES];
+static uint8_t scba_enabled_bottle_pos[SCBA_MAX_BOTTLE_TYPES];
+static uint8_t scba_enabled_bottle_count = 0;
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+bool scba_bottle_cnfg_valid(const scba_bottle_cnfg_t *cnfg)
+{
+  uint32_t max_air_volume = 0;
+  
+  if((cnfg->volume_in_dliter < SCBA_BOTTLE_MIN_VOLUME) || 
+     (cnfg->fill_pressure <= SCBA_BOTTLE_MIN_PRESSURE) || (cnfg->fill_pressure > SCBA_BOTTLE_MAX_FILL_PRESSURE) ||
+     (cnfg->name[0] == '\0') || (memchr(cnfg->name, '\0', SCBA_BOTTLE_NAME_LEN) == NULL))
+  {
+    return (false);
+  }
+  // the air volume of a team is kept in 16 bit, including 10% over pressure
+  max_air_volume = (uint32_t)cnfg->volume_in_dliter * cnfg->fill_pressure * 110 / 100;
+  return (max_air_volume <= UINT16_MAX);
+}
+
+/**
+*
+*/
+bool scba_bottles_load(const scba_bottle_cnfg_t *catalog, uint8_t count, uint8_t enabled_mask)
+{
+  uint8_t i = 0;
+  
+  if((count == 0) || (count > SCBA_MAX_BOTTLE_TYPES) || ((enabled_mask & ((1 << count) - 1)) == 0))
+  {
+    return (false);
+  }
+  for(i=0; i<count; i++)
+  {
+    if(scba_bottle_cnfg_valid(&catalog[i]) == false)
+    {
+      return (false);
+    }
+  }
+  
+  scba_bottle_type_count = count;
+  scba_enabled_bottle_count = 0;
+  for(i=0; i<count; i++)
+  {
+    scba_bottle_derive(&catalog[i], &scba_bottle_types[i]);
+    scba_enabled_bottle_pos[i] = scba_enabled_bottle_count;
+    if((enabled_mask & (1 << i)) != 0)
+    {
+      scba_enabled_bottles[scba_enabled_bottle_count] = i;
+      scba_enabled_bottle_count++;
+    }
+  }
+  return (true);
+}
+
+/**
+*
+*/
+bool scba_bottle_enabled(uint8_t type)
+{
+  uint8_t pos = scba_enabled_bottle_pos[type];
+  
+  return ((pos < scba_enabled_bottle_count) && (scba_enabled_bottles[pos] == type));
+}
+
+/**
+* A running team keeps its bottle type, a new catalog must derive the same
+* values at that position.
+*/
+bool scba_bottle_unchanged(uint8_t type, const scba_bottle_cnfg_t *catalog, uint8_t count)
+{
+  scba_bottle_t bottle;
+  
+  if((type >= scba_bottle_type_count) || (type >= count))
+  {
+    return (false);
+  }
+  memset(&bottle, 0, sizeof(bottle));
+  scba_bottle_derive(&catalog[type], &bottle);
+  return (memcmp(&bottle, &scba_bottle_types[type], sizeof(bottle)) == 0);
+}
+
+/**
+* Returns the selectable bottle type after the given one, wrapping around.
+* A disabled type continues with the next enabled type behind it.
+*/
+uint8_t scba_bottle_next(uint8_t type)
+{
+  uint8_t pos = scba_enabled_bottle_pos[type];
+  
+  if(scba_bottle_enabled(type) == true)
+  {
+    pos++;
+  }
+  if(pos >= scba_enabled_bottle_count)
+  {
+    pos = 0;
+  }
+  return (scba_enabled_bottles[pos]);
+}
+
+/**
+* Returns the selectable bottle type before the given one, wrapping around.
+*/
+uint8_t scba_bottle_prev(uint8_t type)
+{
+  uint8_t pos = scba_enabled_bottle_pos[type];
+  
+  if(pos == 0)
+  {
+    pos = scba_enabled_bottle_count;
+  }
+  return (scba_enabled_bottles[pos - 1]);
+}
+
+/**
+*
+*/
+static void scba_bottle_derive(const scba_bottle_cnfg_t *cnfg, scba_bottle_t *bottle)
+{
+  uint32_t compressibility = 1000;
+  
+  // air does not compress ideally above 200 bar, a 300 bar bottle holds
+  // about 88.5% of volume x pressure
+  if(cnfg->fill_pressure > 200)
+  {
+    compressibility = 1000 - (((uint32_t)(cnfg->fill_pressure - 200) * 115) / 100);
+  }
+  bottle->air_volume_in_dliter_per_bar = ((uint32_t)cnfg->volume_in_dliter * compressibility + 500) / 1000;
+  bottle->safety_air_volume = bottle->air_volume_in_dliter_per_bar * SCBA_BOTTLE_MIN_PRESSURE;
+  
+  scba_pressure_levels_derive(cnfg->fill_pressure, SCBA_BOTTLE_MIN_PRESSURE, &bottle->levels[SCBA_UNIT_BAR]);
+  scba_pressure_levels_derive(cnfg->fill_pressure * BAR_TO_NOMINAL_PSI, SCBA_BOTTLE_MIN_PRESSURE * BAR_TO_PSI_FACTOR, &bottle->levels[SCBA_UNIT_PSI]);
+  
+  memcpy(bottle->bottle_name, cnfg->name, SCBA_BOTTLE_NAME_LEN);
+}
+
+/**
+*
+*/
+static void scba_pressure_levels_derive(uint16_t full_pressure, uint16_t min_pressure, scba_pressure_levels_t *levels)
+{
+  uint16_t quarter = (full_pressure - min_pressure) / 4;
+  
+  levels->full_pressure = full_pressure;
+  levels->max_input_pressure = ((uint32_t)full_pressure * 110) / 100;
+  levels->third_full_pressure = full_pressure - quarter;
+  levels->half_full_pressure = full_pressure - (2 * quarter);
+  levels->third_empty_pressure = full_pressure - (3 * quarter);
+  levels->min_pressure = min_pressure;
+  levels->empty_pressure = ((uint32_t)min_pressure * 80) / 100;
+}
@@ -0,0 +1,75 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_BOTTLES__
+#define __SCBA_BOTTLES__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_MAX_BOTTLE_TYPES 8
+#define SCBA_DEFAULT_BOTTLE_TYPES 6
+#define SCBA_BOTTLE_NAME_LEN 7
+#define SCBA_BOTTLE_MIN_PRESSURE 50 // in bar
+#define SCBA_BOTTLE_MIN_VOLUME 10 // in dliter
+#define SCBA_BOTTLE_MAX_FILL_PRESSURE 450 // in bar
+#define BAR_TO_PSI_FACTOR 14.503773773
+#define BAR_TO_NOMINAL_PSI 15 // 300 bar bottles are rated 4500 psi
+
+#define SCBA_UNIT_BAR 0x00
+#define SCBA_UNIT_PSI 0x01
+#define SCBA_UNITS 0x02
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// one cylinder as sent from the phone and stored on the watch
+typedef struct
+{
+  uint8_t  volume_in_dliter;
+  uint16_t fill_pressure;  // in bar
+  char     name[SCBA_BOTTLE_NAME_LEN];
+}__attribute__((__packed__)) scba_bottle_cnfg_t;
+
+// alarm and input limits of one cylinder in one pressure unit
+typedef struct
+{
+  uint16_t full_pressure;
+  uint16_t max_input_pressure;
+  uint16_t third_full_pressure;
+  uint16_t half_full_pressure;
+  uint16_t third_empty_pressure;
+  uint16_t min_pressure;
+  uint16_t empty_pressure;
+}scba_pressure_levels_t;
+
+// values derived once when the catalog is loaded
+typedef struct
+{
+  uint16_t air_volume_in_dliter_per_bar;
+  uint16_t safety_air_volume;  // air left at SCBA_BOTTLE_MIN_PRESSURE in dliter
+  scba_pressure_levels_t levels[SCBA_UNITS];
+  char     bottle_name[SCBA_BOTTLE_NAME_LEN];
+}scba_bottle_t;
+
+//* ---------- global variables -------- *//
+//                                        //
+//* ------------------------------------ *//
+extern const scba_bottle_cnfg_t scba_default_bottle_catalog[SCBA_DEFAULT_BOTTLE_TYPES];
+extern scba_bottle_t scba_bottle_types[SCBA_MAX_BOTTLE_TYPES];
+extern uint8_t scba_bottle_type_count;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+bool scba_bottle_cnfg_valid(const scba_bottle_cnfg_t *cnfg);
+bool scba_bottles_load(const scba_bottle_cnfg_t *catalog, uint8_t count, uint8_t enabled_mask);
+bool scba_bottle_enabled(uint8_t type);
+bool scba_bottle_unchanged(uint8_t type, const scba_bottle_cnfg_t *catalog, uint8_t count);
+uint8_t scba_bottle_next(uint8_t type);
+uint8_t scba_bottle_prev(uint8_t type);
+
+#endif
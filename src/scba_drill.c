@@ -0,0 +1,92 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Drill mode for training. All team timing runs on a virtual clock that
+//  starts at the real time when the drill begins and runs scale times
+//  faster, so a cylinder is empty within minutes. A scenario changes the
+//  consumption of the drill teams and can add a sudden pressure drop
+//  (leaking cylinder) after some minutes on air.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_drill.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+const uint8_t scba_drill_scales[SCBA_DRILL_SCALES] = {10, 30, 60};
+
+const scba_drill_scenario_t scba_drill_scenarios[SCBA_DRILL_SCENARIOS] = {
+  {"normal",  100,  0,   0},
+  {"heavy",   200,  0,   0},
+  {"leak",    100, 10,  80},
+  {"mayday",  150, 15, 150}
+};
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_drill_start(scba_drill_t *drill, uint8_t scale, uint8_t scenario, time_t now, uint16_t now_ms)
+{
+  drill->active = true;
+  drill->scale = (scale > 0) ? scale : 1;
+  drill->scenario = (scenario < SCBA_DRILL_SCENARIOS) ? scenario : 0;
+  drill->real_start = now;
+  drill->real_start_ms = now_ms;
+}
+
+/**
+* Virtual time of the real time now, the real time without a drill.
+*/
+time_t scba_drill_time(const scba_drill_t *drill, time_t now, uint16_t now_ms)
+{
+  int32_t real_ms = 0;
+
+  if(drill->active == false)
+  {
+    return (now);
+  }
+  // in ms, so the virtual clock does not jump by scale seconds at once
+  real_ms = ((int32_t)(now - drill->real_start) * 1000) + now_ms - drill->real_start_ms;
+  return (drill->real_start + (time_t)(((int64_t)real_ms * drill->scale) / 1000));
+}
+
+/**
+* Real delay of a virtual one, for timers.
+*/
+uint32_t scba_drill_real_ms(const scba_drill_t *drill, uint32_t virtual_ms)
+{
+  return ((drill->active == true) ? (virtual_ms / drill->scale) : virtual_ms);
+}
+
+/**
+* Breathing rate of a drill team for the configured rate.
+*/
+uint16_t scba_drill_rate(const scba_drill_t *drill, uint16_t rate)
+{
+  if(drill->active == false)
+  {
+    return (rate);
+  }
+  return (((uint32_t)rate * scba_drill_scenarios[drill->scenario].rate_percent) / 100);
+}
+
+/**
+* True once a team started at start_time reached the drop of the scenario.
+*/
+bool scba_drill_drop_due(const scba_drill_t *drill, time_t start_time, time_t now)
+{
+  const scba_drill_scenario_t *scenario = &scba_drill_scenarios[drill->scenario];
+
+  return ((drill->active == true) && (scenario->drop_minute > 0) &&
+          ((now - start_time) >= ((time_t)scenario->drop_minute * 60)));
+}
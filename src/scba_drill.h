@@ -0,0 +1,54 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_DRILL__
+#define __SCBA_DRILL__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_DRILL_SCALES 3
+#define SCBA_DRILL_SCENARIOS 4
+#define SCBA_DRILL_NAME_LEN 8
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// pressure profile of the drill teams
+typedef struct
+{
+  char     name[SCBA_DRILL_NAME_LEN];
+  uint8_t  rate_percent;   // of the configured breathing rate
+  uint16_t drop_minute;    // minutes on air until the sudden drop, 0: none
+  uint16_t drop_pressure;  // in bar
+}scba_drill_scenario_t;
+
+typedef struct
+{
+  bool     active;
+  uint8_t  scale;         // virtual seconds per real second
+  uint8_t  scenario;
+  time_t   real_start;    // the virtual clock equals the real one here
+  uint16_t real_start_ms;
+}scba_drill_t;
+
+//* ---------- global variables -------- *//
+//                                        //
+//* ------------------------------------ *//
+extern const uint8_t scba_drill_scales[SCBA_DRILL_SCALES];
+extern const scba_drill_scenario_t scba_drill_scenarios[SCBA_DRILL_SCENARIOS];
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_drill_start(scba_drill_t *drill, uint8_t scale, uint8_t scenario, time_t now, uint16_t now_ms);
+time_t scba_drill_time(const scba_drill_t *drill, time_t now, uint16_t now_ms);
+uint32_t scba_drill_real_ms(const scba_drill_t *drill, uint32_t virtual_ms);
+uint16_t scba_drill_rate(const scba_drill_t *drill, uint16_t rate);
+bool scba_drill_drop_due(const scba_drill_t *drill, time_t start_time, time_t now);
+
+#endif
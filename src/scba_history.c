@@ -0,0 +1,137 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Pressure history of a team for the sparkline of the detail view. The
+//  samples are kept in a fixed buffer of SCBA_HISTORY_SAMPLES. When it is
+//  full, the oldest samples are not overwritten like in a ring, instead
+//  every second sample is dropped and the interval of the periodic
+//  samples doubles. The first sample (start of the team) and the latest
+//  one are always kept, the rest stays evenly spread over the whole
+//  deployment. So a team on air for hours still fits into a few dozen
+//  bytes and its whole curve can be drawn.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_history.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void scba_history_compact(scba_history_t *history);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_history_reset(scba_history_t *history)
+{
+  history->count = 0;
+  history->interval = SCBA_HISTORY_INTERVAL;
+}
+
+/**
+* Adds a periodic sample if the last one is at least the interval old, a
+* forced one (gauge reading) always. A sample of the same minute replaces
+* the last one. Returns true if the history changed.
+*/
+bool scba_history_add(scba_history_t *history, uint16_t minute, uint16_t pressure, bool forced)
+{
+  scba_history_sample_t *last = NULL;
+
+  if(history->count > 0)
+  {
+    last = &history->samples[history->count - 1];
+
+    if((minute < last->minute) || ((forced == false) && ((minute - last->minute) < history->interval)))
+    {
+      return (false);
+    }
+    if(minute == last->minute)
+    {
+      last->pressure = pressure;
+      return (true);
+    }
+  }
+
+  if(history->count == SCBA_HISTORY_SAMPLES)
+  {
+    scba_history_compact(history);
+  }
+  last = &history->samples[history->count];
+  last->minute = minute;
+  last->pressure = pressure;
+  history->count++;
+  return (true);
+}
+
+/**
+* index 0 is the oldest sample.
+*/
+const scba_history_sample_t* scba_history_get(const scba_history_t *history, uint8_t index)
+{
+  if(index >= history->count)
+  {
+    return (NULL);
+  }
+  return (&history->samples[index]);
+}
+
+/**
+* Scales the samples into a width x height box, y grows downwards and
+* 0 bar is at the bottom. Integer only, returns the number of points.
+*/
+uint8_t scba_history_points(const scba_history_t *history, int16_t width, int16_t height, uint16_t max_pressure, scba_history_point_t *points)
+{
+  const scba_history_sample_t *first = scba_history_get(history, 0);
+  const scba_history_sample_t *sample = NULL;
+  int32_t span = 0;
+  uint16_t pressure = 0;
+  uint8_t i = 0;
+
+  if((first == NULL) || (width < 2) || (height < 2) || (max_pressure == 0))
+  {
+    return (0);
+  }
+  span = scba_history_get(history, history->count - 1)->minute - first->minute;
+
+  for(i=0; i<history->count; i++)
+  {
+    sample = scba_history_get(history, i);
+    pressure = (sample->pressure < max_pressure) ? sample->pressure : max_pressure;
+    // a single sample is drawn at the right edge
+    points[i].x = (span > 0) ? (int16_t)(((int32_t)(sample->minute - first->minute) * (width - 1)) / span) : (width - 1);
+    points[i].y = (height - 1) - (int16_t)(((int32_t)pressure * (height - 1)) / max_pressure);
+  }
+  return (history->count);
+}
+
+/**
+* Drops every second sample but the latest one.
+*/
+static void scba_history_compact(scba_history_t *history)
+{
+  uint8_t count = 0;
+  uint8_t i = 0;
+
+  for(i=0; i<history->count; i++)
+  {
+    if(((i % 2) == 0) || ((i + 1) == history->count))
+    {
+      history->samples[count++] = history->samples[i];
+    }
+  }
+  history->count = count;
+
+  if(history->interval < SCBA_HISTORY_MAX_INTERVAL)
+  {
+    history->interval *= 2;
+  }
+}
@@ -0,0 +1,49 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_HISTORY__
+#define __SCBA_HISTORY__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_HISTORY_SAMPLES 16  // per team, even
+#define SCBA_HISTORY_INTERVAL 2  // in minutes, between periodic samples of a new team
+#define SCBA_HISTORY_MAX_INTERVAL 128
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint16_t minute;    // since the start of the team
+  uint16_t pressure;  // in bar
+}__attribute__((__packed__)) scba_history_sample_t;
+
+// samples of one team, the oldest first
+typedef struct
+{
+  scba_history_sample_t samples[SCBA_HISTORY_SAMPLES];
+  uint8_t count;
+  uint8_t interval;  // in minutes, between periodic samples, doubles with every compaction
+}__attribute__((__packed__)) scba_history_t;
+
+typedef struct
+{
+  int16_t x;
+  int16_t y;
+}scba_history_point_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_history_reset(scba_history_t *history);
+bool scba_history_add(scba_history_t *history, uint16_t minute, uint16_t pressure, bool forced);
+const scba_history_sample_t* scba_history_get(const scba_history_t *history, uint8_t index);
+uint8_t scba_history_points(const scba_history_t *history, int16_t width, int16_t height, uint16_t max_pressure, scba_history_point_t *points);
+
+#endif
@@ -0,0 +1,20 @@
+//* --------------------------------------------------- *//
+//  Generated by tools/build_atlas.py - do not edit.     //
+//  Sub-bitmap rectangles inside RESOURCE_ID_SCBA_ICONS  //
+//* --------------------------------------------------- *//
+#ifndef __SCBA_ICONS__
+#define __SCBA_ICONS__
+
+#define ICON_RECT_ACTIVE_SCBA GRect(0,0,10,40)
+#define ICON_RECT_ARROW_UP GRect(0,244,14,14)
+#define ICON_RECT_ARROW_DOWN GRect(0,230,14,14)
+#define ICON_RECT_OK_BTN GRect(0,258,14,14)
+#define ICON_RECT_SMALL_SCBA_FIREFIGHTER GRect(0,210,20,20)
+#define ICON_RECT_SMALL_EXCLAMATION_MARK GRect(0,190,20,20)
+#define ICON_RECT_SMALL_FULL_BOTTLE GRect(0,70,20,30)
+#define ICON_RECT_SMALL_THIRD_FULL_BOTTLE GRect(0,160,20,30)
+#define ICON_RECT_SMALL_HALF_FULL_BOTTLE GRect(0,100,20,30)
+#define ICON_RECT_SMALL_THIRD_EMPTY_BOTTLE GRect(0,130,20,30)
+#define ICON_RECT_SMALL_EMPTY_BOTTLE GRect(0,40,20,30)
+
+#endif
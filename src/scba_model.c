@@ -0,0 +1,179 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Air, pressure and alarm rules of a team without any UI. The functions
+//  only change the team passed in and return what happened, the pressure
+//  unit, the bottle and the time are parameters. main.c applies the
+//  results to the layers, vibrates and stores the team. So a pressure
+//  that is still being entered can be shown without raising alarms, and
+//  the rules run on the host at full speed (tools/model_timeline.c).
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_model.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+// alarm raised per level, SCBA_NOT_STARTED: none
+static const uint8_t scba_model_level_alarms[SCBA_LEVELS] = {
+  SCBA_NOT_STARTED,
+  SCBA_THIRD_FULL_BOTTLE_ALARM,
+  SCBA_HALF_FULL_BOTTLE_ALARM,
+  SCBA_THIRD_EMPTY_BOTTLE_ALARM,
+  SCBA_EMPTY_BOTTLE_ALARM,
+  SCBA_NOT_STARTED
+};
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Takes off the air of every full breath period in seconds at the rate in
+* dliter per minute, the rest of seconds is kept for the next call.
+* Returns true if air was taken off.
+*/
+bool scba_model_breathe(scba_team_t *team, uint16_t *seconds, uint16_t rate)
+{
+  uint16_t step = (rate * SCBA_MODEL_BREATH_PERIOD) / 60;
+  bool breathed = false;
+
+  while(*seconds >= SCBA_MODEL_BREATH_PERIOD)
+  {
+    team->scba_team_bottle_air_volume = (team->scba_team_bottle_air_volume >= step) ? (team->scba_team_bottle_air_volume - step) : 0;
+    *seconds -= SCBA_MODEL_BREATH_PERIOD;
+    breathed = true;
+  }
+  return (breathed);
+}
+
+/**
+* Pressure of the air volume of the team in the given unit.
+*/
+uint16_t scba_model_pressure(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit)
+{
+  if(unit == SCBA_UNIT_PSI)
+  {
+    return ((team->scba_team_bottle_air_volume * BAR_TO_PSI_FACTOR) / bottle->air_volume_in_dliter_per_bar);
+  }
+  return (team->scba_team_bottle_air_volume / bottle->air_volume_in_dliter_per_bar);
+}
+
+/**
+* Air volume of the pressure of the team in the given unit.
+*/
+uint16_t scba_model_air_volume(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit)
+{
+  uint32_t pressure = team->scba_team_bottle_pressure;
+
+  if(unit == SCBA_UNIT_PSI)
+  {
+    pressure = team->scba_team_bottle_pressure / BAR_TO_PSI_FACTOR;
+  }
+  return (pressure * bottle->air_volume_in_dliter_per_bar);
+}
+
+/**
+* Predicts when the team reaches the safety air volume and returns true.
+* A team already below it keeps the time it was first seen there in
+* end_time and false is returned.
+*/
+bool scba_model_end_time(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit, uint16_t rate, time_t now, time_t *end_time)
+{
+  if((team->scba_team_bottle_pressure >= bottle->levels[unit].min_pressure) &&
+     (team->scba_team_bottle_air_volume >= bottle->safety_air_volume) && (rate > 0))
+  {
+    *end_time = now + (60 * ((team->scba_team_bottle_air_volume - bottle->safety_air_volume) / rate));
+    return (true);
+  }
+  if((*end_time == 0) || (*end_time > now))
+  {
+    *end_time = now;
+  }
+  return (false);
+}
+
+/**
+*
+*/
+uint8_t scba_model_level(uint16_t pressure, const scba_pressure_levels_t *levels)
+{
+  if(pressure < levels->empty_pressure)
+  {
+    return (SCBA_LEVEL_MAYDAY);
+  }
+  else if(pressure < levels->min_pressure)
+  {
+    return (SCBA_LEVEL_MIN);
+  }
+  else if(pressure < levels->third_empty_pressure)
+  {
+    return (SCBA_LEVEL_THIRD_EMPTY);
+  }
+  else if(pressure < levels->half_full_pressure)
+  {
+    return (SCBA_LEVEL_HALF_FULL);
+  }
+  else if(pressure < levels->third_full_pressure)
+  {
+    return (SCBA_LEVEL_THIRD_FULL);
+  }
+  return (SCBA_LEVEL_FULL);
+}
+
+/**
+* Raises the alarm of the level the pressure of the team is in, unless it
+* or a later one was acknowledged. The alarm event is returned as long as
+* the alarm is not acknowledged, the mayday event as long as the team is
+* below the empty pressure.
+*/
+uint8_t scba_model_evaluate(scba_team_t *team, const scba_pressure_levels_t *levels)
+{
+  uint8_t level = scba_model_level(team->scba_team_bottle_pressure, levels);
+  uint8_t alarm = scba_model_level_alarms[level];
+
+  if(team->scba_team_status == SCBA_NOT_STARTED)
+  {
+    return (0);
+  }
+  if(level == SCBA_LEVEL_MAYDAY)
+  {
+    return (SCBA_MODEL_EVENT_MAYDAY);
+  }
+  if((alarm != SCBA_NOT_STARTED) && (team->scba_team_status < scba_model_confirmed_status(alarm)))
+  {
+    team->scba_team_status = alarm;
+    return (SCBA_MODEL_EVENT_ALARM);
+  }
+  return (0);
+}
+
+/**
+* Status after the alarm of status was acknowledged.
+*/
+uint8_t scba_model_confirmed_status(uint8_t status)
+{
+  switch(status)
+  {
+    case SCBA_THIRD_FULL_BOTTLE_ALARM:
+      return (SCBA_THIRD_FULL_BOTTLE_ALARM_CONFIRMED);
+
+    case SCBA_HALF_FULL_BOTTLE_ALARM:
+      return (SCBA_HALF_FULL_BOTTLE_ALARM_CONFIRMED);
+
+    case SCBA_THIRD_EMPTY_BOTTLE_ALARM:
+      return (SCBA_THIRD_EMPTY_BOTTLE_ALARM_CONFIRMED);
+
+    case SCBA_EMPTY_BOTTLE_ALARM:
+      return (SCBA_EMPTY_BOTTLE_ALARM_CONFIRMED);
+
+    default:
+      return (status);
+  }
+}
@@ -0,0 +1,71 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_MODEL__
+#define __SCBA_MODEL__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "scba_bottles.h"
+#include "scba_rate.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_NOT_STARTED 0x00
+#define SCBA_FULL_BOTTLE_NO_ALARM 0x01
+#define SCBA_THIRD_FULL_BOTTLE_ALARM 0x02
+#define SCBA_THIRD_FULL_BOTTLE_ALARM_CONFIRMED 0x03
+#define SCBA_HALF_FULL_BOTTLE_ALARM 0x04
+#define SCBA_HALF_FULL_BOTTLE_ALARM_CONFIRMED 0x05
+#define SCBA_THIRD_EMPTY_BOTTLE_ALARM 0x06
+#define SCBA_THIRD_EMPTY_BOTTLE_ALARM_CONFIRMED 0x07
+#define SCBA_MIN_BOTTLE_PRESSURE_ALARM 0x08
+#define SCBA_MIN_BOTTLE_PRESSURE_ALARM_CONFIRMED 0x09
+#define SCBA_EMPTY_BOTTLE_ALARM 0x0A
+#define SCBA_EMPTY_BOTTLE_ALARM_CONFIRMED 0x0B
+
+// pressure range a team is in, worst last
+#define SCBA_LEVEL_FULL 0x00
+#define SCBA_LEVEL_THIRD_FULL 0x01
+#define SCBA_LEVEL_HALF_FULL 0x02
+#define SCBA_LEVEL_THIRD_EMPTY 0x03
+#define SCBA_LEVEL_MIN 0x04     // below the return pressure
+#define SCBA_LEVEL_MAYDAY 0x05  // below the empty pressure
+#define SCBA_LEVELS 0x06
+
+// returned by scba_model_evaluate(), the UI decides how to signal them
+#define SCBA_MODEL_EVENT_ALARM 0x01   // an alarm of the level is not acknowledged yet
+#define SCBA_MODEL_EVENT_MAYDAY 0x02
+
+#define SCBA_MODEL_BREATH_PERIOD 30  // in seconds, the air is taken off in these steps
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint8_t  scba_team_nr;
+  time_t   scba_team_start_time;
+  uint16_t scba_team_bottle_pressure;
+  uint16_t scba_team_bottle_air_volume;
+  uint8_t  scba_team_bottle_type;
+  uint8_t  scba_team_status;
+  uint8_t  scba_team_pressure_psi;
+  scba_rate_estimator_t scba_team_rate;
+  time_t   scba_team_report_time;  // last gauge report, the check interval starts here
+}__attribute__((__packed__)) scba_team_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+bool scba_model_breathe(scba_team_t *team, uint16_t *seconds, uint16_t rate);
+uint16_t scba_model_pressure(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit);
+uint16_t scba_model_air_volume(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit);
+bool scba_model_end_time(const scba_team_t *team, const scba_bottle_t *bottle, uint8_t unit, uint16_t rate, time_t now, time_t *end_time);
+uint8_t scba_model_level(uint16_t pressure, const scba_pressure_levels_t *levels);
+uint8_t scba_model_evaluate(scba_team_t *team, const scba_pressure_levels_t *levels);
+uint8_t scba_model_confirmed_status(uint8_t status);
+
+#endif
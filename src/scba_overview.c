@@ -0,0 +1,125 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Order of the teams on the commander overview. Teams with an alarm that
+//  was not acknowledged come first, then the running teams by predicted
+//  end of their air, the earliest first, then the teams not running.
+//  The order is kept sorted at all times: a team whose key changed is
+//  taken out and inserted again, the others are not touched, so only the
+//  rows between its old and its new position have to move on screen.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_overview.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static bool scba_overview_before(const scba_overview_t *overview, uint8_t a, uint8_t b);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Starts with all teams not running, in slot order.
+*/
+void scba_overview_init(scba_overview_t *overview, uint8_t count)
+{
+  uint8_t i = 0;
+
+  overview->count = (count < SCBA_OVERVIEW_MAX_TEAMS) ? count : SCBA_OVERVIEW_MAX_TEAMS;
+  for(i=0; i<overview->count; i++)
+  {
+    overview->order[i] = i;
+    overview->keys[i].pinned = false;
+    overview->keys[i].end_time = 0;
+  }
+}
+
+/**
+* Sets the key of a team, returns true if the team moved. first and last
+* give the range of positions that changed then.
+*/
+bool scba_overview_update(scba_overview_t *overview, uint8_t team, bool pinned, time_t end_time, uint8_t *first, uint8_t *last)
+{
+  uint8_t from = 0;
+  uint8_t to = 0;
+
+  if((team >= overview->count) ||
+     ((overview->keys[team].pinned == pinned) && (overview->keys[team].end_time == end_time)))
+  {
+    return (false);
+  }
+  overview->keys[team].pinned = pinned;
+  overview->keys[team].end_time = end_time;
+
+  from = scba_overview_position(overview, team);
+  to = from;
+  // only one key changed, the team moves towards one side and the
+  // teams it passes shift by one position
+  while((to > 0) && scba_overview_before(overview, team, overview->order[to-1]))
+  {
+    overview->order[to] = overview->order[to-1];
+    to--;
+  }
+  while(((to+1) < overview->count) && scba_overview_before(overview, overview->order[to+1], team))
+  {
+    overview->order[to] = overview->order[to+1];
+    to++;
+  }
+  overview->order[to] = team;
+
+  if(to == from)
+  {
+    return (false);
+  }
+  *first = (to < from) ? to : from;
+  *last = (to < from) ? from : to;
+  return (true);
+}
+
+/**
+*
+*/
+uint8_t scba_overview_position(const scba_overview_t *overview, uint8_t team)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<overview->count; i++)
+  {
+    if(overview->order[i] == team)
+    {
+      break;
+    }
+  }
+  return (i);
+}
+
+/**
+* Returns true if team a is more urgent than team b.
+*/
+static bool scba_overview_before(const scba_overview_t *overview, uint8_t a, uint8_t b)
+{
+  const scba_overview_key_t *key_a = &overview->keys[a];
+  const scba_overview_key_t *key_b = &overview->keys[b];
+
+  if(key_a->pinned != key_b->pinned)
+  {
+    return (key_a->pinned);
+  }
+  if((key_a->end_time == 0) || (key_b->end_time == 0))
+  {
+    return ((key_a->end_time != 0) || ((key_b->end_time == 0) && (a < b)));
+  }
+  if(key_a->end_time != key_b->end_time)
+  {
+    return (key_a->end_time < key_b->end_time);
+  }
+  return (a < b);
+}
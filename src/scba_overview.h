@@ -0,0 +1,40 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_OVERVIEW__
+#define __SCBA_OVERVIEW__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_OVERVIEW_MAX_TEAMS 8
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  bool   pinned;    // alarm not acknowledged yet
+  time_t end_time;  // predicted end of the air, 0 for teams not running
+}scba_overview_key_t;
+
+// teams ordered by urgency, the position of a team only changes when its key does
+typedef struct
+{
+  uint8_t order[SCBA_OVERVIEW_MAX_TEAMS];            // teams, the most urgent first
+  scba_overview_key_t keys[SCBA_OVERVIEW_MAX_TEAMS]; // by team
+  uint8_t count;
+}scba_overview_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_overview_init(scba_overview_t *overview, uint8_t count);
+bool scba_overview_update(scba_overview_t *overview, uint8_t team, bool pinned, time_t end_time, uint8_t *first, uint8_t *last);
+uint8_t scba_overview_position(const scba_overview_t *overview, uint8_t team);
+
+#endif
@@ -0,0 +1,515 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  QR code encoder for the handover snapshot. It only knows version 3 with
+//  error correction level M (29 x 29 modules, 42 bytes), which is the
+//  largest code the watch can show at 4 pixels per module. Everything
+//  lives in the scba_qr_t of the caller and about 100 bytes of stack, and
+//  the Reed-Solomon remainder is one block of 26 codewords. All eight
+//  masks are scored and the best one is kept, as scanners expect.
+//
+//  scba_qr_decode() reads a code back from its modules for the host tools.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <string.h>
+#include "scba_qr.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_QR_MODE_BYTE 0x04
+#define SCBA_QR_ECC_LEVEL_M 0x00
+#define SCBA_QR_ALIGNMENT 22     // center of the only alignment pattern
+#define SCBA_QR_FORMAT_POLY 0x537
+#define SCBA_QR_FORMAT_MASK 0x5412
+#define SCBA_QR_GF_POLY 0x11D
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static bool scba_qr_get(const uint32_t *rows, uint8_t x, uint8_t y);
+static void scba_qr_set(uint32_t *rows, uint8_t x, uint8_t y, bool dark);
+static void scba_qr_set_function(scba_qr_t *qr, int8_t x, int8_t y, bool dark);
+static void scba_qr_draw_function_patterns(scba_qr_t *qr);
+static void scba_qr_draw_format(scba_qr_t *qr, uint8_t mask);
+static uint16_t scba_qr_format_bits(uint8_t mask);
+static void scba_qr_place(scba_qr_t *qr, uint8_t *codewords, bool read);
+static bool scba_qr_mask_bit(uint8_t mask, uint8_t x, uint8_t y);
+static void scba_qr_apply_mask(scba_qr_t *qr, uint8_t mask);
+static uint16_t scba_qr_penalty(const scba_qr_t *qr);
+static uint16_t scba_qr_line_penalty(const scba_qr_t *qr, bool column);
+static uint8_t scba_qr_multiply(uint8_t x, uint8_t y);
+static void scba_qr_ecc(const uint8_t *data, uint8_t *ecc);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Encodes data in byte mode, returns false if it is too long.
+*/
+bool scba_qr_encode(scba_qr_t *qr, const uint8_t *data, uint8_t length)
+{
+  uint8_t codewords[SCBA_QR_CODEWORDS];
+  uint16_t penalty = 0;
+  uint16_t best_penalty = 0xFFFF;
+  uint8_t mask = 0;
+  uint8_t i = 0;
+
+  if(length > SCBA_QR_MAX_PAYLOAD)
+  {
+    return (false);
+  }
+
+  // mode, length, data, terminator and pad codewords; with the terminator
+  // the data is shifted by half a byte
+  memset(codewords, 0, sizeof(codewords));
+  codewords[0] = (SCBA_QR_MODE_BYTE << 4) | (length >> 4);
+  codewords[1] = (length << 4);
+  for(i=0; i<length; i++)
+  {
+    codewords[1+i] |= data[i] >> 4;
+    codewords[2+i] = data[i] << 4;
+  }
+  for(i=length+2; i<SCBA_QR_DATA_CODEWORDS; i++)
+  {
+    codewords[i] = ((i - length) % 2 == 0) ? 0xEC : 0x11;
+  }
+  scba_qr_ecc(codewords, &codewords[SCBA_QR_DATA_CODEWORDS]);
+
+  memset(qr, 0, sizeof(scba_qr_t));
+  scba_qr_draw_function_patterns(qr);
+  scba_qr_place(qr, codewords, false);
+
+  for(i=0; i<SCBA_QR_MASKS; i++)
+  {
+    scba_qr_apply_mask(qr, i);
+    scba_qr_draw_format(qr, i);
+    penalty = scba_qr_penalty(qr);
+    if(penalty < best_penalty)
+    {
+      best_penalty = penalty;
+      mask = i;
+    }
+    scba_qr_apply_mask(qr, i);
+  }
+  scba_qr_apply_mask(qr, mask);
+  scba_qr_draw_format(qr, mask);
+  qr->mask = mask;
+  return (true);
+}
+
+/**
+* True if the module in column x of row y is dark.
+*/
+bool scba_qr_module(const scba_qr_t *qr, uint8_t x, uint8_t y)
+{
+  return (scba_qr_get(qr->modules, x, y));
+}
+
+#ifdef SCBA_HOST_BUILD
+/**
+* Reads a code of scba_qr_encode() back from its modules only. Returns the
+* length of the data, 0 if the format or the error correction does not
+* match or the data does not fit into size.
+*/
+uint8_t scba_qr_decode(const scba_qr_t *qr, uint8_t *data, uint8_t size)
+{
+  scba_qr_t layout;
+  uint8_t codewords[SCBA_QR_CODEWORDS];
+  uint8_t ecc[SCBA_QR_ECC_CODEWORDS];
+  uint16_t format = 0;
+  uint8_t length = 0;
+  uint8_t mask = 0;
+  uint8_t i = 0;
+
+  for(i=0; i<=5; i++)
+  {
+    format |= scba_qr_get(qr->modules, 8, i) << i;
+  }
+  format |= scba_qr_get(qr->modules, 8, 7) << 6;
+  format |= scba_qr_get(qr->modules, 8, 8) << 7;
+  format |= scba_qr_get(qr->modules, 7, 8) << 8;
+  for(i=9; i<15; i++)
+  {
+    format |= scba_qr_get(qr->modules, 14 - i, 8) << i;
+  }
+  mask = (format ^ SCBA_QR_FORMAT_MASK) >> 10;
+  if(((mask >> 3) != SCBA_QR_ECC_LEVEL_M) || (scba_qr_format_bits(mask & 0x07) != format))
+  {
+    return (0);
+  }
+  mask &= 0x07;
+
+  memset(&layout, 0, sizeof(layout));
+  scba_qr_draw_function_patterns(&layout);
+  memcpy(layout.modules, qr->modules, sizeof(layout.modules));
+  scba_qr_apply_mask(&layout, mask);
+  scba_qr_place(&layout, codewords, true);
+
+  scba_qr_ecc(codewords, ecc);
+  if(memcmp(ecc, &codewords[SCBA_QR_DATA_CODEWORDS], sizeof(ecc)) != 0)
+  {
+    return (0);
+  }
+
+  length = (codewords[0] << 4) | (codewords[1] >> 4);
+  if(((codewords[0] >> 4) != SCBA_QR_MODE_BYTE) || (length > SCBA_QR_MAX_PAYLOAD) || (length > size))
+  {
+    return (0);
+  }
+  for(i=0; i<length; i++)
+  {
+    data[i] = (codewords[1+i] << 4) | (codewords[2+i] >> 4);
+  }
+  return (length);
+}
+#endif // #ifdef SCBA_HOST_BUILD
+
+/**
+*
+*/
+static bool scba_qr_get(const uint32_t *rows, uint8_t x, uint8_t y)
+{
+  return (((rows[y] >> x) & 1) != 0);
+}
+
+/**
+*
+*/
+static void scba_qr_set(uint32_t *rows, uint8_t x, uint8_t y, bool dark)
+{
+  if(dark == true)
+  {
+    rows[y] |= (1UL << x);
+  }
+  else
+  {
+    rows[y] &= ~(1UL << x);
+  }
+}
+
+/**
+* Modules outside of the code are ignored, the finders cross the edges.
+*/
+static void scba_qr_set_function(scba_qr_t *qr, int8_t x, int8_t y, bool dark)
+{
+  if((x >= 0) && (x < SCBA_QR_SIZE) && (y >= 0) && (y < SCBA_QR_SIZE))
+  {
+    scba_qr_set(qr->modules, x, y, dark);
+    qr->function[y] |= (1UL << x);
+  }
+}
+
+/**
+* Timing, finder and alignment patterns, the format modules are reserved.
+*/
+static void scba_qr_draw_function_patterns(scba_qr_t *qr)
+{
+  static const uint8_t finders[3][2] = {{3, 3}, {SCBA_QR_SIZE - 4, 3}, {3, SCBA_QR_SIZE - 4}};
+  int8_t dx = 0;
+  int8_t dy = 0;
+  int8_t distance = 0;
+  uint8_t i = 0;
+
+  for(i=0; i<SCBA_QR_SIZE; i++)
+  {
+    scba_qr_set_function(qr, 6, i, (i % 2) == 0);
+    scba_qr_set_function(qr, i, 6, (i % 2) == 0);
+  }
+
+  // finders with their light separators
+  for(i=0; i<3; i++)
+  {
+    for(dy=-4; dy<=4; dy++)
+    {
+      for(dx=-4; dx<=4; dx++)
+      {
+        distance = (((dx < 0) ? -dx : dx) > ((dy < 0) ? -dy : dy)) ? ((dx < 0) ? -dx : dx) : ((dy < 0) ? -dy : dy);
+        scba_qr_set_function(qr, finders[i][0] + dx, finders[i][1] + dy, (distance != 2) && (distance != 4));
+      }
+    }
+  }
+
+  for(dy=-2; dy<=2; dy++)
+  {
+    for(dx=-2; dx<=2; dx++)
+    {
+      scba_qr_set_function(qr, SCBA_QR_ALIGNMENT + dx, SCBA_QR_ALIGNMENT + dy, (dx == -2) || (dx == 2) || (dy == -2) || (dy == 2) || ((dx == 0) && (dy == 0)));
+    }
+  }
+
+  scba_qr_draw_format(qr, 0);
+}
+
+/**
+* Both copies of the format bits and the dark module.
+*/
+static void scba_qr_draw_format(scba_qr_t *qr, uint8_t mask)
+{
+  uint16_t bits = scba_qr_format_bits(mask);
+  uint8_t i = 0;
+
+  for(i=0; i<=5; i++)
+  {
+    scba_qr_set_function(qr, 8, i, ((bits >> i) & 1) != 0);
+  }
+  scba_qr_set_function(qr, 8, 7, ((bits >> 6) & 1) != 0);
+  scba_qr_set_function(qr, 8, 8, ((bits >> 7) & 1) != 0);
+  scba_qr_set_function(qr, 7, 8, ((bits >> 8) & 1) != 0);
+  for(i=9; i<15; i++)
+  {
+    scba_qr_set_function(qr, 14 - i, 8, ((bits >> i) & 1) != 0);
+  }
+
+  for(i=0; i<8; i++)
+  {
+    scba_qr_set_function(qr, SCBA_QR_SIZE - 1 - i, 8, ((bits >> i) & 1) != 0);
+  }
+  for(i=8; i<15; i++)
+  {
+    scba_qr_set_function(qr, 8, SCBA_QR_SIZE - 15 + i, ((bits >> i) & 1) != 0);
+  }
+  scba_qr_set_function(qr, 8, SCBA_QR_SIZE - 8, true);
+}
+
+/**
+* Level and mask with their BCH code, masked as the standard asks.
+*/
+static uint16_t scba_qr_format_bits(uint8_t mask)
+{
+  uint16_t data = (SCBA_QR_ECC_LEVEL_M << 3) | mask;
+  uint16_t rem = data;
+  uint8_t i = 0;
+
+  for(i=0; i<10; i++)
+  {
+    rem = (rem << 1) ^ ((rem >> 9) * SCBA_QR_FORMAT_POLY);
+  }
+  return (((data << 10) | rem) ^ SCBA_QR_FORMAT_MASK);
+}
+
+/**
+* Walks the data modules in the zigzag order of the standard, from the
+* bottom right in column pairs, and writes the codewords to them or reads
+* them back. The 7 remainder modules stay light.
+*/
+static void scba_qr_place(scba_qr_t *qr, uint8_t *codewords, bool read)
+{
+  uint16_t bit = 0;
+  int8_t right = 0;
+  uint8_t vert = 0;
+  uint8_t x = 0;
+  uint8_t y = 0;
+  uint8_t j = 0;
+
+  if(read == true)
+  {
+    memset(codewords, 0, SCBA_QR_CODEWORDS);
+  }
+
+  for(right=SCBA_QR_SIZE-1; right>=1; right-=2)
+  {
+    if(right == 6)
+    {
+      right = 5;
+    }
+    for(vert=0; vert<SCBA_QR_SIZE; vert++)
+    {
+      for(j=0; j<2; j++)
+      {
+        x = right - j;
+        y = (((right + 1) & 2) == 0) ? (SCBA_QR_SIZE - 1 - vert) : vert;
+        if((scba_qr_get(qr->function, x, y) == true) || (bit >= (SCBA_QR_CODEWORDS * 8)))
+        {
+          continue;
+        }
+        if(read == true)
+        {
+          codewords[bit >> 3] |= scba_qr_get(qr->modules, x, y) << (7 - (bit & 7));
+        }
+        else
+        {
+          scba_qr_set(qr->modules, x, y, ((codewords[bit >> 3] >> (7 - (bit & 7))) & 1) != 0);
+        }
+        bit++;
+      }
+    }
+  }
+}
+
+/**
+*
+*/
+static bool scba_qr_mask_bit(uint8_t mask, uint8_t x, uint8_t y)
+{
+  switch(mask)
+  {
+    case 0:  return (((x + y) % 2) == 0);
+    case 1:  return ((y % 2) == 0);
+    case 2:  return ((x % 3) == 0);
+    case 3:  return (((x + y) % 3) == 0);
+    case 4:  return ((((x / 3) + (y / 2)) % 2) == 0);
+    case 5:  return ((((x * y) % 2) + ((x * y) % 3)) == 0);
+    case 6:  return (((((x * y) % 2) + ((x * y) % 3)) % 2) == 0);
+    default: return (((((x + y) % 2) + ((x * y) % 3)) % 2) == 0);
+  }
+}
+
+/**
+* Flips the data modules, so applying a mask twice removes it.
+*/
+static void scba_qr_apply_mask(scba_qr_t *qr, uint8_t mask)
+{
+  uint8_t x = 0;
+  uint8_t y = 0;
+
+  for(y=0; y<SCBA_QR_SIZE; y++)
+  {
+    for(x=0; x<SCBA_QR_SIZE; x++)
+    {
+      if((scba_qr_get(qr->function, x, y) == false) && (scba_qr_mask_bit(mask, x, y) == true))
+      {
+        qr->modules[y] ^= (1UL << x);
+      }
+    }
+  }
+}
+
+/**
+* Penalty score of the standard: runs, 2 x 2 blocks, finder lookalikes and
+* the balance of dark modules.
+*/
+static uint16_t scba_qr_penalty(const scba_qr_t *qr)
+{
+  const uint16_t total = SCBA_QR_SIZE * SCBA_QR_SIZE;
+  uint16_t penalty = scba_qr_line_penalty(qr, false) + scba_qr_line_penalty(qr, true);
+  uint16_t dark = 0;
+  uint16_t deviation = 0;
+  uint8_t x = 0;
+  uint8_t y = 0;
+  bool color = false;
+
+  for(y=0; y<SCBA_QR_SIZE; y++)
+  {
+    for(x=0; x<SCBA_QR_SIZE; x++)
+    {
+      color = scba_qr_get(qr->modules, x, y);
+      dark += (color == true) ? 1 : 0;
+      if((x < (SCBA_QR_SIZE - 1)) && (y < (SCBA_QR_SIZE - 1)) &&
+         (scba_qr_get(qr->modules, x + 1, y) == color) && (scba_qr_get(qr->modules, x, y + 1) == color) &&
+         (scba_qr_get(qr->modules, x + 1, y + 1) == color))
+      {
+        penalty += 3;
+      }
+    }
+  }
+
+  deviation = (dark * 20 > total * 10) ? (dark * 20 - total * 10) : (total * 10 - dark * 20);
+  penalty += 10 * (((deviation + total - 1) / total) - 1);
+  return (penalty);
+}
+
+/**
+* Runs of five or more and 1:1:3:1:1 patterns with four light modules on
+* one side, in all rows or all columns.
+*/
+static uint16_t scba_qr_line_penalty(const scba_qr_t *qr, bool column)
+{
+  uint16_t penalty = 0;
+  uint16_t window = 0;
+  uint8_t run = 0;
+  uint8_t i = 0;
+  uint8_t j = 0;
+  bool color = false;
+  bool last = false;
+
+  for(i=0; i<SCBA_QR_SIZE; i++)
+  {
+    run = 0;
+    window = 0;
+    for(j=0; j<SCBA_QR_SIZE; j++)
+    {
+      color = (column == true) ? scba_qr_get(qr->modules, i, j) : scba_qr_get(qr->modules, j, i);
+      if((j > 0) && (color == last))
+      {
+        run++;
+      }
+      else
+      {
+        penalty += (run >= 5) ? (run - 2) : 0;
+        run = 1;
+      }
+      last = color;
+
+      window = ((window << 1) | ((color == true) ? 1 : 0)) & 0x07FF;
+      if((j >= 10) && ((window == 0x05D0) || (window == 0x005D)))
+      {
+        penalty += 40;
+      }
+    }
+    penalty += (run >= 5) ? (run - 2) : 0;
+  }
+  return (penalty);
+}
+
+/**
+* Product in GF(256) with the QR polynomial.
+*/
+static uint8_t scba_qr_multiply(uint8_t x, uint8_t y)
+{
+  uint16_t z = 0;
+  int8_t i = 0;
+
+  for(i=7; i>=0; i--)
+  {
+    z = (z << 1) ^ ((z >> 7) * SCBA_QR_GF_POLY);
+    z ^= ((y >> i) & 1) * x;
+  }
+  return (z);
+}
+
+/**
+* Reed-Solomon remainder of the data codewords.
+*/
+static void scba_qr_ecc(const uint8_t *data, uint8_t *ecc)
+{
+  uint8_t divisor[SCBA_QR_ECC_CODEWORDS];
+  uint8_t root = 1;
+  uint8_t factor = 0;
+  uint8_t i = 0;
+  uint8_t j = 0;
+
+  memset(divisor, 0, sizeof(divisor));
+  divisor[SCBA_QR_ECC_CODEWORDS-1] = 1;
+  for(i=0; i<SCBA_QR_ECC_CODEWORDS; i++)
+  {
+    for(j=0; j<SCBA_QR_ECC_CODEWORDS; j++)
+    {
+      divisor[j] = scba_qr_multiply(divisor[j], root);
+      if((j + 1) < SCBA_QR_ECC_CODEWORDS)
+      {
+        divisor[j] ^= divisor[j+1];
+      }
+    }
+    root = scba_qr_multiply(root, 0x02);
+  }
+
+  memset(ecc, 0, SCBA_QR_ECC_CODEWORDS);
+  for(i=0; i<SCBA_QR_DATA_CODEWORDS; i++)
+  {
+    factor = data[i] ^ ecc[0];
+    memmove(ecc, &ecc[1], SCBA_QR_ECC_CODEWORDS - 1);
+    ecc[SCBA_QR_ECC_CODEWORDS-1] = 0;
+    for(j=0; j<SCBA_QR_ECC_CODEWORDS; j++)
+    {
+      ecc[j] ^= scba_qr_multiply(divisor[j], factor);
+    }
+  }
+}
@@ -0,0 +1,41 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_QR__
+#define __SCBA_QR__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// only version 3 with error correction level M, byte mode, one block
+#define SCBA_QR_VERSION 3
+#define SCBA_QR_SIZE 29                // modules per side
+#define SCBA_QR_DATA_CODEWORDS 44
+#define SCBA_QR_ECC_CODEWORDS 26
+#define SCBA_QR_CODEWORDS (SCBA_QR_DATA_CODEWORDS + SCBA_QR_ECC_CODEWORDS)
+#define SCBA_QR_MAX_PAYLOAD 42         // 4 bit mode and 8 bit length come first
+#define SCBA_QR_MASKS 8
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint32_t modules[SCBA_QR_SIZE];   // bit x of row y, set: dark
+  uint32_t function[SCBA_QR_SIZE];  // set: finder, timing, alignment or format module
+  uint8_t  mask;
+}scba_qr_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+bool scba_qr_encode(scba_qr_t *qr, const uint8_t *data, uint8_t length);
+bool scba_qr_module(const scba_qr_t *qr, uint8_t x, uint8_t y);
+#ifdef SCBA_HOST_BUILD
+uint8_t scba_qr_decode(const scba_qr_t *qr, uint8_t *data, uint8_t size);
+#endif // #ifdef SCBA_HOST_BUILD
+
+#endif
@@ -0,0 +1,102 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER                                     
+//                                                                                  
+//  DESCRIPTION: 
+//
+//  Breathing rate estimator of a team. Every pressure reading entered for
+//  a team is compared with the previous one, the air used in between gives
+//  a measured rate which is averaged into the estimate. Only the last
+//  reading and the running average are kept, so each reading costs a
+//  handful of integer operations and 9 bytes per team.
+//
+//  Until SCBA_RATE_FULL_CONFIDENCE intervals were measured, the estimate
+//  is blended with the configured breathing rate.
+//                                                                          
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_rate.h"
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_rate_reset(scba_rate_estimator_t *estimator)
+{
+  estimator->reading_time = 0;
+  estimator->reading_air_volume = 0;
+  estimator->rate = 0;
+  estimator->samples = 0;
+}
+
+/**
+* Adds a gauge reading, returns true if it changed the estimate.
+*/
+bool scba_rate_add_reading(scba_rate_estimator_t *estimator, time_t reading_time, uint16_t air_volume)
+{
+  int32_t interval = reading_time - estimator->reading_time;
+  int32_t measured = 0;
+  uint8_t weight = 0;
+  
+  // first reading or more air than before (bottle changed, wrong input),
+  // start measuring from here
+  if((estimator->reading_time == 0) || (interval < 0) || (air_volume > estimator->reading_air_volume))
+  {
+    estimator->reading_time = reading_time;
+    estimator->reading_air_volume = air_volume;
+    return (false);
+  }
+  // keep the older reference until the interval is long enough
+  if(interval < SCBA_RATE_MIN_INTERVAL)
+  {
+    return (false);
+  }
+  
+  measured = ((int32_t)(estimator->reading_air_volume - air_volume) * 60) / interval;
+  if(measured < SCBA_RATE_MIN)
+  {
+    measured = SCBA_RATE_MIN;
+  }
+  else if(measured > SCBA_RATE_MAX)
+  {
+    measured = SCBA_RATE_MAX;
+  }
+  
+  // running average, the first readings are weighted equally
+  weight = (estimator->samples < SCBA_RATE_AVERAGE_WINDOW) ? (estimator->samples + 1) : SCBA_RATE_AVERAGE_WINDOW;
+  estimator->rate = (int32_t)estimator->rate + ((measured - (int32_t)estimator->rate) / weight);
+  
+  if(estimator->samples < SCBA_RATE_AVERAGE_WINDOW)
+  {
+    estimator->samples++;
+  }
+  estimator->reading_time = reading_time;
+  estimator->reading_air_volume = air_volume;
+  return (true);
+}
+
+/**
+* Returns the rate to predict with: the configured rate without readings,
+* the estimate once SCBA_RATE_FULL_CONFIDENCE intervals were measured and
+* a weighted mix of both in between.
+*/
+uint16_t scba_rate_get(const scba_rate_estimator_t *estimator, uint16_t configured_rate)
+{
+  uint8_t confidence = scba_rate_confidence(estimator);
+  
+  return ((((uint32_t)configured_rate * (SCBA_RATE_FULL_CONFIDENCE - confidence)) + 
+           ((uint32_t)estimator->rate * confidence)) / SCBA_RATE_FULL_CONFIDENCE);
+}
+
+/**
+* Returns 0 (no readings) up to SCBA_RATE_FULL_CONFIDENCE.
+*/
+uint8_t scba_rate_confidence(const scba_rate_estimator_t *estimator)
+{
+  return ((estimator->samples < SCBA_RATE_FULL_CONFIDENCE) ? estimator->samples : SCBA_RATE_FULL_CONFIDENCE);
+}
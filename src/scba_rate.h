@@ -0,0 +1,40 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_RATE__
+#define __SCBA_RATE__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_RATE_MIN_INTERVAL 60 // in s, shorter gauge intervals are too coarse
+#define SCBA_RATE_MIN 100 // in dliter per minute
+#define SCBA_RATE_MAX 1500 // in dliter per minute
+#define SCBA_RATE_AVERAGE_WINDOW 4 // readings
+#define SCBA_RATE_FULL_CONFIDENCE 3 // readings until the estimate replaces the configured rate
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// consumption of one team estimated from its gauge readings
+typedef struct
+{
+  time_t   reading_time;        // time of the reference reading, 0 if none
+  uint16_t reading_air_volume;  // air volume of the reference reading in dliter
+  uint16_t rate;                // estimated consumption in dliter per minute
+  uint8_t  samples;             // measured intervals, saturates at SCBA_RATE_AVERAGE_WINDOW
+}__attribute__((__packed__)) scba_rate_estimator_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_rate_reset(scba_rate_estimator_t *estimator);
+bool scba_rate_add_reading(scba_rate_estimator_t *estimator, time_t reading_time, uint16_t air_volume);
+uint16_t scba_rate_get(const scba_rate_estimator_t *estimator, uint16_t configured_rate);
+uint8_t scba_rate_confidence(const scba_rate_estimator_t *estimator);
+
+#endif
@@ -0,0 +1,118 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Gauge check reminders of the teams. All pending reminders are kept in
+//  one array ordered by due time, so the app only has to wake up for the
+//  first entry instead of checking every team each second. A team has at
+//  most one reminder, setting it again moves the entry.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_reminders.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void scba_reminders_remove_at(scba_reminder_queue_t *queue, uint8_t index);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_reminders_init(scba_reminder_queue_t *queue)
+{
+  queue->count = 0;
+}
+
+/**
+* (Re)schedules the reminder of a team, returns false if the queue is full.
+*/
+bool scba_reminders_set(scba_reminder_queue_t *queue, uint8_t team, time_t due)
+{
+  uint8_t i = 0;
+
+  scba_reminders_cancel(queue, team);
+
+  if(queue->count >= SCBA_REMINDER_SLOTS)
+  {
+    return (false);
+  }
+
+  // insertion from the end, equal due times keep their order
+  for(i=queue->count; (i > 0) && (queue->entries[i-1].due > due); i--)
+  {
+    queue->entries[i] = queue->entries[i-1];
+  }
+  queue->entries[i].due = due;
+  queue->entries[i].team = team;
+  queue->count++;
+  return (true);
+}
+
+/**
+* Returns true if the team had a pending reminder.
+*/
+bool scba_reminders_cancel(scba_reminder_queue_t *queue, uint8_t team)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<queue->count; i++)
+  {
+    if(queue->entries[i].team == team)
+    {
+      scba_reminders_remove_at(queue, i);
+      return (true);
+    }
+  }
+  return (false);
+}
+
+/**
+* Gives the earliest due time, returns false if nothing is pending.
+*/
+bool scba_reminders_next(const scba_reminder_queue_t *queue, time_t *due)
+{
+  if(queue->count == 0)
+  {
+    return (false);
+  }
+  *due = queue->entries[0].due;
+  return (true);
+}
+
+/**
+* Removes the earliest reminder if it is due at now, call it until it
+* returns false to get all due teams.
+*/
+bool scba_reminders_pop_due(scba_reminder_queue_t *queue, time_t now, uint8_t *team)
+{
+  if((queue->count == 0) || (queue->entries[0].due > now))
+  {
+    return (false);
+  }
+  *team = queue->entries[0].team;
+  scba_reminders_remove_at(queue, 0);
+  return (true);
+}
+
+/**
+*
+*/
+static void scba_reminders_remove_at(scba_reminder_queue_t *queue, uint8_t index)
+{
+  uint8_t i = 0;
+
+  for(i=index; (i+1) < queue->count; i++)
+  {
+    queue->entries[i] = queue->entries[i+1];
+  }
+  queue->count--;
+}
@@ -0,0 +1,41 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_REMINDERS__
+#define __SCBA_REMINDERS__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_REMINDER_SLOTS 8 // teams with a pending reminder at the same time
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  time_t  due;
+  uint8_t team;
+}scba_reminder_t;
+
+// pending reminders ordered by due time, the earliest first
+typedef struct
+{
+  scba_reminder_t entries[SCBA_REMINDER_SLOTS];
+  uint8_t count;
+}scba_reminder_queue_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_reminders_init(scba_reminder_queue_t *queue);
+bool scba_reminders_set(scba_reminder_queue_t *queue, uint8_t team, time_t due);
+bool scba_reminders_cancel(scba_reminder_queue_t *queue, uint8_t team);
+bool scba_reminders_next(const scba_reminder_queue_t *queue, time_t *due);
+bool scba_reminders_pop_due(scba_reminder_queue_t *queue, time_t now, uint8_t *team);
+
+#endif
@@ -0,0 +1,237 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Crew names of the teams, sent by the phone for every team number. The
+//  names are kept once in a string pool, a crew only holds the one byte
+//  references of its names, so the same firefighter in several teams or
+//  sent again costs no pool space. When the pool is full the names no
+//  crew refers to any more are dropped and the pool is packed.
+//
+//  Message of SCBA_MSG_KEY_ROSTER: the team number, then up to
+//  SCBA_ROSTER_CREW names, each ended by 0. A team number alone clears
+//  its crew.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <string.h>
+#include "scba_roster.h"
+#include "mini-printf.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static uint8_t scba_roster_find(const scba_roster_t *roster, const char *name, uint8_t length);
+static void scba_roster_pack(scba_roster_t *roster);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_roster_reset(scba_roster_t *roster)
+{
+  memset(roster, 0, sizeof(scba_roster_t));
+}
+
+/**
+* Checks a roster read from the storage, every reference has to point to
+* the start of a name.
+*/
+bool scba_roster_valid(const scba_roster_t *roster)
+{
+  uint8_t team = 0;
+  uint8_t i = 0;
+  uint8_t name = 0;
+
+  if((roster->used > SCBA_ROSTER_POOL_SIZE) || ((roster->used > 0) && (roster->pool[roster->used-1] != '\0')))
+  {
+    return (false);
+  }
+  for(team=0; team<SCBA_ROSTER_TEAMS; team++)
+  {
+    for(i=0; i<SCBA_ROSTER_CREW; i++)
+    {
+      name = roster->crew[team][i];
+      if((name != SCBA_ROSTER_NONE) && ((name > roster->used) || ((name > 1) && (roster->pool[name-2] != '\0'))))
+      {
+        return (false);
+      }
+    }
+  }
+  return (true);
+}
+
+/**
+* Returns the reference of the name, taken into the pool if it is new.
+* Longer names are cut, SCBA_ROSTER_NONE if the pool is full.
+*/
+uint8_t scba_roster_intern(scba_roster_t *roster, const char *name, uint8_t length)
+{
+  uint8_t found = 0;
+
+  if(length >= SCBA_ROSTER_NAME_LEN)
+  {
+    length = SCBA_ROSTER_NAME_LEN - 1;
+  }
+  if(length == 0)
+  {
+    return (SCBA_ROSTER_NONE);
+  }
+  found = scba_roster_find(roster, name, length);
+  if(found != SCBA_ROSTER_NONE)
+  {
+    return (found);
+  }
+  if((roster->used + length + 1) > SCBA_ROSTER_POOL_SIZE)
+  {
+    scba_roster_pack(roster);
+    if((roster->used + length + 1) > SCBA_ROSTER_POOL_SIZE)
+    {
+      return (SCBA_ROSTER_NONE);
+    }
+  }
+  found = roster->used + 1;
+  memcpy(&roster->pool[roster->used], name, length);
+  roster->pool[roster->used + length] = '\0';
+  roster->used += length + 1;
+  return (found);
+}
+
+/**
+* Takes the names of a roster message for a team number, see above.
+* Returns false if the team number is not valid or not all names fit.
+*/
+bool scba_roster_set_crew(scba_roster_t *roster, uint8_t team_nr, const uint8_t *names, uint8_t length)
+{
+  uint8_t *crew = NULL;
+  uint8_t start = 0;
+  uint8_t end = 0;
+  uint8_t count = 0;
+  bool complete = true;
+
+  if((team_nr == 0) || (team_nr > SCBA_ROSTER_TEAMS))
+  {
+    return (false);
+  }
+  crew = roster->crew[team_nr-1];
+  // the old names of the team may be packed away for the new ones
+  memset(crew, SCBA_ROSTER_NONE, SCBA_ROSTER_CREW);
+  while((start < length) && (count < SCBA_ROSTER_CREW))
+  {
+    for(end=start; (end < length) && (names[end] != '\0'); end++)
+    {
+    }
+    crew[count] = scba_roster_intern(roster, (const char *)&names[start], end - start);
+    if(crew[count] != SCBA_ROSTER_NONE)
+    {
+      count++;
+    }
+    else if(end > start)
+    {
+      complete = false;
+    }
+    start = end + 1;
+  }
+  return ((complete == true) && (start >= length));
+}
+
+/**
+* Name of a reference, "" for SCBA_ROSTER_NONE.
+*/
+const char* scba_roster_name(const scba_roster_t *roster, uint8_t name)
+{
+  if((name == SCBA_ROSTER_NONE) || (name > roster->used))
+  {
+    return ("");
+  }
+  return (&roster->pool[name-1]);
+}
+
+/**
+* Crew of a team number joined by separator, returns the length.
+*/
+int scba_roster_format(const scba_roster_t *roster, uint8_t team_nr, char *buffer, size_t buffer_size, char *separator)
+{
+  int length = 0;
+  uint8_t i = 0;
+
+  buffer[0] = '\0';
+  if((team_nr == 0) || (team_nr > SCBA_ROSTER_TEAMS))
+  {
+    return (0);
+  }
+  for(i=0; (i<SCBA_ROSTER_CREW) && (length < (int)buffer_size); i++)
+  {
+    if(roster->crew[team_nr-1][i] != SCBA_ROSTER_NONE)
+    {
+      length += mini_snprintf(&buffer[length], buffer_size - length, "%s%s", (length > 0) ? separator : "",
+                              scba_roster_name(roster, roster->crew[team_nr-1][i]));
+    }
+  }
+  return (length);
+}
+
+/**
+*
+*/
+static uint8_t scba_roster_find(const scba_roster_t *roster, const char *name, uint8_t length)
+{
+  uint8_t offset = 0;
+  uint8_t size = 0;
+
+  while(offset < roster->used)
+  {
+    size = strlen(&roster->pool[offset]);
+    if((size == length) && (memcmp(&roster->pool[offset], name, length) == 0))
+    {
+      return (offset + 1);
+    }
+    offset += size + 1;
+  }
+  return (SCBA_ROSTER_NONE);
+}
+
+/**
+* Drops the names without a crew and moves the others to the front, the
+* references are moved along.
+*/
+static void scba_roster_pack(scba_roster_t *roster)
+{
+  uint8_t offset = 0;
+  uint8_t packed = 0;
+  uint8_t size = 0;
+  uint8_t team = 0;
+  uint8_t i = 0;
+  bool referenced = false;
+
+  while(offset < roster->used)
+  {
+    size = strlen(&roster->pool[offset]) + 1;
+    referenced = false;
+    for(team=0; team<SCBA_ROSTER_TEAMS; team++)
+    {
+      for(i=0; i<SCBA_ROSTER_CREW; i++)
+      {
+        if(roster->crew[team][i] == (offset + 1))
+        {
+          roster->crew[team][i] = packed + 1;
+          referenced = true;
+        }
+      }
+    }
+    if(referenced == true)
+    {
+      memmove(&roster->pool[packed], &roster->pool[offset], size);
+      packed += size;
+    }
+    offset += size;
+  }
+  roster->used = packed;
+}
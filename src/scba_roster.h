@@ -0,0 +1,42 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_ROSTER__
+#define __SCBA_ROSTER__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_ROSTER_POOL_SIZE 200  // the record stays below the 256 bytes of a persist key
+#define SCBA_ROSTER_NAME_LEN 12    // with the ending 0
+#define SCBA_ROSTER_CREW 3         // names per team
+#define SCBA_ROSTER_TEAMS 10       // team numbers 1 to SCBA_TEAM_HIGHEST_NR
+#define SCBA_ROSTER_NONE 0
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// stored as a whole, 231 bytes. A name is referenced by its offset in the
+// pool + 1, every name is in the pool only once.
+typedef struct
+{
+  char    pool[SCBA_ROSTER_POOL_SIZE];                  // names one after the other, each ended by 0
+  uint8_t used;                                         // bytes of the pool taken
+  uint8_t crew[SCBA_ROSTER_TEAMS][SCBA_ROSTER_CREW];    // by team number - 1
+}__attribute__((__packed__)) scba_roster_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_roster_reset(scba_roster_t *roster);
+bool scba_roster_valid(const scba_roster_t *roster);
+uint8_t scba_roster_intern(scba_roster_t *roster, const char *name, uint8_t length);
+bool scba_roster_set_crew(scba_roster_t *roster, uint8_t team_nr, const uint8_t *names, uint8_t length);
+const char* scba_roster_name(const scba_roster_t *roster, uint8_t name);
+int scba_roster_format(const scba_roster_t *roster, uint8_t team_nr, char *buffer, size_t buffer_size, char *separator);
+
+#endif
@@ -0,0 +1,311 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Groups the running teams by the sector they entered through. Every
+//  sector keeps an aggregate of its members: the number of teams, the
+//  worst pressure level and the earliest predicted end of the air.
+//
+//  The aggregates are kept up to date with every change of a single team,
+//  nothing is scanned by the tick. A team that gets worse or joins only
+//  compares itself with the aggregate. Only when the team that held the
+//  worst level or the earliest end gets better or leaves, the remaining
+//  members of that one sector are looked at again.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_sector.h"
+#include "mini-printf.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+// by SCBA_LEVEL_* of scba_model.h
+static char* const scba_sector_level_names[] = {
+  "full", "1/3 full", "1/2 full", "1/3 empty", "return", "MAYDAY"
+};
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void scba_sector_leave(scba_sectors_t *sectors, uint8_t team);
+static void scba_sector_join(scba_sectors_t *sectors, uint8_t team);
+static void scba_sector_rescan(scba_sectors_t *sectors, uint8_t sector);
+static void scba_sector_take(scba_sector_aggregate_t *aggregate, const scba_sector_member_t *member);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Starts with no team in any sector.
+*/
+void scba_sector_init(scba_sectors_t *sectors, uint8_t count)
+{
+  uint8_t i = 0;
+
+  sectors->count = (count < SCBA_SECTOR_MAX_TEAMS) ? count : SCBA_SECTOR_MAX_TEAMS;
+  for(i=0; i<SCBA_SECTOR_MAX_TEAMS; i++)
+  {
+    sectors->teams[i].sector = SCBA_SECTOR_NONE;
+    sectors->teams[i].level = 0;
+    sectors->teams[i].end_time = 0;
+  }
+  for(i=0; i<SCBA_SECTORS; i++)
+  {
+    sectors->sectors[i].members = 0;
+    sectors->sectors[i].count = 0;
+    sectors->sectors[i].worst_level = 0;
+    sectors->sectors[i].end_time = 0;
+  }
+}
+
+/**
+* Takes the sector, level and predicted end of a team, a team that is not
+* running passes end_time 0. Returns the sectors whose aggregate changed,
+* bit n for sector n + 1.
+*/
+uint8_t scba_sector_update(scba_sectors_t *sectors, uint8_t team, uint8_t sector, uint8_t level, time_t end_time)
+{
+  scba_sector_member_t *member = NULL;
+  scba_sector_aggregate_t *aggregate = NULL;
+  scba_sector_aggregate_t before[SCBA_SECTORS];
+  uint8_t changed = 0;
+  uint8_t i = 0;
+  bool rescan = false;
+
+  if((team >= sectors->count) || (sector > SCBA_SECTORS))
+  {
+    return (0);
+  }
+  if(end_time == 0)
+  {
+    sector = SCBA_SECTOR_NONE;
+  }
+  member = &sectors->teams[team];
+  if((member->sector == sector) && (member->level == level) && (member->end_time == end_time))
+  {
+    return (0);
+  }
+
+  for(i=0; i<SCBA_SECTORS; i++)
+  {
+    before[i] = sectors->sectors[i];
+  }
+  if((sector != SCBA_SECTOR_NONE) && (member->sector == sector))
+  {
+    // stays in its sector, getting worse needs no scan
+    aggregate = &sectors->sectors[sector-1];
+    rescan = (((member->level == aggregate->worst_level) && (level < member->level)) ||
+              ((member->end_time == aggregate->end_time) && (end_time > member->end_time)));
+    member->level = level;
+    member->end_time = end_time;
+    if(rescan == true)
+    {
+      scba_sector_rescan(sectors, sector);
+    }
+    else
+    {
+      scba_sector_take(aggregate, member);
+    }
+  }
+  else
+  {
+    scba_sector_leave(sectors, team);
+    member->sector = sector;
+    member->level = level;
+    member->end_time = end_time;
+    scba_sector_join(sectors, team);
+  }
+
+  for(i=0; i<SCBA_SECTORS; i++)
+  {
+    if((before[i].count != sectors->sectors[i].count) || (before[i].worst_level != sectors->sectors[i].worst_level) ||
+       (before[i].end_time != sectors->sectors[i].end_time))
+    {
+      changed |= (1 << i);
+    }
+  }
+  return (changed);
+}
+
+/**
+* Returns true if any running team has a sector.
+*/
+bool scba_sector_used(const scba_sectors_t *sectors)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<SCBA_SECTORS; i++)
+  {
+    if(sectors->sectors[i].count > 0)
+    {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+/**
+* Collapsed sectors after the next press, bit n for sector n + 1: all open,
+* all collapsed, then one sector after the other open alone.
+*/
+uint8_t scba_sector_next_view(const scba_sectors_t *sectors, uint8_t collapsed)
+{
+  uint8_t used = 0;
+  uint8_t open = 0;
+  uint8_t i = 0;
+
+  for(i=0; i<SCBA_SECTORS; i++)
+  {
+    if(sectors->sectors[i].count > 0)
+    {
+      used |= (1 << i);
+    }
+  }
+  if((used == 0) || ((collapsed & used) == 0))
+  {
+    return (used);
+  }
+  open = used & ~collapsed;
+  for(i=0; (open != 0) && ((open & (1 << i)) == 0); i++)
+  {
+  }
+  // the sector after the open one, the first one if all were collapsed
+  for(i=(open != 0) ? (i + 1) : 0; i<SCBA_SECTORS; i++)
+  {
+    if((used & (1 << i)) != 0)
+    {
+      return (used & ~(1 << i));
+    }
+  }
+  return (0);
+}
+
+/**
+* Rows of the overview from top to bottom: every sector with members, its
+* teams in the order of urgency below unless it is collapsed, then the
+* teams without a sector. Sectors are SCBA_SECTOR_ITEM | (sector - 1).
+* Returns the number of items.
+*/
+uint8_t scba_sector_layout(const scba_sectors_t *sectors, const uint8_t *order, uint8_t collapsed, uint8_t *items)
+{
+  uint8_t count = 0;
+  uint8_t sector = 0;
+  uint8_t i = 0;
+
+  for(sector=1; sector<=SCBA_SECTORS; sector++)
+  {
+    if(sectors->sectors[sector-1].count == 0)
+    {
+      continue;
+    }
+    items[count++] = SCBA_SECTOR_ITEM | (sector - 1);
+    for(i=0; ((collapsed & (1 << (sector - 1))) == 0) && (i < sectors->count); i++)
+    {
+      if(sectors->teams[order[i]].sector == sector)
+      {
+        items[count++] = order[i];
+      }
+    }
+  }
+  for(i=0; i<sectors->count; i++)
+  {
+    if(sectors->teams[order[i]].sector == SCBA_SECTOR_NONE)
+    {
+      items[count++] = order[i];
+    }
+  }
+  return (count);
+}
+
+/**
+* Aggregate row of a sector, "-A 2x 12 min 1/2 full", + when collapsed.
+*/
+int scba_sector_format(const scba_sectors_t *sectors, uint8_t sector, bool collapsed, time_t now, char *buffer, size_t buffer_size)
+{
+  const scba_sector_aggregate_t *aggregate = &sectors->sectors[sector-1];
+  uint8_t level = (aggregate->worst_level <= 5) ? aggregate->worst_level : 5;
+
+  return (mini_snprintf(buffer, buffer_size, "%c%c %dx %d min %s", (collapsed == true) ? '+' : '-', 'A' + sector - 1,
+                        aggregate->count, (int)((aggregate->end_time > now) ? ((aggregate->end_time - now) / 60) : 0),
+                        scba_sector_level_names[level]));
+}
+
+/**
+* Takes the team out of its sector, the aggregate is only scanned again if
+* the team held its worst level or its earliest end.
+*/
+static void scba_sector_leave(scba_sectors_t *sectors, uint8_t team)
+{
+  const scba_sector_member_t *member = &sectors->teams[team];
+  scba_sector_aggregate_t *aggregate = NULL;
+
+  if(member->sector == SCBA_SECTOR_NONE)
+  {
+    return;
+  }
+  aggregate = &sectors->sectors[member->sector-1];
+  aggregate->members &= ~(1 << team);
+  aggregate->count--;
+  if((member->level == aggregate->worst_level) || (member->end_time == aggregate->end_time))
+  {
+    scba_sector_rescan(sectors, member->sector);
+  }
+}
+
+/**
+*
+*/
+static void scba_sector_join(scba_sectors_t *sectors, uint8_t team)
+{
+  const scba_sector_member_t *member = &sectors->teams[team];
+  scba_sector_aggregate_t *aggregate = NULL;
+
+  if(member->sector == SCBA_SECTOR_NONE)
+  {
+    return;
+  }
+  aggregate = &sectors->sectors[member->sector-1];
+  aggregate->members |= (1 << team);
+  aggregate->count++;
+  scba_sector_take(aggregate, member);
+}
+
+/**
+* Worst level and earliest end over the members of one sector.
+*/
+static void scba_sector_rescan(scba_sectors_t *sectors, uint8_t sector)
+{
+  scba_sector_aggregate_t *aggregate = &sectors->sectors[sector-1];
+  uint8_t i = 0;
+
+  aggregate->worst_level = 0;
+  aggregate->end_time = 0;
+  for(i=0; i<sectors->count; i++)
+  {
+    if((aggregate->members & (1 << i)) != 0)
+    {
+      scba_sector_take(aggregate, &sectors->teams[i]);
+    }
+  }
+}
+
+/**
+*
+*/
+static void scba_sector_take(scba_sector_aggregate_t *aggregate, const scba_sector_member_t *member)
+{
+  if(member->level > aggregate->worst_level)
+  {
+    aggregate->worst_level = member->level;
+  }
+  if((aggregate->end_time == 0) || (member->end_time < aggregate->end_time))
+  {
+    aggregate->end_time = member->end_time;
+  }
+}
@@ -0,0 +1,56 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_SECTOR__
+#define __SCBA_SECTOR__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_SECTOR_NONE 0
+#define SCBA_SECTORS 4            // sectors A to D, numbered from 1
+#define SCBA_SECTOR_MAX_TEAMS 8
+#define SCBA_SECTOR_ITEM 0x80     // layout item of a sector row, the others are teams
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// what a team adds to its sector, only running teams are members
+typedef struct
+{
+  uint8_t sector;
+  uint8_t level;     // SCBA_LEVEL_* of scba_model.h
+  time_t  end_time;  // predicted end of the air, 0 for teams not running
+}scba_sector_member_t;
+
+typedef struct
+{
+  uint8_t members;     // bit n set: team n is in the sector
+  uint8_t count;
+  uint8_t worst_level;
+  time_t  end_time;    // earliest predicted end of the members, 0 without any
+}scba_sector_aggregate_t;
+
+typedef struct
+{
+  scba_sector_member_t teams[SCBA_SECTOR_MAX_TEAMS];
+  scba_sector_aggregate_t sectors[SCBA_SECTORS];  // by sector - 1
+  uint8_t count;
+}scba_sectors_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_sector_init(scba_sectors_t *sectors, uint8_t count);
+uint8_t scba_sector_update(scba_sectors_t *sectors, uint8_t team, uint8_t sector, uint8_t level, time_t end_time);
+bool scba_sector_used(const scba_sectors_t *sectors);
+uint8_t scba_sector_next_view(const scba_sectors_t *sectors, uint8_t collapsed);
+uint8_t scba_sector_layout(const scba_sectors_t *sectors, const uint8_t *order, uint8_t collapsed, uint8_t *items);
+int scba_sector_format(const scba_sectors_t *sectors, uint8_t sector, bool collapsed, time_t now, char *buffer, size_t buffer_size);
+
+#endif
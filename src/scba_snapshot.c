@@ -0,0 +1,142 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Binary snapshot of the running teams for the handover QR code. All
+//  values are big endian:
+//
+//    header  version (1), snapshot time in seconds since 1970 (4)
+//    team    slot << 4 | team nr (1), bottle type << 4 | status (1),
+//            start time (3), last gauge report (3), both in seconds
+//            before the snapshot time, air volume in dliter (2),
+//            pressure in bar (2)
+//
+//  The number of teams follows from the length. Times more than
+//  SCBA_SNAPSHOT_MAX_AGE seconds before the snapshot are cut.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_snapshot.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static uint8_t* scba_snapshot_put(uint8_t *buffer, uint32_t value, uint8_t bytes);
+static uint32_t scba_snapshot_get(const uint8_t **buffer, uint8_t bytes);
+static uint32_t scba_snapshot_age(time_t now, time_t then);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Returns the length of the snapshot, 0 if it does not fit into the buffer.
+*/
+uint8_t scba_snapshot_encode(const scba_snapshot_t *snapshot, uint8_t *buffer, uint8_t buffer_size)
+{
+  const scba_snapshot_team_t *team = NULL;
+  uint8_t *pos = buffer;
+  uint8_t i = 0;
+
+  if((snapshot->count > SCBA_SNAPSHOT_TEAMS) ||
+     (buffer_size < (SCBA_SNAPSHOT_HEADER_SIZE + (snapshot->count * SCBA_SNAPSHOT_TEAM_SIZE))))
+  {
+    return (0);
+  }
+
+  pos = scba_snapshot_put(pos, SCBA_SNAPSHOT_VERSION, 1);
+  pos = scba_snapshot_put(pos, (uint32_t)snapshot->time, 4);
+
+  for(i=0; i<snapshot->count; i++)
+  {
+    team = &snapshot->teams[i];
+    pos = scba_snapshot_put(pos, ((team->slot & 0x0F) << 4) | (team->team_nr & 0x0F), 1);
+    pos = scba_snapshot_put(pos, ((team->bottle_type & 0x0F) << 4) | (team->status & 0x0F), 1);
+    pos = scba_snapshot_put(pos, scba_snapshot_age(snapshot->time, team->start_time), 3);
+    pos = scba_snapshot_put(pos, scba_snapshot_age(snapshot->time, team->report_time), 3);
+    pos = scba_snapshot_put(pos, team->air_volume, 2);
+    pos = scba_snapshot_put(pos, team->pressure, 2);
+  }
+  return (pos - buffer);
+}
+
+/**
+*
+*/
+bool scba_snapshot_decode(const uint8_t *buffer, uint8_t length, scba_snapshot_t *snapshot)
+{
+  scba_snapshot_team_t *team = NULL;
+  const uint8_t *pos = buffer;
+  uint8_t value = 0;
+  uint8_t i = 0;
+
+  if((length < SCBA_SNAPSHOT_HEADER_SIZE) || (((length - SCBA_SNAPSHOT_HEADER_SIZE) % SCBA_SNAPSHOT_TEAM_SIZE) != 0) ||
+     (((length - SCBA_SNAPSHOT_HEADER_SIZE) / SCBA_SNAPSHOT_TEAM_SIZE) > SCBA_SNAPSHOT_TEAMS) ||
+     (scba_snapshot_get(&pos, 1) != SCBA_SNAPSHOT_VERSION))
+  {
+    return (false);
+  }
+
+  snapshot->time = (time_t)scba_snapshot_get(&pos, 4);
+  snapshot->count = (length - SCBA_SNAPSHOT_HEADER_SIZE) / SCBA_SNAPSHOT_TEAM_SIZE;
+
+  for(i=0; i<snapshot->count; i++)
+  {
+    team = &snapshot->teams[i];
+    value = scba_snapshot_get(&pos, 1);
+    team->slot = value >> 4;
+    team->team_nr = value & 0x0F;
+    value = scba_snapshot_get(&pos, 1);
+    team->bottle_type = value >> 4;
+    team->status = value & 0x0F;
+    team->start_time = snapshot->time - (time_t)scba_snapshot_get(&pos, 3);
+    team->report_time = snapshot->time - (time_t)scba_snapshot_get(&pos, 3);
+    team->air_volume = scba_snapshot_get(&pos, 2);
+    team->pressure = scba_snapshot_get(&pos, 2);
+  }
+  return (true);
+}
+
+/**
+*
+*/
+static uint8_t* scba_snapshot_put(uint8_t *buffer, uint32_t value, uint8_t bytes)
+{
+  while(bytes > 0)
+  {
+    bytes--;
+    *buffer++ = (value >> (8 * bytes)) & 0xFF;
+  }
+  return (buffer);
+}
+
+/**
+*
+*/
+static uint32_t scba_snapshot_get(const uint8_t **buffer, uint8_t bytes)
+{
+  uint32_t value = 0;
+
+  while(bytes > 0)
+  {
+    value = (value << 8) | *(*buffer)++;
+    bytes--;
+  }
+  return (value);
+}
+
+/**
+*
+*/
+static uint32_t scba_snapshot_age(time_t now, time_t then)
+{
+  if(then >= now)
+  {
+    return (0);
+  }
+  return (((now - then) > SCBA_SNAPSHOT_MAX_AGE) ? SCBA_SNAPSHOT_MAX_AGE : (uint32_t)(now - then));
+}
@@ -0,0 +1,50 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_SNAPSHOT__
+#define __SCBA_SNAPSHOT__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_SNAPSHOT_VERSION 1
+#define SCBA_SNAPSHOT_TEAMS 3
+#define SCBA_SNAPSHOT_HEADER_SIZE 5
+#define SCBA_SNAPSHOT_TEAM_SIZE 12
+#define SCBA_SNAPSHOT_MAX_SIZE (SCBA_SNAPSHOT_HEADER_SIZE + (SCBA_SNAPSHOT_TEAMS * SCBA_SNAPSHOT_TEAM_SIZE))
+#define SCBA_SNAPSHOT_MAX_AGE 0xFFFFFF  // in seconds, older times are cut to this
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// one running team as handed over
+typedef struct
+{
+  uint8_t  slot;         // team row on the watch
+  uint8_t  team_nr;
+  uint8_t  bottle_type;  // index into the bottle catalog of the watch
+  uint8_t  status;       // SCBA_* alarm state of scba_model.h
+  time_t   start_time;
+  time_t   report_time;  // last gauge report
+  uint16_t air_volume;   // in dliter at the snapshot time
+  uint16_t pressure;     // in bar at the snapshot time
+}scba_snapshot_team_t;
+
+typedef struct
+{
+  time_t  time;
+  uint8_t count;
+  scba_snapshot_team_t teams[SCBA_SNAPSHOT_TEAMS];
+}scba_snapshot_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+uint8_t scba_snapshot_encode(const scba_snapshot_t *snapshot, uint8_t *buffer, uint8_t buffer_size);
+bool scba_snapshot_decode(const uint8_t *buffer, uint8_t length, scba_snapshot_t *snapshot);
+
+#endif
@@ -0,0 +1,181 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER                                     
+//                                                                                  
+//  DESCRIPTION: 
+//
+//  State/transition table of the user interface. Every button press is
+//  looked up here by the current screen, the button and the state of the
+//  active team. The matching row names the action main.c executes and the
+//  screen shown afterwards. Rows are matched top down, so guarded rows
+//  have to come before the catch-all row of the same screen and button.
+//                                                                          
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_states.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+const scba_transition_t scba_transitions[] = {
+  // team overview before any team was loaded
+  {SCBA_START_SCREEN,                CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_PREV_TEAM,             SCBA_START_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_NEXT_TEAM,             SCBA_START_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_SELECT,      SCBA_GUARD_ALARM_PENDING, SCBA_ACTION_ACK_ALARM,             SCBA_START_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_SELECT,      SCBA_GUARD_NOT_STARTED,   SCBA_ACTION_OPEN_CNFG,             SCBA_CNFG_SCREEN_NR},
+  {SCBA_START_SCREEN,                CLICK_SELECT,      SCBA_GUARD_STARTED,       SCBA_ACTION_OPEN_PRESSURE_UPDATE,  SCBA_UPDATE_PRESSURE},
+  {SCBA_START_SCREEN,                CLICK_LONG_SELECT, SCBA_GUARD_DRILL_IDLE,    SCBA_ACTION_ASK_END_DRILL,         SCBA_END_DRILL},
+  {SCBA_START_SCREEN,                CLICK_LONG_SELECT, SCBA_GUARD_ALL_IDLE,      SCBA_ACTION_OPEN_DRILL_SETUP,      SCBA_DRILL_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_LONG_SELECT, SCBA_GUARD_ALWAYS,        SCBA_ACTION_ASK_STOP,              SCBA_STOP_MONITORING},
+  {SCBA_START_SCREEN,                CLICK_LONG_DOWN,   SCBA_GUARD_ALWAYS,        SCBA_ACTION_OPEN_OVERVIEW,         SCBA_OVERVIEW_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_LONG_UP,     SCBA_GUARD_NOT_STARTED,   SCBA_ACTION_FAST_START,            SCBA_INFO_SCREEN},
+  {SCBA_START_SCREEN,                CLICK_LONG_UP,     SCBA_GUARD_STARTED,       SCBA_ACTION_OPEN_DETAIL,           SCBA_DETAIL_SCREEN},
+  // team overview
+  {SCBA_INFO_SCREEN,                 CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_PREV_TEAM,             SCBA_INFO_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_NEXT_TEAM,             SCBA_INFO_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_SELECT,      SCBA_GUARD_ALARM_PENDING, SCBA_ACTION_ACK_ALARM,             SCBA_INFO_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_SELECT,      SCBA_GUARD_NOT_STARTED,   SCBA_ACTION_OPEN_CNFG,             SCBA_CNFG_SCREEN_NR},
+  {SCBA_INFO_SCREEN,                 CLICK_SELECT,      SCBA_GUARD_STARTED,       SCBA_ACTION_OPEN_PRESSURE_UPDATE,  SCBA_UPDATE_PRESSURE},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_SELECT, SCBA_GUARD_DRILL_IDLE,    SCBA_ACTION_ASK_END_DRILL,         SCBA_END_DRILL},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_SELECT, SCBA_GUARD_ALL_IDLE,      SCBA_ACTION_OPEN_DRILL_SETUP,      SCBA_DRILL_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_SELECT, SCBA_GUARD_ALWAYS,        SCBA_ACTION_ASK_STOP,              SCBA_STOP_MONITORING},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_DOWN,   SCBA_GUARD_ALWAYS,        SCBA_ACTION_OPEN_OVERVIEW,         SCBA_OVERVIEW_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_UP,     SCBA_GUARD_NOT_STARTED,   SCBA_ACTION_FAST_START,            SCBA_INFO_SCREEN},
+  {SCBA_INFO_SCREEN,                 CLICK_LONG_UP,     SCBA_GUARD_STARTED,       SCBA_ACTION_OPEN_DETAIL,           SCBA_DETAIL_SCREEN},
+  // team number input, also used to correct a running team
+  {SCBA_CNFG_SCREEN_NR,              CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_TEAM_NR_UP,            SCBA_CNFG_SCREEN_NR},
+  {SCBA_CNFG_SCREEN_NR,              CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_TEAM_NR_DOWN,          SCBA_CNFG_SCREEN_NR},
+  {SCBA_CNFG_SCREEN_NR,              CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CONFIRM_TEAM_NR,       SCBA_CNFG_SCREEN_BOTTLE_TYPE},
+  // bottle type input
+  {SCBA_CNFG_SCREEN_BOTTLE_TYPE,     CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_BOTTLE_TYPE_UP,        SCBA_CNFG_SCREEN_BOTTLE_TYPE},
+  {SCBA_CNFG_SCREEN_BOTTLE_TYPE,     CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_BOTTLE_TYPE_DOWN,      SCBA_CNFG_SCREEN_BOTTLE_TYPE},
+  {SCBA_CNFG_SCREEN_BOTTLE_TYPE,     CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CONFIRM_BOTTLE_TYPE,   SCBA_CNFG_SCREEN_BOTTLE_PRESSURE},
+  // start pressure input, a running team keeps its start time
+  {SCBA_CNFG_SCREEN_BOTTLE_PRESSURE, CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_PRESSURE_UP,           SCBA_CNFG_SCREEN_BOTTLE_PRESSURE},
+  {SCBA_CNFG_SCREEN_BOTTLE_PRESSURE, CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_PRESSURE_DOWN,         SCBA_CNFG_SCREEN_BOTTLE_PRESSURE},
+  {SCBA_CNFG_SCREEN_BOTTLE_PRESSURE, CLICK_SELECT,      SCBA_GUARD_STARTED,       SCBA_ACTION_CORRECT_TEAM,          SCBA_INFO_SCREEN},
+  {SCBA_CNFG_SCREEN_BOTTLE_PRESSURE, CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_START_TEAM,            SCBA_INFO_SCREEN},
+  // pressure update of a running team
+  {SCBA_UPDATE_PRESSURE,             CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_PRESSURE_UP,           SCBA_UPDATE_PRESSURE},
+  {SCBA_UPDATE_PRESSURE,             CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_PRESSURE_DOWN,         SCBA_UPDATE_PRESSURE},
+  {SCBA_UPDATE_PRESSURE,             CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CONFIRM_PRESSURE,      SCBA_INFO_SCREEN},
+  // stop request, during a drill holding select asks to end the drill instead
+  {SCBA_STOP_MONITORING,             CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CANCEL_STOP,           SCBA_INFO_SCREEN},
+  {SCBA_STOP_MONITORING,             CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CANCEL_STOP,           SCBA_INFO_SCREEN},
+  {SCBA_STOP_MONITORING,             CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_STOP_TEAM,             SCBA_INFO_SCREEN},
+  {SCBA_STOP_MONITORING,             CLICK_LONG_SELECT, SCBA_GUARD_DRILL,         SCBA_ACTION_ASK_END_DRILL,         SCBA_END_DRILL},
+  // end of the drill, drops all drill teams
+  {SCBA_END_DRILL,                   CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CANCEL_STOP,           SCBA_INFO_SCREEN},
+  {SCBA_END_DRILL,                   CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CANCEL_STOP,           SCBA_INFO_SCREEN},
+  {SCBA_END_DRILL,                   CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_END_DRILL,             SCBA_INFO_SCREEN},
+  // commander overview, select jumps to the most urgent team, holding up
+  // shows the handover code, holding select the acknowledgement times,
+  // holding down collapses the sectors one after the other
+  {SCBA_OVERVIEW_SCREEN,             CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_OVERVIEW,        SCBA_INFO_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_OVERVIEW,        SCBA_INFO_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_SELECT_FIRST_TEAM,     SCBA_INFO_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_LONG_DOWN,   SCBA_GUARD_SECTORS,       SCBA_ACTION_SECTOR_VIEW,           SCBA_OVERVIEW_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_LONG_DOWN,   SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_OVERVIEW,        SCBA_INFO_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_LONG_UP,     SCBA_GUARD_ALWAYS,        SCBA_ACTION_OPEN_HANDOVER,         SCBA_HANDOVER_SCREEN},
+  {SCBA_OVERVIEW_SCREEN,             CLICK_LONG_SELECT, SCBA_GUARD_ALWAYS,        SCBA_ACTION_OPEN_ACK_SUMMARY,      SCBA_ACK_SCREEN},
+  // pressure history of the active team, holding up again corrects the team,
+  // holding down moves it to the next sector
+  {SCBA_DETAIL_SCREEN,               CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_DETAIL,          SCBA_INFO_SCREEN},
+  {SCBA_DETAIL_SCREEN,               CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_DETAIL,          SCBA_INFO_SCREEN},
+  {SCBA_DETAIL_SCREEN,               CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_DETAIL,          SCBA_INFO_SCREEN},
+  {SCBA_DETAIL_SCREEN,               CLICK_LONG_UP,     SCBA_GUARD_STARTED,       SCBA_ACTION_OPEN_CORRECTION,       SCBA_CNFG_SCREEN_NR},
+  {SCBA_DETAIL_SCREEN,               CLICK_LONG_DOWN,   SCBA_GUARD_STARTED,       SCBA_ACTION_NEXT_SECTOR,           SCBA_DETAIL_SCREEN},
+  // drill setup, up picks the time scale, down the scenario
+  {SCBA_DRILL_SCREEN,                CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_DRILL_SCALE,           SCBA_DRILL_SCREEN},
+  {SCBA_DRILL_SCREEN,                CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_DRILL_SCENARIO,        SCBA_DRILL_SCREEN},
+  {SCBA_DRILL_SCREEN,                CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_START_DRILL,           SCBA_INFO_SCREEN},
+  {SCBA_DRILL_SCREEN,                CLICK_LONG_SELECT, SCBA_GUARD_ALWAYS,        SCBA_ACTION_CANCEL_DRILL,          SCBA_INFO_SCREEN},
+  // handover QR code of all running teams over the overview
+  {SCBA_HANDOVER_SCREEN,             CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_HANDOVER,        SCBA_OVERVIEW_SCREEN},
+  {SCBA_HANDOVER_SCREEN,             CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_HANDOVER,        SCBA_OVERVIEW_SCREEN},
+  {SCBA_HANDOVER_SCREEN,             CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_HANDOVER,        SCBA_OVERVIEW_SCREEN},
+  // time to acknowledge the alarms, holding select clears it
+  {SCBA_ACK_SCREEN,                  CLICK_UP,          SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_ACK_SUMMARY,     SCBA_OVERVIEW_SCREEN},
+  {SCBA_ACK_SCREEN,                  CLICK_DOWN,        SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_ACK_SUMMARY,     SCBA_OVERVIEW_SCREEN},
+  {SCBA_ACK_SCREEN,                  CLICK_SELECT,      SCBA_GUARD_ALWAYS,        SCBA_ACTION_CLOSE_ACK_SUMMARY,     SCBA_OVERVIEW_SCREEN},
+  {SCBA_ACK_SCREEN,                  CLICK_LONG_SELECT, SCBA_GUARD_ALWAYS,        SCBA_ACTION_RESET_ACK_SUMMARY,     SCBA_ACK_SCREEN},
+};
+
+const uint8_t scba_transition_count = sizeof(scba_transitions) / sizeof(scba_transitions[0]);
+
+const scba_state_policy_t scba_state_policies[SCBA_SCREENS] = {
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_START_SCREEN
+  {SCBA_TICK_FREEZE_ACTIVE, SCBA_REPEAT_NONE},    // SCBA_CNFG_SCREEN_NR
+  {SCBA_TICK_FREEZE_ACTIVE, SCBA_REPEAT_NONE},    // SCBA_CNFG_SCREEN_BOTTLE_TYPE
+  {SCBA_TICK_FREEZE_ACTIVE, SCBA_REPEAT_FAST},    // SCBA_CNFG_SCREEN_BOTTLE_PRESSURE
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_INFO_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_ALARM
+  {SCBA_TICK_FREEZE_AIR,    SCBA_REPEAT_FAST},    // SCBA_UPDATE_PRESSURE
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_STOP_MONITORING
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_OVERVIEW_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_DETAIL_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_DRILL_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_HANDOVER_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE},    // SCBA_ACK_SCREEN
+  {SCBA_TICK_RUN,           SCBA_REPEAT_NONE}     // SCBA_END_DRILL
+};
+
+#ifdef SCBA_HOST_BUILD
+const char* const scba_state_names[SCBA_SCREENS] = {
+  "START_SCREEN", "CNFG_SCREEN_NR", "CNFG_SCREEN_BOTTLE_TYPE", "CNFG_SCREEN_BOTTLE_PRESSURE",
+  "INFO_SCREEN", "ALARM", "UPDATE_PRESSURE", "STOP_MONITORING", "OVERVIEW_SCREEN",
+  "DETAIL_SCREEN", "DRILL_SCREEN", "HANDOVER_SCREEN", "ACK_SCREEN", "END_DRILL"
+};
+
+const char* const scba_button_names[CLICK_BUTTONS] = {
+  "SELECT", "DOWN", "UP", "LONG_SELECT", "LONG_UP", "LONG_DOWN"
+};
+
+// indexed by the guard value
+const char* const scba_guard_names[] = {
+  [SCBA_GUARD_ALWAYS] = "always",
+  [SCBA_GUARD_NOT_STARTED] = "not started",
+  [SCBA_GUARD_STARTED] = "started",
+  [SCBA_GUARD_ALARM_PENDING] = "alarm pending",
+  [SCBA_GUARD_ALL_IDLE] = "all idle",
+  [SCBA_GUARD_DRILL_IDLE] = "drill idle",
+  [SCBA_GUARD_SECTORS] = "sectors",
+  [SCBA_GUARD_DRILL] = "drill"
+};
+
+const char* const scba_action_names[SCBA_ACTIONS] = {
+  "none", "prev team", "next team", "ack alarm", "open cnfg", "open pressure update",
+  "team nr up", "team nr down", "confirm team nr", "bottle type up", "bottle type down",
+  "confirm bottle type", "pressure up", "pressure down", "start team", "confirm pressure",
+  "ask stop", "stop team", "cancel stop", "open overview", "close overview", "select first team",
+  "fast start", "open correction", "correct team", "open detail", "close detail",
+  "open drill setup", "drill scale", "drill scenario", "start drill", "cancel drill", "end drill",
+  "open handover", "close handover", "open ack summary", "close ack summary", "reset ack summary",
+  "next sector", "sector view", "ask end drill"
+};
+#endif // #ifdef SCBA_HOST_BUILD
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Returns the first row matching the screen, the button and one of the
+* guards of the active team or NULL if the button does nothing there.
+*/
+const scba_transition_t* scba_find_transition(uint8_t state, uint8_t button, uint8_t guards)
+{
+  uint8_t i;
+  
+  for(i=0; i<scba_transition_count; i++)
+  {
+    if((scba_transitions[i].state == state) && (scba_transitions[i].button == button) &&
+       ((scba_transitions[i].guard == SCBA_GUARD_ALWAYS) || ((scba_transitions[i].guard & guards) != 0)))
+    {
+      return (&scba_transitions[i]);
+    }
+  }
+  return (NULL);
+}
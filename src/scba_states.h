@@ -0,0 +1,138 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_STATES__
+#define __SCBA_STATES__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_START_SCREEN  0x00
+#define SCBA_CNFG_SCREEN_NR  0x01
+#define SCBA_CNFG_SCREEN_BOTTLE_TYPE  0x02
+#define SCBA_CNFG_SCREEN_BOTTLE_PRESSURE  0x03
+#define SCBA_INFO_SCREEN  0x04
+#define SCBA_ALARM  0x05
+#define SCBA_UPDATE_PRESSURE  0x06
+#define SCBA_STOP_MONITORING  0x07
+#define SCBA_OVERVIEW_SCREEN  0x08
+#define SCBA_DETAIL_SCREEN  0x09
+#define SCBA_DRILL_SCREEN  0x0A
+#define SCBA_HANDOVER_SCREEN  0x0B
+#define SCBA_ACK_SCREEN  0x0C
+#define SCBA_END_DRILL  0x0D
+#define SCBA_SCREENS  0x0E
+
+#define CLICK_SELECT 0x00
+#define CLICK_DOWN 0x01
+#define CLICK_UP 0x02
+#define CLICK_LONG_SELECT 0x03
+#define CLICK_LONG_UP 0x04   // only on screens without SCBA_REPEAT_FAST
+#define CLICK_LONG_DOWN 0x05 // only on screens without SCBA_REPEAT_FAST
+#define CLICK_BUTTONS 0x06
+#define CLICK_NONE 0xFF
+
+// guards are evaluated against the active team, 0 matches always
+#define SCBA_GUARD_ALWAYS 0x00
+#define SCBA_GUARD_NOT_STARTED 0x01
+#define SCBA_GUARD_STARTED 0x02
+#define SCBA_GUARD_ALARM_PENDING 0x04
+#define SCBA_GUARD_ALL_IDLE 0x08    // no team is running and no drill either
+#define SCBA_GUARD_DRILL_IDLE 0x10  // a drill is running, the active team is not
+#define SCBA_GUARD_SECTORS 0x20     // a running team has a sector
+#define SCBA_GUARD_DRILL 0x40       // a drill is running
+
+#define SCBA_ACTION_NONE 0x00
+#define SCBA_ACTION_PREV_TEAM 0x01
+#define SCBA_ACTION_NEXT_TEAM 0x02
+#define SCBA_ACTION_ACK_ALARM 0x03
+#define SCBA_ACTION_OPEN_CNFG 0x04
+#define SCBA_ACTION_OPEN_PRESSURE_UPDATE 0x05
+#define SCBA_ACTION_TEAM_NR_UP 0x06
+#define SCBA_ACTION_TEAM_NR_DOWN 0x07
+#define SCBA_ACTION_CONFIRM_TEAM_NR 0x08
+#define SCBA_ACTION_BOTTLE_TYPE_UP 0x09
+#define SCBA_ACTION_BOTTLE_TYPE_DOWN 0x0A
+#define SCBA_ACTION_CONFIRM_BOTTLE_TYPE 0x0B
+#define SCBA_ACTION_PRESSURE_UP 0x0C
+#define SCBA_ACTION_PRESSURE_DOWN 0x0D
+#define SCBA_ACTION_START_TEAM 0x0E
+#define SCBA_ACTION_CONFIRM_PRESSURE 0x0F
+#define SCBA_ACTION_ASK_STOP 0x10
+#define SCBA_ACTION_STOP_TEAM 0x11
+#define SCBA_ACTION_CANCEL_STOP 0x12
+#define SCBA_ACTION_OPEN_OVERVIEW 0x13
+#define SCBA_ACTION_CLOSE_OVERVIEW 0x14
+#define SCBA_ACTION_SELECT_FIRST_TEAM 0x15
+#define SCBA_ACTION_FAST_START 0x16
+#define SCBA_ACTION_OPEN_CORRECTION 0x17
+#define SCBA_ACTION_CORRECT_TEAM 0x18
+#define SCBA_ACTION_OPEN_DETAIL 0x19
+#define SCBA_ACTION_CLOSE_DETAIL 0x1A
+#define SCBA_ACTION_OPEN_DRILL_SETUP 0x1B
+#define SCBA_ACTION_DRILL_SCALE 0x1C
+#define SCBA_ACTION_DRILL_SCENARIO 0x1D
+#define SCBA_ACTION_START_DRILL 0x1E
+#define SCBA_ACTION_CANCEL_DRILL 0x1F
+#define SCBA_ACTION_END_DRILL 0x20
+#define SCBA_ACTION_OPEN_HANDOVER 0x21
+#define SCBA_ACTION_CLOSE_HANDOVER 0x22
+#define SCBA_ACTION_OPEN_ACK_SUMMARY 0x23
+#define SCBA_ACTION_CLOSE_ACK_SUMMARY 0x24
+#define SCBA_ACTION_RESET_ACK_SUMMARY 0x25
+#define SCBA_ACTION_NEXT_SECTOR 0x26
+#define SCBA_ACTION_SECTOR_VIEW 0x27
+#define SCBA_ACTION_ASK_END_DRILL 0x28
+#define SCBA_ACTIONS 0x29
+
+// what the second tick does while a screen is shown
+#define SCBA_TICK_RUN 0x00
+#define SCBA_TICK_FREEZE_AIR 0x01
+#define SCBA_TICK_FREEZE_ACTIVE 0x02 // only the active team, it is being edited
+
+// what holding up/down does while a screen is shown
+#define SCBA_REPEAT_NONE 0x00
+#define SCBA_REPEAT_FAST 0x01
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint8_t state;
+  uint8_t button;
+  uint8_t guard;
+  uint8_t action;
+  uint8_t next_state;
+}__attribute__((__packed__)) scba_transition_t;
+
+typedef struct
+{
+  uint8_t tick_policy;
+  uint8_t repeat_policy;
+}__attribute__((__packed__)) scba_state_policy_t;
+
+//* ---------- global variables -------- *//
+//                                        //
+//* ------------------------------------ *//
+extern const scba_transition_t scba_transitions[];
+extern const uint8_t scba_transition_count;
+extern const scba_state_policy_t scba_state_policies[SCBA_SCREENS];
+
+#ifdef SCBA_HOST_BUILD
+extern const char* const scba_state_names[SCBA_SCREENS];
+extern const char* const scba_button_names[CLICK_BUTTONS];
+extern const char* const scba_guard_names[];
+extern const char* const scba_action_names[SCBA_ACTIONS];
+#endif // #ifdef SCBA_HOST_BUILD
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+const scba_transition_t* scba_find_transition(uint8_t state, uint8_t button, uint8_t guards);
+
+#endif
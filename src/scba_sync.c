@@ -0,0 +1,304 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER                                     
+//                                                                                  
+//  DESCRIPTION: 
+//
+//  Team state sync between watches. Team changes (start, pressure update,
+//  alarm acknowledge, stop) are sent as small binary deltas through the
+//  phone to the other watches. Every change carries a clock, the newer
+//  change time wins, the origin id of the watch breaks ties.
+//  A start or stop begins a new run of the team slot and replaces all its
+//  fields when it is newer than the current run. Pressure updates and
+//  acknowledges name the run they belong to and are merged independently,
+//  last writer wins, within that run only, so a late update never lands
+//  on a team that was restarted meanwhile. Applying the same delta twice
+//  leads to the same result on every watch.
+//
+//  Wire format (little endian):
+//    byte 0     version << 4 | type
+//    byte 1     team slot
+//    byte 2     origin id
+//    byte 3-6   change time
+//    START      team nr (1), bottle type (1), start time (4), air volume (2)
+//    PRESSURE   run time (4), run origin (1), air volume (2)
+//    ACK        run time (4), run origin (1), status (1)
+//    STOP       -
+//                                                                          
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_sync.h"
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static uint8_t scba_sync_payload_size(uint8_t type);
+static bool scba_sync_clock_newer(const scba_sync_clock_t *a, const scba_sync_clock_t *b);
+static bool scba_sync_clock_equal(const scba_sync_clock_t *a, const scba_sync_clock_t *b);
+static void scba_sync_put(uint8_t *buffer, uint32_t value, uint8_t size);
+static uint32_t scba_sync_get(const uint8_t *buffer, uint8_t size);
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_SYNC_NO_PAYLOAD 0xFF         // unknown delta type
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Returns the encoded size or 0 if the buffer is too small.
+*/
+uint8_t scba_sync_encode(const scba_sync_delta_t *delta, uint8_t *buffer, uint8_t buffer_size)
+{
+  uint8_t payload = scba_sync_payload_size(delta->type);
+  
+  if((payload == SCBA_SYNC_NO_PAYLOAD) || (SCBA_SYNC_HEADER_SIZE + payload > buffer_size))
+  {
+    return (0);
+  }
+  
+  buffer[0] = (SCBA_SYNC_VERSION << 4) | delta->type;
+  buffer[1] = delta->team;
+  buffer[2] = delta->clock.origin;
+  scba_sync_put(&buffer[3], delta->clock.stamp, 4);
+  
+  switch(delta->type)
+  {
+    case SCBA_SYNC_START:
+      buffer[7] = delta->team_nr;
+      buffer[8] = delta->bottle_type;
+      scba_sync_put(&buffer[9], delta->start_time, 4);
+      scba_sync_put(&buffer[13], delta->air_volume, 2);
+      break;
+    
+    case SCBA_SYNC_PRESSURE:
+      scba_sync_put(&buffer[7], delta->run.stamp, 4);
+      buffer[11] = delta->run.origin;
+      scba_sync_put(&buffer[12], delta->air_volume, 2);
+      break;
+    
+    case SCBA_SYNC_ACK:
+      scba_sync_put(&buffer[7], delta->run.stamp, 4);
+      buffer[11] = delta->run.origin;
+      buffer[12] = delta->status;
+      break;
+    
+    default:
+      break;
+  }
+  return (SCBA_SYNC_HEADER_SIZE + payload);
+}
+
+/**
+* Returns the number of bytes used or 0 if the buffer holds no valid delta.
+*/
+uint8_t scba_sync_decode(const uint8_t *buffer, uint16_t length, scba_sync_delta_t *delta)
+{
+  uint8_t payload = 0;
+  
+  if((length < SCBA_SYNC_HEADER_SIZE) || ((buffer[0] >> 4) != SCBA_SYNC_VERSION))
+  {
+    return (0);
+  }
+  
+  delta->type = buffer[0] & 0x0F;
+  payload = scba_sync_payload_size(delta->type);
+  if((payload == SCBA_SYNC_NO_PAYLOAD) || (SCBA_SYNC_HEADER_SIZE + payload > length))
+  {
+    return (0);
+  }
+  
+  delta->team = buffer[1];
+  delta->clock.origin = buffer[2];
+  delta->clock.stamp = scba_sync_get(&buffer[3], 4);
+  
+  switch(delta->type)
+  {
+    case SCBA_SYNC_START:
+      delta->team_nr = buffer[7];
+      delta->bottle_type = buffer[8];
+      delta->start_time = scba_sync_get(&buffer[9], 4);
+      delta->air_volume = scba_sync_get(&buffer[13], 2);
+      break;
+    
+    case SCBA_SYNC_PRESSURE:
+      delta->run.stamp = scba_sync_get(&buffer[7], 4);
+      delta->run.origin = buffer[11];
+      delta->air_volume = scba_sync_get(&buffer[12], 2);
+      break;
+    
+    case SCBA_SYNC_ACK:
+      delta->run.stamp = scba_sync_get(&buffer[7], 4);
+      delta->run.origin = buffer[11];
+      delta->status = buffer[12];
+      break;
+    
+    default:
+      break;
+  }
+  return (SCBA_SYNC_HEADER_SIZE + payload);
+}
+
+/**
+* Returns the mask of the fields a delta type writes.
+*/
+uint8_t scba_sync_fields(uint8_t type)
+{
+  switch(type)
+  {
+    case SCBA_SYNC_START:
+    case SCBA_SYNC_STOP:
+      return (SCBA_SYNC_ALL_FIELDS);
+    
+    case SCBA_SYNC_PRESSURE:
+      return (1 << SCBA_SYNC_FIELD_AIR);
+    
+    case SCBA_SYNC_ACK:
+      return (1 << SCBA_SYNC_FIELD_STATUS);
+    
+    default:
+      return (0);
+  }
+}
+
+/**
+* Merges the clock of a delta into the field clocks of its team. Returns
+* the mask of the fields the delta won, the caller applies only those.
+*/
+uint8_t scba_sync_merge(scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], const scba_sync_delta_t *delta)
+{
+  uint8_t fields = scba_sync_fields(delta->type);
+  uint8_t won = 0;
+  uint8_t i;
+  
+  if((fields & (1 << SCBA_SYNC_FIELD_RUN)) != 0)
+  {
+    // a newer run replaces everything of the old one
+    if(scba_sync_clock_newer(&delta->clock, &clocks[SCBA_SYNC_FIELD_RUN]) == false)
+    {
+      return (0);
+    }
+    for(i=0; i<SCBA_SYNC_FIELDS; i++)
+    {
+      clocks[i] = delta->clock;
+    }
+    return (SCBA_SYNC_ALL_FIELDS);
+  }
+  
+  if(scba_sync_clock_equal(&delta->run, &clocks[SCBA_SYNC_FIELD_RUN]) == false)
+  {
+    return (0);
+  }
+  
+  for(i=0; i<SCBA_SYNC_FIELDS; i++)
+  {
+    if(((fields & (1 << i)) != 0) && (scba_sync_clock_newer(&delta->clock, &clocks[i]) == true))
+    {
+      clocks[i] = delta->clock;
+      won |= (1 << i);
+    }
+  }
+  return (won);
+}
+
+/**
+* True if the delta belongs to a run whose start has not been seen here,
+* the start got lost and the other watches have to send their teams again.
+*/
+bool scba_sync_missing_run(const scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], const scba_sync_delta_t *delta)
+{
+  return (((scba_sync_fields(delta->type) & (1 << SCBA_SYNC_FIELD_RUN)) == 0) &&
+          (scba_sync_clock_newer(&delta->run, &clocks[SCBA_SYNC_FIELD_RUN]) == true));
+}
+
+/**
+* Returns the clock for a change made on this watch. It is newer than all
+* fields it writes, even if the clock of another watch runs ahead.
+*/
+scba_sync_clock_t scba_sync_local_clock(const scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], uint8_t type, uint32_t now, uint8_t origin)
+{
+  uint8_t fields = scba_sync_fields(type);
+  scba_sync_clock_t clock = {now, origin};
+  uint8_t i;
+  
+  for(i=0; i<SCBA_SYNC_FIELDS; i++)
+  {
+    if(((fields & (1 << i)) != 0) && (clocks[i].stamp >= clock.stamp))
+    {
+      clock.stamp = clocks[i].stamp + 1;
+    }
+  }
+  return (clock);
+}
+
+/**
+*
+*/
+static uint8_t scba_sync_payload_size(uint8_t type)
+{
+  switch(type)
+  {
+    case SCBA_SYNC_START:
+      return (8);
+    
+    case SCBA_SYNC_PRESSURE:
+      return (7);
+    
+    case SCBA_SYNC_ACK:
+      return (6);
+    
+    case SCBA_SYNC_STOP:
+      return (0);
+    
+    default:
+      return (SCBA_SYNC_NO_PAYLOAD);
+  }
+}
+
+/**
+*
+*/
+static bool scba_sync_clock_newer(const scba_sync_clock_t *a, const scba_sync_clock_t *b)
+{
+  return ((a->stamp > b->stamp) || ((a->stamp == b->stamp) && (a->origin > b->origin)));
+}
+
+/**
+*
+*/
+static bool scba_sync_clock_equal(const scba_sync_clock_t *a, const scba_sync_clock_t *b)
+{
+  return ((a->stamp == b->stamp) && (a->origin == b->origin));
+}
+
+/**
+*
+*/
+static void scba_sync_put(uint8_t *buffer, uint32_t value, uint8_t size)
+{
+  uint8_t i;
+  
+  for(i=0; i<size; i++)
+  {
+    buffer[i] = (value >> (8 * i)) & 0xFF;
+  }
+}
+
+/**
+*
+*/
+static uint32_t scba_sync_get(const uint8_t *buffer, uint8_t size)
+{
+  uint32_t value = 0;
+  uint8_t i;
+  
+  for(i=0; i<size; i++)
+  {
+    value |= (uint32_t)buffer[i] << (8 * i);
+  }
+  return (value);
+}
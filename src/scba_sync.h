@@ -0,0 +1,70 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_SYNC__
+#define __SCBA_SYNC__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_SYNC_VERSION 1
+
+#define SCBA_SYNC_START 0x01
+#define SCBA_SYNC_PRESSURE 0x02
+#define SCBA_SYNC_ACK 0x03
+#define SCBA_SYNC_STOP 0x04
+
+// independently merged fields of a team, one bit each in field masks
+#define SCBA_SYNC_FIELD_RUN 0x00    // start or stop, team nr, bottle, start time
+#define SCBA_SYNC_FIELD_AIR 0x01    // air volume of the last reading
+#define SCBA_SYNC_FIELD_STATUS 0x02 // alarm status
+#define SCBA_SYNC_FIELDS 0x03
+#define SCBA_SYNC_ALL_FIELDS ((1 << SCBA_SYNC_FIELDS) - 1)
+
+// a message of only this byte asks the watch to send all its teams again
+#define SCBA_SYNC_RESEND_REQUEST 0x00
+
+#define SCBA_SYNC_HEADER_SIZE 7
+#define SCBA_SYNC_MAX_DELTA_SIZE (SCBA_SYNC_HEADER_SIZE + 8)
+// start, pressure update and acknowledge of one team
+#define SCBA_SYNC_MAX_TEAM_SIZE ((3 * SCBA_SYNC_HEADER_SIZE) + 8 + 7 + 6)
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// last writer of a field: change time and the watch it was made on
+typedef struct
+{
+  uint32_t stamp;
+  uint8_t  origin;
+}__attribute__((__packed__)) scba_sync_clock_t;
+
+// one change of one team, decoded
+typedef struct
+{
+  uint8_t  type;
+  uint8_t  team;
+  scba_sync_clock_t clock;
+  scba_sync_clock_t run;  // SCBA_SYNC_PRESSURE, SCBA_SYNC_ACK: start of the run they belong to
+  uint8_t  team_nr;       // SCBA_SYNC_START
+  uint8_t  bottle_type;   // SCBA_SYNC_START
+  uint32_t start_time;    // SCBA_SYNC_START
+  uint16_t air_volume;    // SCBA_SYNC_START, SCBA_SYNC_PRESSURE
+  uint8_t  status;        // SCBA_SYNC_ACK
+}scba_sync_delta_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+uint8_t scba_sync_encode(const scba_sync_delta_t *delta, uint8_t *buffer, uint8_t buffer_size);
+uint8_t scba_sync_decode(const uint8_t *buffer, uint16_t length, scba_sync_delta_t *delta);
+uint8_t scba_sync_fields(uint8_t type);
+uint8_t scba_sync_merge(scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], const scba_sync_delta_t *delta);
+bool scba_sync_missing_run(const scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], const scba_sync_delta_t *delta);
+scba_sync_clock_t scba_sync_local_clock(const scba_sync_clock_t clocks[SCBA_SYNC_FIELDS], uint8_t type, uint32_t now, uint8_t origin);
+
+#endif
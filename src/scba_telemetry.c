@@ -0,0 +1,52 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Cylinder pressures of SCBA sets that report digitally, relayed by the
+//  phone (see scba_tracker_telemetry.js). The phone only passes on the
+//  readings that matter and sends them in batches, the watch takes every
+//  reading as if the pressure was entered by hand.
+//
+//  Message of SCBA_MSG_KEY_TELEMETRY, one entry per team number:
+//
+//    team number     1 byte
+//    pressure        2 bytes, in bar, least significant byte first
+//    age             1 byte, seconds from the reading until it was sent
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_telemetry.h"
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Returns the number of readings, 0 if the message is not a batch.
+*/
+uint8_t scba_telemetry_decode(const uint8_t *buffer, uint16_t length, scba_telemetry_reading_t *readings, uint8_t max_readings)
+{
+  uint8_t count = 0;
+  uint16_t offset = 0;
+
+  if((length == 0) || ((length % SCBA_TELEMETRY_ENTRY_SIZE) != 0) || ((length / SCBA_TELEMETRY_ENTRY_SIZE) > max_readings))
+  {
+    return (0);
+  }
+  for(offset=0; offset<length; offset+=SCBA_TELEMETRY_ENTRY_SIZE)
+  {
+    if(buffer[offset] == 0)
+    {
+      return (0);
+    }
+    readings[count].team_nr = buffer[offset];
+    readings[count].pressure = buffer[offset+1] | (buffer[offset+2] << 8);
+    readings[count].age = buffer[offset+3];
+    count++;
+  }
+  return (count);
+}
@@ -0,0 +1,33 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_TELEMETRY__
+#define __SCBA_TELEMETRY__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define SCBA_TELEMETRY_ENTRY_SIZE 4
+#define SCBA_TELEMETRY_MAX_READINGS 10   // one per team number
+#define SCBA_TELEMETRY_MAX_SIZE (SCBA_TELEMETRY_MAX_READINGS * SCBA_TELEMETRY_ENTRY_SIZE)
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+// newest reading of a team number, as thinned by the phone
+typedef struct
+{
+  uint8_t  team_nr;
+  uint16_t pressure;  // in bar
+  uint8_t  age;       // in seconds, from the reading until the batch was sent
+}scba_telemetry_reading_t;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+uint8_t scba_telemetry_decode(const uint8_t *buffer, uint16_t length, scba_telemetry_reading_t *readings, uint8_t max_readings);
+
+#endif
@@ -0,0 +1,72 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Event trace for the energy estimate. Every event that costs battery
+//  (wakeups, frames, flash writes, vibrations, backlight, messages) is
+//  counted here. main.c logs the counters as one line per minute:
+//
+//    trace t=<seconds> tick=<n> repeat_timer=<n> ...
+//
+//  The counters are cumulative since launch, tools/energy_report.py reads
+//  the log and weights them with the costs in tools/energy_costs.json.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include "scba_trace.h"
+#include "mini-printf.h"
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+const char* const scba_trace_names[SCBA_TRACE_EVENTS] = {
+  "tick", "repeat_timer", "timer", "redraw", "persist", "persist_bytes",
+  "vibe_short", "vibe_double", "light_seconds", "msg_out", "msg_out_bytes",
+  "msg_in", "msg_in_bytes"
+};
+
+static uint32_t scba_trace_counts[SCBA_TRACE_EVENTS];
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void scba_trace_add(uint8_t event, uint32_t amount)
+{
+  if(event < SCBA_TRACE_EVENTS)
+  {
+    scba_trace_counts[event] += amount;
+  }
+}
+
+/**
+*
+*/
+uint32_t scba_trace_get(uint8_t event)
+{
+  return ((event < SCBA_TRACE_EVENTS) ? scba_trace_counts[event] : 0);
+}
+
+/**
+* Writes the log line of all counters, returns its length.
+*/
+int scba_trace_format(char *buffer, unsigned int buffer_size, uint32_t seconds)
+{
+  int length = 0;
+  uint8_t i = 0;
+
+  length = mini_snprintf(buffer, buffer_size, "trace t=%d", (int)seconds);
+
+  for(i=0; (i<SCBA_TRACE_EVENTS) && (length < (int)buffer_size); i++)
+  {
+    length += mini_snprintf(&buffer[length], buffer_size - length, " %s=%d", scba_trace_names[i], (int)scba_trace_counts[i]);
+  }
+  return (length);
+}
@@ -0,0 +1,50 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+#ifndef __SCBA_TRACE__
+#define __SCBA_TRACE__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// energy relevant events, the names are the keys of tools/energy_costs.json
+#define SCBA_TRACE_TICK 0x00
+#define SCBA_TRACE_REPEAT_TIMER 0x01  // long_click_timer_callback()
+#define SCBA_TRACE_TIMER 0x02         // all other timer wakeups
+#define SCBA_TRACE_REDRAW 0x03        // frames drawn
+#define SCBA_TRACE_PERSIST 0x04
+#define SCBA_TRACE_PERSIST_BYTES 0x05
+#define SCBA_TRACE_VIBE_SHORT 0x06
+#define SCBA_TRACE_VIBE_DOUBLE 0x07
+#define SCBA_TRACE_LIGHT_SECONDS 0x08 // seconds the backlight is on
+#define SCBA_TRACE_MSG_OUT 0x09
+#define SCBA_TRACE_MSG_OUT_BYTES 0x0A
+#define SCBA_TRACE_MSG_IN 0x0B
+#define SCBA_TRACE_MSG_IN_BYTES 0x0C
+#define SCBA_TRACE_EVENTS 0x0D
+
+#define SCBA_TRACE_PERIOD 60  // in ticks between two log lines
+
+// the counting compiles away unless SCBA_TRACE is defined in main.h
+#ifdef SCBA_TRACE
+#define SCBA_TRACE_ADD(event, amount) scba_trace_add((event), (amount))
+#else
+#define SCBA_TRACE_ADD(event, amount)
+#endif // #ifdef SCBA_TRACE
+
+//* ---------- global variables -------- *//
+//                                        //
+//* ------------------------------------ *//
+extern const char* const scba_trace_names[SCBA_TRACE_EVENTS];
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+void scba_trace_add(uint8_t event, uint32_t amount);
+uint32_t scba_trace_get(uint8_t event);
+int scba_trace_format(char *buffer, unsigned int buffer_size, uint32_t seconds);
+
+#endif
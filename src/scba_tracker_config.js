@@ -1,55 +1,253 @@
+var SCBA_CONFIG_VERSION = 3;
+var SCBA_CONFIG_REQUEST = 0x00;
+var SCBA_CONFIG_HEADER_SIZE = 7;
+var SCBA_BOTTLE_NAME_LEN = 7;
+var SCBA_BOTTLE_CNFG_SIZE = 3 + SCBA_BOTTLE_NAME_LEN;
+var SCBA_ROSTER_TEAMS = 10;
+var SCBA_ROSTER_CREW = 3;
+var SCBA_ROSTER_NAME_LEN = 12;
+var SCBA_WATCH_SETTINGS = ["breath_rate", "bottles", "def_bottle", "imp_units", "check_int"];
+var SCBA_PHONE_SETTINGS = ["crew", "sync_url", "telemetry_url"];
+
+// the last configuration sent, until the watch answered it
+var sentConfiguration = null;
+// the settings the watch reported last, null until it answered
+var watchSettings = null;
+
 Pebble.addEventListener("ready", 
   function(e) {
     console.log("PebbleKit Js ready");
+    Pebble.sendAppMessage({"SCBA_MSG_KEY_CONFIG": [SCBA_CONFIG_REQUEST]},
+      
+      function(e){
+        console.log("Settings requested");
+      },
+      
+      function(e){
+        console.log("Settings request failed");
+      }
+    );
   }
 );
 
+// the configuration page is bundled with the app (SCBA_CONFIG_PAGE is
+// generated from resources/config_page by the wscript) and opened as data
+// URI, so no network is needed on scene. It shows the settings the watch
+// reported, or the ones it took last if it did not answer yet.
 Pebble.addEventListener("showConfiguration",
   function(e) {
-    Pebble.openURL("https://www.googledrive.com/host/0B2O_EhizVtu7c01TOGhqdUg5ck0");
+    var settings = JSON.parse(localStorage.getItem("scba_settings") || "null");
+    var page;
+    
+    if (watchSettings) {
+      settings = settings || {};
+      SCBA_WATCH_SETTINGS.forEach(function(key) {
+        settings[key] = watchSettings[key];
+      });
+    }
+    page = SCBA_CONFIG_PAGE.replace("/*SCBA_SETTINGS*/null", function() {
+      return JSON.stringify(settings).replace(/</g, "\\u003c");
+    });
+    
+    Pebble.openURL("data:text/html;charset=utf-8," + encodeURIComponent(page));
   }
 );
 
+// UTF-8 bytes of a name, at most maxLength of them without cutting a
+// character apart. The page checks the lengths, so nothing is cut there.
+function encodeName(name, maxLength) {
+  var utf8 = unescape(encodeURIComponent(name));
+  var length = Math.min(utf8.length, maxLength);
+  var bytes = [];
+  var i;
+  
+  while ((length < utf8.length) && ((utf8.charCodeAt(length) & 0xC0) === 0x80)) {
+    length--;
+  }
+  for (i = 0; i < length; i++) {
+    bytes.push(utf8.charCodeAt(i));
+  }
+  return bytes;
+}
+
+// the name bytes up to the ending 0, as they were sent if they are no UTF-8
+function decodeName(bytes) {
+  var end = bytes.indexOf(0);
+  var text = String.fromCharCode.apply(null, bytes.slice(0, (end < 0) ? bytes.length : end));
+  
+  try {
+    return decodeURIComponent(escape(text));
+  }
+  catch (e) {
+    return text;
+  }
+}
+
+// the settings of a scba_config_msg_t as the page keeps them, null if the
+// watch uses another version
+function decodeConfiguration(bytes) {
+  var bottles = [];
+  var offset;
+  var i;
+  
+  if (bytes[0] !== SCBA_CONFIG_VERSION) {
+    return null;
+  }
+  for (i = 0; i < bytes[5]; i++) {
+    offset = SCBA_CONFIG_HEADER_SIZE + (i * SCBA_BOTTLE_CNFG_SIZE);
+    bottles.push({
+      "name": decodeName(bytes.slice(offset + 3, offset + SCBA_BOTTLE_CNFG_SIZE)),
+      "volume": bytes[offset] / 10,
+      "pressure": bytes[offset + 1] | (bytes[offset + 2] << 8),
+      "enabled": (bytes[2] & (1 << i)) !== 0
+    });
+  }
+  return {
+    "breath_rate": String(bytes[1]),
+    "bottles": bottles,
+    "def_bottle": String(bytes[3]),
+    "imp_units": String(bytes[4]),
+    "check_int": String(bytes[6])
+  };
+}
+
+// packs the settings into the byte layout of scba_config_msg_t (main.h),
+// each bottle is a scba_bottle_cnfg_t (scba_bottles.h) with its name in UTF-8
+function encodeConfiguration(configuration) {
+  var bottles = configuration.bottles;
+  var bottleMask = 0;
+  var bytes;
+  var name;
+  var i;
+  
+  bytes = [
+    SCBA_CONFIG_VERSION,
+    parseInt(configuration.breath_rate, 10) & 0xFF,
+    0,
+    parseInt(configuration.def_bottle, 10) & 0xFF,
+    parseInt(configuration.imp_units, 10) & 0xFF,
+    bottles.length,
+    parseInt(configuration.check_int || 0, 10) & 0xFF
+  ];
+  
+  for (i = 0; i < bottles.length; i++) {
+    var volume = Math.round(bottles[i].volume * 10);
+    var pressure = bottles[i].pressure;
+    
+    name = encodeName(bottles[i].name, SCBA_BOTTLE_NAME_LEN - 1);
+    if (bottles[i].enabled) {
+      bottleMask |= (1 << i);
+    }
+    bytes.push(volume & 0xFF, pressure & 0xFF, (pressure >> 8) & 0xFF);
+    while (name.length < SCBA_BOTTLE_NAME_LEN) {
+      name.push(0);
+    }
+    bytes = bytes.concat(name);
+  }
+  bytes[2] = bottleMask;
+  
+  return bytes;
+}
+
+// one message per team number as scba_roster.c expects it: the number,
+// then the names in UTF-8, each ended by 0
+function encodeRoster(teamNr, crew) {
+  var bytes = [teamNr];
+  var names = (crew || "").split(",").map(function(name) { return name.trim(); }).filter(function(name) { return name.length > 0; });
+  var i;
+  
+  for (i = 0; i < names.length && i < SCBA_ROSTER_CREW; i++) {
+    bytes = bytes.concat(encodeName(names[i], SCBA_ROSTER_NAME_LEN - 1));
+    bytes.push(0);
+  }
+  return bytes;
+}
+
+// the team numbers are sent one after the other, each after the watch took the last
+function sendRoster(crew, teamNr) {
+  if (teamNr > SCBA_ROSTER_TEAMS) {
+    console.log("Roster sent");
+    return;
+  }
+  Pebble.sendAppMessage(
+    {"SCBA_MSG_KEY_ROSTER": encodeRoster(teamNr, crew[teamNr - 1])},
+    
+    function(e){
+      sendRoster(crew, teamNr + 1);
+    },
+    
+    function(e){
+      console.log("Roster feedback failed at team " + teamNr);
+    }
+  );
+}
+
+// the settings of the phone are kept at once, those of the watch only when
+// the watch answers the configuration message with them
+function storeSettings(configuration, keys) {
+  var settings = JSON.parse(localStorage.getItem("scba_settings") || "null") || {};
+  
+  keys.forEach(function(key) {
+    settings[key] = configuration[key];
+  });
+  localStorage.setItem("scba_settings", JSON.stringify(settings));
+}
+
+function sameBytes(first, second) {
+  return (first.length === second.length) && first.every(function(value, i) { return value === second[i]; });
+}
+
 Pebble.addEventListener("webviewclosed",
   function(e){
+    if (!e.response) {
+      console.log("Configuration canceled");
+      return;
+    }
+    
     var configuration = JSON.parse(decodeURIComponent(e.response));
-    console.log("Configuration window returned: " + JSON.stringify(configuration));
+    var bytes = encodeConfiguration(configuration);
     
-    var dictionary = {
-      "SCBA_STORE_KEY_BREATHING_RATE": configuration.breath_rate,
-      "SCBA_STORE_KEY_BOTTLE_ONE_AVAILABLE": configuration.type1,
-      "SCBA_STORE_KEY_BOTTLE_TWO_AVAILABLE": configuration.type2,
-      "SCBA_STORE_KEY_BOTTLE_THREE_AVAILABLE": configuration.type3,
-      "SCBA_STORE_KEY_BOTTLE_FOUR_AVAILABLE": configuration.type4,
-      "SCBA_STORE_KEY_BOTTLE_FIVE_AVAILABLE": configuration.type5,
-      "SCBA_STORE_KEY_BOTTLE_SIX_AVAILABLE": configuration.type6,
-      "SCBA_STORE_KEY_DEFAULT_BOTTLE": configuration.def_bottle,
-      "SCBA_STORE_KEY_IMPERIAL_UNITS": configuration.imp_units
-    };
+    console.log("Configuration window returned: " + JSON.stringify(configuration));
+    storeSettings(configuration, SCBA_PHONE_SETTINGS);
+    // the answer of the watch may come before the acknowledgement
+    sentConfiguration = {"settings": configuration, "bytes": bytes};
     
     Pebble.sendAppMessage(
-      dictionary,
-      
-      function(e){
-        console.log("Sending breath_rate...");
-      },
-      
-      function(e){
-        console.log("Settings feedback failed...");                             
-      }
-    );
-
-    Pebble.sendAppMessage(
-      {},
+      {"SCBA_MSG_KEY_CONFIG": bytes},
       
       function(e){
-        console.log("Sending bottle_type1...");
+        console.log("Settings sent");
+        sendRoster(configuration.crew || [], 1);
       },
       
       function(e){
         console.log("Settings feedback failed...");                             
+        sentConfiguration = null;
       }
     );
+  }
+);
 
+// the watch answers every configuration message with the configuration it uses
+Pebble.addEventListener("appmessage",
+  function(e) {
+    var reply = e.payload.SCBA_MSG_KEY_CONFIG;
+    
+    if (!reply) {
+      return;
+    }
+    watchSettings = decodeConfiguration(reply);
+    if (!sentConfiguration) {
+      return;
+    }
+    if (sameBytes(reply, sentConfiguration.bytes)) {
+      console.log("Settings applied");
+      storeSettings(sentConfiguration.settings, SCBA_WATCH_SETTINGS);
+    }
+    else {
+      console.log("Settings rejected");
+      Pebble.showSimpleNotificationOnPebble("SCBA Tracker", "The watch kept its settings, a running team uses a bottle that was changed or removed.");
+    }
+    sentConfiguration = null;
   }
 );
@@ -0,0 +1,147 @@
+// relays the team changes of the watch (SCBA_MSG_KEY_SYNC, see scba_sync.c)
+// to the other watches and back. The bytes are passed on unchanged, every
+// watch merges them itself, so the relay needs no knowledge of the format.
+var SCBA_SYNC_MAX_BATCH_SIZE = 126;
+var SCBA_SYNC_RESEND_REQUEST = 0x00;
+var SCBA_SYNC_MAX_QUEUE = 32;
+
+// transports by URL scheme, a transport is created with the URL and a
+// receive callback and offers send(bytes) and close(), it calls onOpen
+// whenever it (re)connected, so the watches exchange all their teams
+var SyncTransports = {
+  "ws:": createWebSocketTransport,
+  "wss:": createWebSocketTransport
+};
+
+var syncTransport = null;
+var syncQueue = [];
+var syncSending = false;
+
+// the server is expected to forward every binary frame to all other clients
+function createWebSocketTransport(url, onReceive, onOpen) {
+  var socket = null;
+  var closed = false;
+  var retryDelay = 1000;
+  
+  function connect() {
+    socket = new WebSocket(url);
+    socket.binaryType = "arraybuffer";
+    
+    socket.onopen = function() {
+      retryDelay = 1000;
+      onOpen();
+    };
+    
+    socket.onmessage = function(e) {
+      if (e.data instanceof ArrayBuffer) {
+        onReceive(Array.prototype.slice.call(new Uint8Array(e.data)));
+      }
+    };
+    
+    socket.onclose = function() {
+      if (!closed) {
+        setTimeout(connect, retryDelay);
+        retryDelay = Math.min(retryDelay * 2, 60000);
+      }
+    };
+  }
+  
+  connect();
+  
+  return {
+    send: function(bytes) {
+      if (socket.readyState === WebSocket.OPEN) {
+        socket.send(new Uint8Array(bytes).buffer);
+      }
+    },
+    close: function() {
+      closed = true;
+      socket.close();
+    }
+  };
+}
+
+function connectSyncTransport(url) {
+  var scheme = url ? url.substring(0, url.indexOf(":") + 1) : "";
+  
+  if (syncTransport) {
+    syncTransport.close();
+    syncTransport = null;
+  }
+  if (!SyncTransports[scheme]) {
+    console.log("Sync disabled");
+    return;
+  }
+  
+  syncTransport = SyncTransports[scheme](url, sendToWatch,
+    function() {
+      // push the own teams and ask the others for theirs
+      sendToWatch([SCBA_SYNC_RESEND_REQUEST]);
+      syncTransport.send([SCBA_SYNC_RESEND_REQUEST]);
+    });
+}
+
+function sendToWatch(bytes) {
+  // while the watch is away only the newest changes are kept, it gets the
+  // rest with the resend request when the connection is back
+  if (syncQueue.length >= SCBA_SYNC_MAX_QUEUE) {
+    syncQueue.shift();
+  }
+  syncQueue.push(bytes);
+  flushSyncQueue();
+}
+
+// deltas are self-delimiting, waiting ones are sent together as one message
+function flushSyncQueue() {
+  if (syncSending || syncQueue.length === 0) {
+    return;
+  }
+  
+  var message = syncQueue.shift();
+  while (syncQueue.length > 0 && message[0] !== SCBA_SYNC_RESEND_REQUEST &&
+         syncQueue[0][0] !== SCBA_SYNC_RESEND_REQUEST &&
+         message.length + syncQueue[0].length <= SCBA_SYNC_MAX_BATCH_SIZE) {
+    message = message.concat(syncQueue.shift());
+  }
+  
+  syncSending = true;
+  Pebble.sendAppMessage({"SCBA_MSG_KEY_SYNC": message},
+    function(e) {
+      syncSending = false;
+      flushSyncQueue();
+    },
+    function(e) {
+      // the watch is busy or gone, keep the message and try again later
+      console.log("Sync message to watch failed");
+      syncQueue.unshift(message);
+      setTimeout(function() {
+        syncSending = false;
+        flushSyncQueue();
+      }, 5000);
+    }
+  );
+}
+
+Pebble.addEventListener("ready",
+  function(e) {
+    var settings = JSON.parse(localStorage.getItem("scba_settings") || "null");
+    connectSyncTransport(settings ? settings.sync_url : null);
+  }
+);
+
+Pebble.addEventListener("appmessage",
+  function(e) {
+    if (syncTransport && e.payload.SCBA_MSG_KEY_SYNC) {
+      syncTransport.send(e.payload.SCBA_MSG_KEY_SYNC);
+    }
+  }
+);
+
+Pebble.addEventListener("webviewclosed",
+  function(e) {
+    if (!e.response) {
+      return;
+    }
+    connectSyncTransport(JSON.parse(decodeURIComponent(e.response)).sync_url);
+  }
+);
@@ -0,0 +1,153 @@
+// relays cylinder pressures of an external source to the watch
+// (SCBA_MSG_KEY_TELEMETRY, see scba_telemetry.c). A source may report many
+// times a second, only readings that matter are kept and the newest one of
+// every team is sent in a batch, so the radio use stays bounded whatever
+// the source does.
+var SCBA_TELEMETRY_MIN_CHANGE = 10;        // bar, smaller changes are dropped
+var SCBA_TELEMETRY_HEARTBEAT = 60000;      // ms, a steady pressure is sent again after
+var SCBA_TELEMETRY_BATCH_INTERVAL = 5000;  // ms, at most one message to the watch
+var SCBA_TELEMETRY_MAX_READINGS = 10;
+var SCBA_TELEMETRY_MAX_AGE = 255;          // s
+
+// sources by URL scheme, a source is created with the URL and a reading
+// callback onReading(teamNr, bar, timeMs) and offers close()
+var TelemetrySources = {
+  "sim:": createSimulatedSource
+};
+
+var telemetrySource = null;
+var telemetryTimer = null;
+var telemetrySending = false;
+var telemetrySent = {};     // by team number: {bar, timeMs} last sent
+var telemetryPending = {};  // by team number: {bar, timeMs} waiting for the batch
+
+// reference source, "sim:" or "sim:<teams>" breathes teams 1 to <teams>
+// (3 without) down from 300 bar with gauge noise, two readings a second
+function createSimulatedSource(url, onReading) {
+  var teams = parseInt(url.substring(4), 10) || 3;
+  var pressures = [];
+  var i;
+  
+  for (i = 0; i < teams; i++) {
+    pressures.push(300);
+  }
+  
+  var timer = setInterval(function() {
+    for (i = 0; i < teams; i++) {
+      // 50 to 80 l/min out of a 6.8 l cylinder, about 0.1 bar per half second
+      pressures[i] = Math.max(0, pressures[i] - 0.08 - 0.02 * i);
+      onReading(i + 1, Math.round(pressures[i] + (Math.random() - 0.5) * 4), Date.now());
+    }
+  }, 500);
+  
+  return {
+    close: function() {
+      clearInterval(timer);
+    }
+  };
+}
+
+function connectTelemetrySource(url) {
+  var scheme = url ? url.substring(0, url.indexOf(":") + 1) : "";
+  
+  if (telemetrySource) {
+    telemetrySource.close();
+    telemetrySource = null;
+  }
+  if (telemetryTimer) {
+    clearInterval(telemetryTimer);
+    telemetryTimer = null;
+  }
+  telemetrySent = {};
+  telemetryPending = {};
+  if (!TelemetrySources[scheme]) {
+    console.log("Telemetry disabled");
+    return;
+  }
+  
+  telemetrySource = TelemetrySources[scheme](url, takeTelemetryReading);
+  telemetryTimer = setInterval(flushTelemetry, SCBA_TELEMETRY_BATCH_INTERVAL);
+}
+
+// keeps a reading if it moved enough from the last one sent or the last one
+// sent is getting old, a newer reading of the team replaces a waiting one
+function takeTelemetryReading(teamNr, bar, timeMs) {
+  var sent = telemetrySent[teamNr];
+  
+  if (teamNr < 1 || teamNr > 255 || bar < 0 || bar > 0xFFFF) {
+    return;
+  }
+  if (sent && Math.abs(bar - sent.bar) < SCBA_TELEMETRY_MIN_CHANGE &&
+      timeMs - sent.timeMs < SCBA_TELEMETRY_HEARTBEAT) {
+    return;
+  }
+  telemetryPending[teamNr] = {"bar": bar, "timeMs": timeMs};
+}
+
+// team number, pressure in bar (little endian), age in seconds
+function encodeTelemetry(teamNrs, now) {
+  var bytes = [];
+  
+  teamNrs.forEach(function(teamNr) {
+    var reading = telemetryPending[teamNr];
+    var age = Math.round((now - reading.timeMs) / 1000);
+    
+    bytes.push(teamNr, reading.bar & 0xFF, (reading.bar >> 8) & 0xFF,
+               Math.max(0, Math.min(age, SCBA_TELEMETRY_MAX_AGE)));
+  });
+  return bytes;
+}
+
+function flushTelemetry() {
+  var teamNrs = Object.keys(telemetryPending).slice(0, SCBA_TELEMETRY_MAX_READINGS);
+  
+  // a message still on its way holds the next batch back, the readings
+  // waiting meanwhile are replaced by newer ones instead of piling up
+  if (telemetrySending || teamNrs.length === 0) {
+    return;
+  }
+  
+  var message = encodeTelemetry(teamNrs, Date.now());
+  var batch = {};
+  
+  teamNrs.forEach(function(teamNr) {
+    batch[teamNr] = telemetryPending[teamNr];
+    delete telemetryPending[teamNr];
+  });
+  
+  telemetrySending = true;
+  Pebble.sendAppMessage({"SCBA_MSG_KEY_TELEMETRY": message},
+    function(e) {
+      telemetrySending = false;
+      Object.keys(batch).forEach(function(teamNr) {
+        telemetrySent[teamNr] = batch[teamNr];
+      });
+    },
+    function(e) {
+      // put back what no newer reading replaced, the next batch tries again
+      console.log("Telemetry message to watch failed");
+      telemetrySending = false;
+      Object.keys(batch).forEach(function(teamNr) {
+        if (!telemetryPending[teamNr]) {
+          telemetryPending[teamNr] = batch[teamNr];
+        }
+      });
+    }
+  );
+}
+
+Pebble.addEventListener("ready",
+  function(e) {
+    var settings = JSON.parse(localStorage.getItem("scba_settings") || "null");
+    connectTelemetrySource(settings ? settings.telemetry_url : null);
+  }
+);
+
+Pebble.addEventListener("webviewclosed",
+  function(e) {
+    if (!e.response) {
+      return;
+    }
+    connectTelemetrySource(JSON.parse(decodeURIComponent(e.response)).telemetry_url);
+  }
+);
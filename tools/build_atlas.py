@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+#
+# Packs the frequently drawn SCBA icons into one atlas image so the app only
+# has to decode a single resource at launch and can hand out sub-bitmaps.
+#
+# Usage: python tools/build_atlas.py   (run from the project root)
+#
+# Writes resources/images/scba_icons.png, resources/images/scba_icons~color.png
+# and src/scba_icons.h. Re-run it whenever one of the source images changes.
+#
+
+import os
+import struct
+import zlib
+
+IMAGE_DIR = os.path.join('resources', 'images')
+ATLAS_NAME = 'scba_icons'
+HEADER_FILE = os.path.join('src', 'scba_icons.h')
+MAX_ATLAS_WIDTH = 144
+
+# icons that are shown right after launch; config screen and mayday images
+# stay separate resources and are loaded on first use
+ATLAS_ICONS = [
+    'active_scba',
+    'arrow_up',
+    'arrow_down',
+    'ok_btn',
+    'small_scba_firefighter',
+    'small_exclamation_mark',
+    'small_full_bottle',
+    'small_third_full_bottle',
+    'small_half_full_bottle',
+    'small_third_empty_bottle',
+    'small_empty_bottle',
+]
+
+
+def read_png(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s is not a png file' % path)
+
+    pos = 8
+    idat = b''
+    while pos < len(data):
+        length, chunk = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if chunk == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', body)
+            if depth != 8 or color != 6 or interlace != 0:
+                raise ValueError('%s must be 8 bit RGBA, non-interlaced' % path)
+        elif chunk == b'IDAT':
+            idat += body
+        pos += 12 + length
+
+    raw = zlib.decompress(idat)
+    stride = width * 4
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        offset = y * (stride + 1)
+        filter_type = raw[offset]
+        line = bytearray(raw[offset + 1:offset + 1 + stride])
+        for x in range(stride):
+            a = line[x - 4] if x >= 4 else 0
+            b = prev[x]
+            c = prev[x - 4] if x >= 4 else 0
+            if filter_type == 1:
+                line[x] = (line[x] + a) & 0xFF
+            elif filter_type == 2:
+                line[x] = (line[x] + b) & 0xFF
+            elif filter_type == 3:
+                line[x] = (line[x] + ((a + b) >> 1)) & 0xFF
+            elif filter_type == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if (pa <= pb and pa <= pc) else (b if pb <= pc else c)
+                line[x] = (line[x] + pred) & 0xFF
+        rows.append(line)
+        prev = line
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    def chunk(name, body):
+        crc = zlib.crc32(name + body) & 0xFFFFFFFF
+        return struct.pack('>I', len(body)) + name + body + struct.pack('>I', crc)
+
+    if len(rows) != height or any(len(row) != width * 4 for row in rows):
+        raise ValueError('%s: rows do not match the %dx%d header' % (path, width, height))
+    raw = b''.join(b'\x00' + bytes(row) for row in rows)
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def source_path(name, color):
+    if color:
+        color_path = os.path.join(IMAGE_DIR, name + '~color.png')
+        if os.path.exists(color_path):
+            return color_path
+    return os.path.join(IMAGE_DIR, name + '.png')
+
+
+def pack(sizes, atlas_width):
+    # simple shelf packing, tallest icons first
+    order = sorted(sizes, key=lambda n: (-sizes[n][1], -sizes[n][0], n))
+    rects = {}
+    x = y = shelf = 0
+    for name in order:
+        w, h = sizes[name]
+        if x + w > atlas_width:
+            x = 0
+            y += shelf
+            shelf = 0
+        rects[name] = (x, y, w, h)
+        x += w
+        shelf = max(shelf, h)
+    return rects, y + shelf
+
+
+def smallest_packing(sizes):
+    # try every atlas width and keep the one with the least wasted pixels
+    widest = max(w for w, _ in sizes.values())
+    best = None
+    for atlas_width in range(widest, MAX_ATLAS_WIDTH + 1):
+        rects, height = pack(sizes, atlas_width)
+        used_width = max(x + w for x, _, w, _ in rects.values())
+        if best is None or used_width * height < best[1] * best[2]:
+            best = (rects, used_width, height)
+    return best
+
+
+def build_atlas(rects, width, height, color):
+    rows = [bytearray(width * 4) for _ in range(height)]
+    for name, (x, y, w, h) in rects.items():
+        src_width, _, src = read_png(source_path(name, color))
+        for row in range(h):
+            rows[y + row][x * 4:(x + w) * 4] = src[row][:src_width * 4]
+    suffix = '~color' if color else ''
+    path = os.path.join(IMAGE_DIR, ATLAS_NAME + suffix + '.png')
+    write_png(path, width, height, rows)
+
+    # the atlas read back has to have the packed size, and so the rects
+    # of the header have to lie inside it
+    check_width, check_height, _ = read_png(path)
+    if (check_width, check_height) != (width, height):
+        raise ValueError('%s is %dx%d, packed %dx%d' % (path, check_width, check_height, width, height))
+    for name, (x, y, w, h) in rects.items():
+        if x + w > width or y + h > height:
+            raise ValueError('%s lies outside of the %dx%d atlas' % (name, width, height))
+
+
+def write_header(rects):
+    with open(HEADER_FILE, 'w') as f:
+        f.write('//* --------------------------------------------------- *//\n')
+        f.write('//  Generated by tools/build_atlas.py - do not edit.     //\n')
+        f.write('//  Sub-bitmap rectangles inside RESOURCE_ID_SCBA_ICONS  //\n')
+        f.write('//* --------------------------------------------------- *//\n')
+        f.write('#ifndef __SCBA_ICONS__\n#define __SCBA_ICONS__\n\n')
+        for name in ATLAS_ICONS:
+            x, y, w, h = rects[name]
+            f.write('#define ICON_RECT_%s GRect(%d,%d,%d,%d)\n' % (name.upper(), x, y, w, h))
+        f.write('\n#endif\n')
+
+
+def main():
+    sizes = {}
+    for name in ATLAS_ICONS:
+        w, h, _ = read_png(source_path(name, False))
+        cw, ch, _ = read_png(source_path(name, True))
+        if (w, h) != (cw, ch):
+            raise ValueError('%s: color variant has a different size' % name)
+        sizes[name] = (w, h)
+
+    rects, width, height = smallest_packing(sizes)
+    build_atlas(rects, width, height, False)
+    build_atlas(rects, width, height, True)
+    write_header(rects)
+    print('atlas %dx%d with %d icons' % (width, height, len(rects)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,110 @@
+#!/usr/bin/env python
+#
+# Estimates the battery cost per hour of incident from the event trace of
+# one app run and prints it broken down by source.
+#
+# Usage: python tools/energy_report.py [--platform basalt] [--from-launch] [log]
+#        (log is the output of "pebble logs" of a build with SCBA_TRACE
+#        defined in src/main.h, stdin if missing)
+#
+# The app logs its cumulative counters once a minute as
+#
+#   trace t=<seconds since launch> tick=<n> repeat_timer=<n> ...
+#
+# By default the difference between the first and the last of these lines
+# is used, so the launch itself is left out. --from-launch counts from zero.
+# Each event is weighted with its charge from tools/energy_costs.json, the
+# *_bytes events per byte and light_seconds per second the backlight is on.
+# The costs are estimates, tune them there.
+#
+
+import json
+import os
+import re
+import sys
+
+COSTS_FILE = os.path.join('tools', 'energy_costs.json')
+TRACE_LINE = re.compile(r'trace t=(\d+)((?: \w+=\d+)*)')
+
+
+def read_traces(lines):
+    traces = []
+    for line in lines:
+        match = TRACE_LINE.search(line)
+        if match:
+            counts = dict((key, int(value)) for key, value in re.findall(r'(\w+)=(\d+)', match.group(2)))
+            traces.append((int(match.group(1)), counts))
+    return traces
+
+
+def trace_delta(traces, from_launch):
+    seconds, last = traces[-1]
+    if from_launch or len(traces) < 2:
+        return seconds, last
+    start, first = traces[0]
+    return seconds - start, dict((key, last[key] - first.get(key, 0)) for key in last)
+
+
+def estimate(seconds, counts, costs):
+    # charge in uAs per source, the baseline runs the whole time
+    rows = [('baseline', None, costs['baseline_ua'] * seconds)]
+    for key in sorted(counts):
+        if key not in costs:
+            sys.stderr.write('no cost for %s, ignored\n' % key)
+            continue
+        rows.append((key, counts[key], counts[key] * costs[key]))
+    return rows
+
+
+def report(platform, seconds, rows, costs, out):
+    hour = 3600.0 / seconds
+    total = sum(charge for _, _, charge in rows)
+
+    out.append('== %s, %d s traced, per hour of incident ==' % (platform, seconds))
+    out.append('%-16s %12s %10s %8s' % ('source', 'events/h', 'mAh/h', 'share'))
+    for name, count, charge in sorted(rows, key=lambda r: -r[2]):
+        events = '-' if count is None else '%.0f' % (count * hour)
+        share = 100.0 * charge / total if total else 0.0
+        out.append('%-16s %12s %10.3f %7.1f%%' % (name, events, charge * hour / 3.6e6, share))
+    per_hour = total * hour / 3.6e6
+    out.append('%-16s %12s %10.3f' % ('total', '', per_hour))
+    out.append('%.1f%% of the %d mAh battery per hour, empty after %.0f h' %
+               (100.0 * per_hour / costs['battery_mah'], costs['battery_mah'], costs['battery_mah'] / per_hour))
+
+
+def main(argv):
+    platform = 'basalt'
+    from_launch = '--from-launch' in argv
+    paths = [arg for arg in argv if not arg.startswith('--')]
+    if '--platform' in argv:
+        platform = argv[argv.index('--platform') + 1]
+        paths.remove(platform)
+
+    with open(COSTS_FILE) as f:
+        costs = json.load(f)
+    if platform not in costs:
+        sys.stderr.write('no costs for platform %s\n' % platform)
+        return 1
+
+    if paths:
+        with open(paths[0]) as f:
+            traces = read_traces(f)
+    else:
+        traces = read_traces(sys.stdin)
+    if not traces:
+        sys.stderr.write('no trace lines found, was the app built with SCBA_TRACE?\n')
+        return 1
+
+    seconds, counts = trace_delta(traces, from_launch)
+    if seconds <= 0:
+        sys.stderr.write('the trace covers no time\n')
+        return 1
+
+    out = []
+    report(platform, seconds, estimate(seconds, counts, costs[platform]), costs[platform], out)
+    sys.stdout.write('\n'.join(out) + '\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,204 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Decodes a handover snapshot on the host. A scanner app hands over the
+//  raw bytes of the QR code, given here in hex, and the teams are printed
+//  as the receiving watch would rebuild them.
+//
+//  With --roundtrip random snapshots go through scba_snapshot.c, the QR
+//  encoder of the watch and the module reader of scba_qr.c, and every
+//  field is compared. The first code is printed, so it can be scanned
+//  from the terminal.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -Wall -DSCBA_HOST_BUILD -Isrc -o build/host/handover_decode tools/handover_decode.c src/scba_snapshot.c src/scba_qr.c
+//    ./build/host/handover_decode <hex bytes>
+//    ./build/host/handover_decode --roundtrip [count]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scba_snapshot.h"
+#include "scba_qr.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define QUIET_ZONE 4
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+static void print_age(const char *name, time_t now, time_t then)
+{
+  long age = (long)(now - then);
+
+  printf(" %s -%ld:%02ld:%02ld", name, age / 3600, (age / 60) % 60, age % 60);
+}
+
+/**
+*
+*/
+static void print_snapshot(const scba_snapshot_t *snapshot)
+{
+  uint8_t i = 0;
+
+  printf("snapshot at %ld, %d teams\n", (long)snapshot->time, snapshot->count);
+  for(i=0; i<snapshot->count; i++)
+  {
+    printf("slot %d team %2d bottle %d status %2d %3d bar %5d dl", snapshot->teams[i].slot, snapshot->teams[i].team_nr,
+           snapshot->teams[i].bottle_type, snapshot->teams[i].status, snapshot->teams[i].pressure, snapshot->teams[i].air_volume);
+    print_age("started", snapshot->time, snapshot->teams[i].start_time);
+    print_age("report", snapshot->time, snapshot->teams[i].report_time);
+    printf("\n");
+  }
+}
+
+/**
+* Two characters per module, dark on a light terminal.
+*/
+static void print_qr(const scba_qr_t *qr)
+{
+  int x = 0;
+  int y = 0;
+
+  for(y=-QUIET_ZONE; y<SCBA_QR_SIZE+QUIET_ZONE; y++)
+  {
+    for(x=-QUIET_ZONE; x<SCBA_QR_SIZE+QUIET_ZONE; x++)
+    {
+      if((x >= 0) && (x < SCBA_QR_SIZE) && (y >= 0) && (y < SCBA_QR_SIZE) && (scba_qr_module(qr, x, y) == true))
+      {
+        printf("##");
+      }
+      else
+      {
+        printf("  ");
+      }
+    }
+    printf("\n");
+  }
+}
+
+/**
+*
+*/
+static int decode_hex(const char *hex)
+{
+  uint8_t buffer[SCBA_SNAPSHOT_MAX_SIZE];
+  scba_snapshot_t snapshot;
+  unsigned int value = 0;
+  uint8_t length = 0;
+
+  while((*hex != '\0') && (length < sizeof(buffer)))
+  {
+    if(sscanf(hex, "%2x", &value) != 1)
+    {
+      break;
+    }
+    buffer[length++] = value;
+    hex += 2;
+  }
+  if((*hex != '\0') || (scba_snapshot_decode(buffer, length, &snapshot) == false))
+  {
+    fprintf(stderr, "not a handover snapshot\n");
+    return (1);
+  }
+  print_snapshot(&snapshot);
+  return (0);
+}
+
+/**
+*
+*/
+static void random_snapshot(scba_snapshot_t *snapshot)
+{
+  uint8_t i = 0;
+
+  memset(snapshot, 0, sizeof(scba_snapshot_t));
+  snapshot->time = 1500000000 + (rand() % 100000000);
+  snapshot->count = rand() % (SCBA_SNAPSHOT_TEAMS + 1);
+  for(i=0; i<snapshot->count; i++)
+  {
+    snapshot->teams[i].slot = i;
+    snapshot->teams[i].team_nr = 1 + (rand() % 10);
+    snapshot->teams[i].bottle_type = rand() % 8;
+    snapshot->teams[i].status = 1 + (rand() % 11);
+    snapshot->teams[i].start_time = snapshot->time - (rand() % 20000);
+    snapshot->teams[i].report_time = snapshot->teams[i].start_time + (rand() % (snapshot->time - snapshot->teams[i].start_time + 1));
+    snapshot->teams[i].pressure = rand() % 331;
+    snapshot->teams[i].air_volume = snapshot->teams[i].pressure * (60 + (rand() % 30));
+  }
+}
+
+/**
+*
+*/
+static int roundtrip(long count)
+{
+  uint8_t buffer[SCBA_SNAPSHOT_MAX_SIZE];
+  uint8_t scanned[SCBA_QR_MAX_PAYLOAD];
+  scba_snapshot_t snapshot;
+  scba_snapshot_t rebuilt;
+  scba_qr_t qr;
+  clock_t ticks = 0;
+  clock_t start = 0;
+  uint8_t length = 0;
+  long failures = 0;
+  long n = 0;
+
+  srand(1);
+  for(n=0; n<count; n++)
+  {
+    random_snapshot(&snapshot);
+    length = scba_snapshot_encode(&snapshot, buffer, sizeof(buffer));
+    start = clock();
+    scba_qr_encode(&qr, buffer, length);
+    ticks += clock() - start;
+
+    memset(&rebuilt, 0, sizeof(rebuilt));
+    if((scba_qr_decode(&qr, scanned, sizeof(scanned)) != length) || (memcmp(scanned, buffer, length) != 0) ||
+       (scba_snapshot_decode(scanned, length, &rebuilt) == false) || (memcmp(&rebuilt, &snapshot, sizeof(rebuilt)) != 0))
+    {
+      failures++;
+      print_snapshot(&snapshot);
+    }
+    if(n == 0)
+    {
+      print_qr(&qr);
+      print_snapshot(&snapshot);
+    }
+  }
+  printf("%ld snapshots, %ld failures, %.1f us per code, %d bytes of state\n", count, failures,
+         (1e6 * ticks) / CLOCKS_PER_SEC / ((count > 0) ? count : 1), (int)sizeof(scba_qr_t));
+  return ((failures == 0) ? 0 : 1);
+}
+
+/**
+*
+*/
+int main(int argc, char **argv)
+{
+  if((argc > 1) && (strcmp(argv[1], "--roundtrip") == 0))
+  {
+    return (roundtrip((argc > 2) ? atol(argv[2]) : 1000));
+  }
+  if(argc == 2)
+  {
+    return (decode_hex(argv[1]));
+  }
+  fprintf(stderr, "usage: %s <hex bytes> | --roundtrip [count]\n", argv[0]);
+  return (1);
+}
@@ -0,0 +1,121 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Runs one team through the rules of scba_model.c on the host, second by
+//  second, until the bottle is below the empty pressure, and prints every
+//  change of the pressure level, every alarm and the mayday. Alarms are
+//  acknowledged after a delay, like the commander pressing select.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -Wall -Isrc -o build/host/model_timeline tools/model_timeline.c src/scba_model.c src/scba_bottles.c
+//    ./build/host/model_timeline [bottle type] [rate in l/min] [ack delay in s]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scba_model.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define MAX_SECONDS (4 * 3600)
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+static const char* const level_names[SCBA_LEVELS] = {
+  "full", "third full", "half full", "third empty", "return", "mayday"
+};
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+int main(int argc, char **argv)
+{
+  uint8_t type = (argc > 1) ? (uint8_t)atoi(argv[1]) : 0;
+  uint16_t rate = (argc > 2) ? (uint16_t)(atoi(argv[2]) * 10) : 500;
+  long ack_delay = (argc > 3) ? atol(argv[3]) : 10;
+  const scba_bottle_t *bottle = NULL;
+  const scba_pressure_levels_t *levels = NULL;
+  scba_team_t team;
+  time_t end_time = 0;
+  long alarm_since = -1;
+  long second = 0;
+  uint16_t seconds = 0;
+  uint8_t level = SCBA_LEVEL_FULL;
+  uint8_t last_level = SCBA_LEVELS;
+  uint8_t events = 0;
+
+  if((scba_bottles_load(scba_default_bottle_catalog, SCBA_DEFAULT_BOTTLE_TYPES, 0xFF) == false) ||
+     (type >= scba_bottle_type_count) || (rate == 0))
+  {
+    fprintf(stderr, "usage: %s [bottle type 0-%d] [rate in l/min] [ack delay in s]\n", argv[0], scba_bottle_type_count - 1);
+    return (1);
+  }
+  bottle = &scba_bottle_types[type];
+  levels = &bottle->levels[SCBA_UNIT_BAR];
+
+  memset(&team, 0, sizeof(team));
+  team.scba_team_nr = 1;
+  team.scba_team_bottle_type = type;
+  team.scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
+  team.scba_team_bottle_pressure = levels->full_pressure;
+  team.scba_team_bottle_air_volume = scba_model_air_volume(&team, bottle, SCBA_UNIT_BAR);
+
+  scba_model_end_time(&team, bottle, SCBA_UNIT_BAR, rate, 0, &end_time);
+  printf("bottle %s, %d bar, %d l/min, predicted end after %ld min\n",
+         bottle->bottle_name, levels->full_pressure, rate / 10, (long)end_time / 60);
+  printf("%-8s %-8s %-12s %s\n", "time", "bar", "level", "event");
+
+  for(second=0; second<MAX_SECONDS; second++)
+  {
+    seconds++;
+    if(scba_model_breathe(&team, &seconds, rate) == true)
+    {
+      team.scba_team_bottle_pressure = scba_model_pressure(&team, bottle, SCBA_UNIT_BAR);
+    }
+    level = scba_model_level(team.scba_team_bottle_pressure, levels);
+    events = scba_model_evaluate(&team, levels);
+
+    if(level != last_level)
+    {
+      printf("%3ld:%02ld   %-8d %-12s %s\n", second / 60, second % 60, team.scba_team_bottle_pressure, level_names[level],
+             ((events & SCBA_MODEL_EVENT_ALARM) != 0) ? "alarm" : (((events & SCBA_MODEL_EVENT_MAYDAY) != 0) ? "mayday" : ""));
+      last_level = level;
+    }
+    if((events & SCBA_MODEL_EVENT_MAYDAY) != 0)
+    {
+      return (0);
+    }
+
+    if((events & SCBA_MODEL_EVENT_ALARM) == 0)
+    {
+      alarm_since = -1;
+    }
+    else if(alarm_since < 0)
+    {
+      alarm_since = second;
+    }
+    else if((second - alarm_since) >= ack_delay)
+    {
+      team.scba_team_status = scba_model_confirmed_status(team.scba_team_status);
+      printf("%3ld:%02ld   %-8d %-12s acknowledged\n", second / 60, second % 60, team.scba_team_bottle_pressure, level_names[level]);
+      alarm_since = -1;
+    }
+  }
+  printf("no mayday after %d s\n", MAX_SECONDS);
+  return (1);
+}
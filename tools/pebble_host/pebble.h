@@ -0,0 +1,390 @@
+//* ----------- include paths ---------- *//
+//                                        //
+//* ------------------------------------ *//
+// Host stand-in for the parts of the Pebble SDK 3 API the app uses, see
+// pebble_host.c. Build the app with -Itools/pebble_host instead of the SDK
+// and -DPBL_PLATFORM_APLITE or -DPBL_PLATFORM_BASALT.
+#ifndef __PEBBLE_HOST__
+#define __PEBBLE_HOST__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#if !defined(PBL_PLATFORM_APLITE) && !defined(PBL_PLATFORM_BASALT)
+#define PBL_PLATFORM_APLITE
+#endif
+#if defined(PBL_PLATFORM_BASALT) && !defined(PBL_COLOR)
+#define PBL_COLOR
+#endif
+#ifndef PBL_COLOR
+#define PBL_BW
+#endif
+
+#define PEBBLE_HOST_SCREEN_WIDTH 144
+#define PEBBLE_HOST_SCREEN_HEIGHT 168
+#define ACTION_BAR_WIDTH 30
+#define PERSIST_DATA_MAX_LENGTH 256
+#define PERSIST_STRING_MAX_LENGTH PERSIST_DATA_MAX_LENGTH
+#define ARRAY_LENGTH(array) (sizeof((array))/sizeof((array)[0]))
+
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRectZero GRect(0, 0, 0, 0)
+
+#define GColorClearARGB8 0x00
+#define GColorBlackARGB8 0xC0
+#define GColorRedARGB8 0xF0
+#define GColorWhiteARGB8 0xFF
+#define GColorClear ((GColor8){.argb=GColorClearARGB8})
+#define GColorBlack ((GColor8){.argb=GColorBlackARGB8})
+#define GColorRed ((GColor8){.argb=GColorRedARGB8})
+#define GColorWhite ((GColor8){.argb=GColorWhiteARGB8})
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24 "RESOURCE_ID_GOTHIC_24"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+
+// resource ids in the order of appinfo.json, as the SDK numbers them
+#define RESOURCE_ID_SCBA_ICONS 1
+#define RESOURCE_ID_MENU_IMAGE 2
+#define RESOURCE_ID_FULL_BOTTLE 3
+#define RESOURCE_ID_SCBA_FIREFIGHTER 4
+#define RESOURCE_ID_SMALL_STOP_SIGNE 5
+
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO 100
+#define APP_LOG_LEVEL_DEBUG 200
+#define APP_LOG_LEVEL_DEBUG_VERBOSE 255
+#define APP_LOG(level, fmt, args...) app_log((level), __FILE__, __LINE__, (fmt), ## args)
+
+#define E_DOES_NOT_EXIST (-4)
+#define E_RANGE (-5)
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  int16_t x;
+  int16_t y;
+}GPoint;
+
+typedef struct
+{
+  int16_t w;
+  int16_t h;
+}GSize;
+
+typedef struct
+{
+  GPoint origin;
+  GSize size;
+}GRect;
+
+typedef union
+{
+  uint8_t argb;
+  struct
+  {
+    uint8_t b:2;
+    uint8_t g:2;
+    uint8_t r:2;
+    uint8_t a:2;
+  };
+}GColor8;
+typedef GColor8 GColor;
+
+typedef enum
+{
+  GTextAlignmentLeft,
+  GTextAlignmentCenter,
+  GTextAlignmentRight
+}GTextAlignment;
+
+typedef enum
+{
+  GTextOverflowModeWordWrap,
+  GTextOverflowModeTrailingEllipsis,
+  GTextOverflowModeFill
+}GTextOverflowMode;
+
+typedef enum
+{
+  GCornerNone = 0,
+  GCornersAll = 0x0F
+}GCornerMask;
+
+typedef enum
+{
+  BUTTON_ID_BACK = 0,
+  BUTTON_ID_UP,
+  BUTTON_ID_SELECT,
+  BUTTON_ID_DOWN,
+  NUM_BUTTONS
+}ButtonId;
+
+typedef enum
+{
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5
+}TimeUnits;
+
+typedef enum
+{
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_INVALID_ARGS = 1 << 12
+}AppMessageResult;
+
+typedef enum
+{
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2
+}DictionaryResult;
+
+typedef enum
+{
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3
+}TupleType;
+
+typedef union
+{
+  uint8_t data[0];
+  char cstring[0];
+  uint8_t uint8;
+  uint16_t uint16;
+  uint32_t uint32;
+  int8_t int8;
+  int16_t int16;
+  int32_t int32;
+}__attribute__((__packed__)) TupleValue;
+
+typedef struct
+{
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  TupleValue value[];
+}__attribute__((__packed__)) Tuple;
+
+typedef struct Window Window;
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct BitmapLayer BitmapLayer;
+typedef struct ActionBarLayer ActionBarLayer;
+typedef struct GBitmap GBitmap;
+typedef struct GContext GContext;
+typedef struct AppTimer AppTimer;
+typedef struct DictionaryIterator DictionaryIterator;
+typedef struct FontInfo *GFont;
+typedef void *ClickRecognizerRef;
+
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+typedef void (*WindowHandler)(Window *window);
+typedef void (*ClickHandler)(ClickRecognizerRef recognizer, void *context);
+typedef void (*ClickConfigProvider)(void *context);
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+typedef void (*AppTimerCallback)(void *data);
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+typedef struct
+{
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+}WindowHandlers;
+
+// what one frame of the host renderer cost, see pebble_host_set_frame_listener()
+typedef struct
+{
+  uint32_t number;
+  uint64_t time_ms;          // of the simulated clock
+  const char *cause;         // launch, tick, timer, sent, click or message
+  uint16_t layers;           // visited, not the hidden ones
+  uint16_t text_draws;
+  uint16_t bitmap_draws;
+  uint16_t other_draws;      // pixels, lines, rects and fills
+  uint32_t pixels_touched;   // written, a pixel drawn over again counts again
+  uint32_t pixels_dirty;     // of the layers the app marked dirty since the last frame
+  uint32_t pixels_changed;   // differ from the frame before
+  GRect changed;             // bounding box of the changed pixels
+}pebble_host_frame_t;
+
+typedef void (*PebbleHostFrameListener)(const pebble_host_frame_t *frame);
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+// everything that takes app heap records where it was created, so a leak
+// is reported with the line that made the object
+#define window_create() pebble_host_window_create(__FILE__, __LINE__)
+#define layer_create(frame) pebble_host_layer_create((frame), __FILE__, __LINE__)
+#define text_layer_create(frame) pebble_host_text_layer_create((frame), __FILE__, __LINE__)
+#define bitmap_layer_create(frame) pebble_host_bitmap_layer_create((frame), __FILE__, __LINE__)
+#define action_bar_layer_create() pebble_host_action_bar_layer_create(__FILE__, __LINE__)
+#define gbitmap_create_with_resource(resource_id) pebble_host_gbitmap_create_with_resource((resource_id), __FILE__, __LINE__)
+#define gbitmap_create_as_sub_bitmap(base, rect) pebble_host_gbitmap_create_as_sub_bitmap((base), (rect), __FILE__, __LINE__)
+
+Window* pebble_host_window_create(const char *file, int line);
+Layer* pebble_host_layer_create(GRect frame, const char *file, int line);
+TextLayer* pebble_host_text_layer_create(GRect frame, const char *file, int line);
+BitmapLayer* pebble_host_bitmap_layer_create(GRect frame, const char *file, int line);
+ActionBarLayer* pebble_host_action_bar_layer_create(const char *file, int line);
+GBitmap* pebble_host_gbitmap_create_with_resource(uint32_t resource_id, const char *file, int line);
+GBitmap* pebble_host_gbitmap_create_as_sub_bitmap(const GBitmap *base, GRect rect, const char *file, int line);
+
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_fullscreen(Window *window, bool enabled);
+void window_set_background_color(Window *window, GColor color);
+void window_set_click_config_provider(Window *window, ClickConfigProvider provider);
+Layer* window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+Window* window_stack_pop(bool animated);
+void window_single_click_subscribe(ButtonId button, ClickHandler handler);
+void window_long_click_subscribe(ButtonId button, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler);
+
+void layer_destroy(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_mark_dirty(Layer *layer);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_frame(const Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+
+void text_layer_destroy(TextLayer *text_layer);
+Layer* text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment alignment);
+
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer);
+Layer* bitmap_layer_get_layer(const BitmapLayer *bitmap_layer);
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap);
+
+void action_bar_layer_destroy(ActionBarLayer *action_bar);
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, Window *window);
+void action_bar_layer_remove_from_window(ActionBarLayer *action_bar);
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider provider);
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button, const GBitmap *icon);
+void action_bar_layer_set_background_color(ActionBarLayer *action_bar, GColor color);
+
+void gbitmap_destroy(GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+GFont fonts_get_system_font(const char *font_key);
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+void graphics_draw_pixel(GContext *ctx, GPoint point);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_draw_rect(GContext *ctx, GRect rect);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode,
+                        GTextAlignment alignment, void *text_attributes);
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *data);
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_deregister_callbacks(void);
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+void app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+void app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+uint32_t app_message_inbox_size_maximum(void);
+uint32_t app_message_outbox_size_maximum(void);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size);
+Tuple* dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_delete(const uint32_t key);
+
+void vibes_short_pulse(void);
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+void light_enable_interaction(void);
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+  __attribute__((format(printf, 4, 5)));
+void app_event_loop(void);
+
+//* --------- host harness API --------- *//
+//                                        //
+//* ------------------------------------ *//
+// the app's main() becomes pebble_app_main(), the harness has its own
+#ifndef PEBBLE_HOST_HARNESS
+#define main pebble_app_main
+#endif
+int pebble_app_main(void);
+
+void pebble_host_init(void);
+void pebble_host_set_event_loop(void (*event_loop)(void));
+void pebble_host_set_log_level(uint8_t log_level);
+void pebble_host_set_time(time_t now);
+time_t pebble_host_time(time_t *tloc);
+void pebble_host_advance(uint32_t ms);
+void pebble_host_click(ButtonId button);
+void pebble_host_long_click(ButtonId button, uint32_t hold_ms);
+void pebble_host_receive(uint32_t key, const uint8_t *data, uint16_t length);
+uint32_t pebble_host_outbox_count(void);
+void pebble_host_reset_heap_peak(void);
+size_t pebble_host_heap_peak(void);
+uint32_t pebble_host_report_leaks(FILE *out);
+uint32_t pebble_host_errors(void);
+uint32_t pebble_host_pending_timers(void);
+void pebble_host_set_frame_listener(PebbleHostFrameListener listener);
+bool pebble_host_write_frame(const char *path);
+
+// the watch has no clock of its own on the host, the app reads the
+// simulated one
+#define time(tloc) pebble_host_time(tloc)
+
+#endif
@@ -0,0 +1,2580 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Host stand-in for the Pebble SDK, enough to run src/main.c unchanged
+//  on a PC: windows and the layer tree, text, bitmap and action bar layers,
+//  clicks, a simulated clock with tick service and app timers, AppMessage
+//  in both directions and the persistent storage.
+//
+//  Every object the app takes from its heap is tracked with the file and
+//  line that created it and counted with the sizes tools/size_report.py
+//  estimates, so a harness can report leaks by allocation site and watch
+//  the heap over a long run. Destroying what was never created or drawing
+//  a destroyed bitmap counts as an error.
+//
+//  The storage lives in shared memory created by pebble_host_init(), a
+//  harness that forks a process per app launch keeps it across launches
+//  like the watch does.
+//
+//  Frames are drawn into a framebuffer of the screen, 1 bit per pixel on
+//  aplite and GColor8 on basalt, whenever the firmware would: the whole
+//  layer tree of the top window after every event that marked a layer
+//  dirty. Text is set in a 5x7 font scaled to the size of the system
+//  font, a bitmap is a hatched box of its size, the PNGs are not decoded.
+//  Every frame counts the layers visited, the draw calls and the pixels
+//  written, dirty and changed for a listener of the harness.
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdarg.h>
+#include <sys/mman.h>
+#include "pebble.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// object sizes as estimated by tools/size_report.py
+#define HEAP_HEADER 8
+#define HEAP_WINDOW 120
+#define HEAP_LAYER 48
+#define HEAP_TEXT_LAYER 96
+#define HEAP_BITMAP_LAYER 64
+#define HEAP_ACTION_BAR_LAYER 200
+#define HEAP_GBITMAP 24
+
+// app heap after the static data, tools/size_budget.json
+#ifdef PBL_PLATFORM_APLITE
+#define HEAP_SIZE (24576 - 16384)
+#define RESOURCE_SUFFIXES {"~aplite", "~bw", ""}
+#define FRAME_ROW_BYTES 20       // 1 bit per pixel, the first pixel in the lowest bit, rows padded to 32 bit
+#else
+#define HEAP_SIZE (65536 - 32768)
+#define RESOURCE_SUFFIXES {"~basalt", "~color", ""}
+#define FRAME_ROW_BYTES PEBBLE_HOST_SCREEN_WIDTH  // one GColor8 per pixel
+#endif
+#define FRAME_SIZE (FRAME_ROW_BYTES * PEBBLE_HOST_SCREEN_HEIGHT)
+#define SCREEN_PIXELS (PEBBLE_HOST_SCREEN_WIDTH * PEBBLE_HOST_SCREEN_HEIGHT)
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+
+#define PERSIST_KEYS 64
+#define PERSIST_TOTAL_SIZE 4096
+#define MESSAGE_DELAY 100        // in ms from outbox_send() until the phone acknowledged it
+#define MAX_WINDOWS 4
+#define MAX_EVENTS_PER_STEP 1000 // timers registered again and again at 0 ms
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct host_allocation
+{
+  const void *object;
+  const char *kind;
+  size_t size;
+  const char *file;
+  int line;
+  bool system;           // owned by the firmware, not a leak of the app
+  struct host_allocation *next;
+}host_allocation_t;
+
+struct Layer
+{
+  GRect frame;
+  GRect bounds;
+  bool hidden;
+  Layer *parent;
+  Layer *first_child;
+  Layer *next_sibling;
+  LayerUpdateProc update_proc;
+};
+
+struct TextLayer
+{
+  Layer layer;
+  const char *text;
+  GFont font;
+  GColor text_color;
+  GColor background_color;
+  GTextAlignment alignment;
+};
+
+struct BitmapLayer
+{
+  Layer layer;
+  const GBitmap *bitmap;
+};
+
+struct ActionBarLayer
+{
+  Layer layer;
+  Window *window;
+  const GBitmap *icons[NUM_BUTTONS];
+  GColor background_color;
+};
+
+typedef struct
+{
+  ClickHandler single;
+  ClickHandler long_down;
+  ClickHandler long_up;
+  uint16_t delay_ms;
+}host_click_t;
+
+struct Window
+{
+  Layer root_layer;
+  WindowHandlers handlers;
+  ClickConfigProvider click_config_provider;
+  host_click_t clicks[NUM_BUTTONS];
+  GColor background_color;
+  bool loaded;
+};
+
+struct GBitmap
+{
+  GRect bounds;
+  const GBitmap *parent;
+  uint32_t resource_id;
+};
+
+struct GContext
+{
+  GColor stroke_color;
+  GColor fill_color;
+  GColor text_color;
+  GPoint offset;     // of the layer drawn, in screen coordinates
+  GRect clip;        // in screen coordinates
+};
+
+struct FontInfo
+{
+  const char *key;
+  uint8_t height;    // of a line
+  bool bold;
+};
+
+struct AppTimer
+{
+  uint64_t due_ms;
+  AppTimerCallback callback;
+  void *data;
+  AppTimer *next;
+};
+
+struct DictionaryIterator
+{
+  uint8_t *buffer;
+  uint32_t size;
+  uint32_t used;
+};
+
+typedef struct
+{
+  uint32_t key;
+  int16_t length;    // -1: free
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+}host_persist_entry_t;
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+static host_allocation_t *host_allocations = NULL;
+static size_t host_heap_used = 0;
+static size_t host_heap_peak = 0;
+static uint32_t host_errors = 0;
+static uint8_t host_log_level = APP_LOG_LEVEL_WARNING;
+
+static Window *host_windows[MAX_WINDOWS];
+static uint8_t host_window_count = 0;
+static Window *host_configuring_window = NULL;
+static bool host_dirty = false;
+
+static uint8_t host_frame_buffer[FRAME_SIZE];
+static uint8_t host_previous_frame[FRAME_SIZE];
+static uint8_t host_dirty_area[SCREEN_PIXELS];   // 1 for every pixel of a layer marked dirty
+static uint32_t host_dirty_pixels = 0;
+static pebble_host_frame_t host_frame;
+static PebbleHostFrameListener host_frame_listener = NULL;
+
+static uint64_t host_now_ms = 0;
+static struct tm host_last_tick;
+static TickHandler host_tick_handler = NULL;
+static TimeUnits host_tick_units = 0;
+static AppTimer *host_timers = NULL;
+static void (*host_event_loop)(void) = NULL;
+
+static AppMessageInboxReceived host_inbox_received = NULL;
+static AppMessageOutboxSent host_outbox_sent = NULL;
+static AppMessageOutboxFailed host_outbox_failed = NULL;
+static uint8_t *host_inbox = NULL;
+static uint8_t *host_outbox = NULL;
+static uint32_t host_inbox_size = 0;
+static uint32_t host_outbox_size = 0;
+static DictionaryIterator host_outbox_iterator;
+static bool host_outbox_sending = false;
+static uint64_t host_outbox_due_ms = 0;
+static uint32_t host_outbox_count = 0;
+
+static host_persist_entry_t *host_persist = NULL;
+
+static struct FontInfo host_fonts[] = {
+  {FONT_KEY_GOTHIC_14, 14, false}, {FONT_KEY_GOTHIC_14_BOLD, 14, true}, {FONT_KEY_GOTHIC_18, 18, false},
+  {FONT_KEY_GOTHIC_18_BOLD, 18, true}, {FONT_KEY_GOTHIC_24, 24, false}, {FONT_KEY_GOTHIC_24_BOLD, 24, true},
+  {FONT_KEY_GOTHIC_28_BOLD, 28, true}
+};
+
+// 5x7 glyphs of ' ' to '~', a column per byte with the top row in the lowest bit
+static const uint8_t host_glyphs[][GLYPH_WIDTH] = {
+  {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+  {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x00,0x07,0x00,0x00},
+  {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+  {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+  {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+  {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+  {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+  {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+  {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+  {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+  {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+  {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+  {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+  {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+  {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+  {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+  {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+  {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+  {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+  {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+  {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+  {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+  {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+  {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08}
+};
+
+// by RESOURCE_ID_* - 1
+static const char* const host_resources[] = {
+  "scba_icons", "menu_image", "full_bottle", "scba_firefighter", "small_stop_signe"
+};
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void host_track(const void *object, const char *kind, size_t size, const char *file, int line, bool system);
+static bool host_untrack(const void *object, const char *kind);
+static bool host_tracked(const void *object);
+static void host_error(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void host_layer_init(Layer *layer, GRect frame);
+static void host_layer_deinit(Layer *layer);
+static void host_text_layer_update_proc(Layer *layer, GContext *ctx);
+static void host_bitmap_layer_update_proc(Layer *layer, GContext *ctx);
+static void host_action_bar_update_proc(Layer *layer, GContext *ctx);
+static void host_window_update_proc(Layer *layer, GContext *ctx);
+static Window* host_top_window(void);
+static void host_configure_clicks(Window *window);
+static void host_mark_dirty(const Layer *layer);
+static void host_render(const char *cause);
+static void host_render_layer(Layer *layer, GContext *ctx, GPoint offset, GRect clip);
+static GRect host_intersect(GRect a, GRect b);
+static void host_put_pixel(GContext *ctx, int16_t x, int16_t y, GColor color);
+static void host_set_pixel(int16_t x, int16_t y, GColor color);
+static GColor host_get_pixel(const uint8_t *frame, int16_t x, int16_t y);
+static void host_draw_glyph(GContext *ctx, char c, GFont font, int16_t x, int16_t y);
+static uint16_t host_text_line(const char *text, uint16_t max_chars);
+static void host_compare_frame(void);
+static void host_tick(void);
+static bool host_fire_next_timer(uint64_t until_ms);
+static bool host_read_png_size(uint32_t resource_id, uint16_t *width, uint16_t *height, size_t *bytes);
+static host_persist_entry_t* host_persist_find(uint32_t key);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Sets up the storage shared by all processes forked afterwards and the
+* simulated clock.
+*/
+void pebble_host_init(void)
+{
+  uint8_t i = 0;
+
+  host_persist = mmap(NULL, PERSIST_KEYS * sizeof(host_persist_entry_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(host_persist == MAP_FAILED)
+  {
+    perror("mmap");
+    exit(2);
+  }
+  for(i=0; i<PERSIST_KEYS; i++)
+  {
+    host_persist[i].length = -1;
+  }
+  pebble_host_set_time(1500000000);
+}
+
+/**
+*
+*/
+void pebble_host_set_event_loop(void (*event_loop)(void))
+{
+  host_event_loop = event_loop;
+}
+
+/**
+*
+*/
+void pebble_host_set_log_level(uint8_t log_level)
+{
+  host_log_level = log_level;
+}
+
+/**
+* Only moves the clock, the ticks start again from there.
+*/
+void pebble_host_set_time(time_t now)
+{
+  time_t seconds = now;
+
+  host_now_ms = (uint64_t)now * 1000;
+  host_last_tick = *localtime(&seconds);
+}
+
+/**
+*
+*/
+time_t pebble_host_time(time_t *tloc)
+{
+  time_t now = (time_t)(host_now_ms / 1000);
+
+  if(tloc != NULL)
+  {
+    *tloc = now;
+  }
+  return (now);
+}
+
+/**
+* Runs the watch for ms: ticks, timers and the acknowledgements of the
+* phone in the order they are due, a frame after every event that made a
+* layer dirty.
+*/
+void pebble_host_advance(uint32_t ms)
+{
+  uint64_t end_ms = host_now_ms + ms;
+  uint64_t tick_ms = 0;
+  uint64_t next_ms = 0;
+  uint32_t events = 0;
+  AppTimer *timer = NULL;
+
+  for(;;)
+  {
+    if(host_fire_next_timer(host_now_ms) == true)
+    {
+      // timers of 0 ms run before the clock moves on
+      if(++events > MAX_EVENTS_PER_STEP)
+      {
+        host_error("more than %d timers without time passing", MAX_EVENTS_PER_STEP);
+        return;
+      }
+      host_render("timer");
+      continue;
+    }
+    if((host_outbox_sending == true) && (host_outbox_due_ms <= host_now_ms))
+    {
+      host_outbox_sending = false;
+      host_outbox_count++;
+      if(host_outbox_sent != NULL)
+      {
+        host_outbox_sent(&host_outbox_iterator, NULL);
+      }
+      host_render("sent");
+      continue;
+    }
+    events = 0;
+
+    tick_ms = ((host_now_ms / 1000) + 1) * 1000;
+    next_ms = tick_ms;
+    for(timer=host_timers; timer!=NULL; timer=timer->next)
+    {
+      next_ms = (timer->due_ms < next_ms) ? timer->due_ms : next_ms;
+    }
+    if((host_outbox_sending == true) && (host_outbox_due_ms < next_ms))
+    {
+      next_ms = host_outbox_due_ms;
+    }
+    if(next_ms > end_ms)
+    {
+      host_now_ms = end_ms;
+      return;
+    }
+    host_now_ms = next_ms;
+    if(next_ms == tick_ms)
+    {
+      host_tick();
+      host_render("tick");
+    }
+  }
+}
+
+/**
+*
+*/
+void pebble_host_click(ButtonId button)
+{
+  Window *window = host_top_window();
+
+  if((window != NULL) && (window->clicks[button].single != NULL))
+  {
+    window->clicks[button].single(NULL, NULL);
+    host_render("click");
+  }
+}
+
+/**
+* Holds the button for its long click delay plus hold_ms, the repeat
+* timers of the app run meanwhile.
+*/
+void pebble_host_long_click(ButtonId button, uint32_t hold_ms)
+{
+  Window *window = host_top_window();
+  host_click_t *click = NULL;
+
+  if(window == NULL)
+  {
+    return;
+  }
+  click = &window->clicks[button];
+  if(click->long_down == NULL)
+  {
+    pebble_host_click(button);
+    return;
+  }
+  pebble_host_advance(click->delay_ms);
+  click->long_down(NULL, NULL);
+  host_render("click");
+  pebble_host_advance(hold_ms);
+  if(click->long_up != NULL)
+  {
+    click->long_up(NULL, NULL);
+    host_render("click");
+  }
+}
+
+/**
+* Delivers a message of the phone with one byte array.
+*/
+void pebble_host_receive(uint32_t key, const uint8_t *data, uint16_t length)
+{
+  DictionaryIterator iterator;
+  uint32_t size = dict_calc_buffer_size(1, length);
+  Tuple *tuple = NULL;
+
+  if((host_inbox_received == NULL) || (host_inbox == NULL))
+  {
+    return;
+  }
+  if(size > host_inbox_size)
+  {
+    // the phone gets APP_MSG_BUFFER_OVERFLOW, the app sees nothing
+    host_error("message key %u of %u bytes does not fit the inbox of %u bytes", (unsigned)key, (unsigned)size, (unsigned)host_inbox_size);
+    return;
+  }
+  host_inbox[0] = 1;
+  tuple = (Tuple *)&host_inbox[1];
+  tuple->key = key;
+  tuple->type = TUPLE_BYTE_ARRAY;
+  tuple->length = length;
+  memcpy(tuple->value->data, data, length);
+  iterator.buffer = host_inbox;
+  iterator.size = size;
+  iterator.used = size;
+  host_inbox_received(&iterator, NULL);
+  host_render("message");
+}
+
+/**
+*
+*/
+uint32_t pebble_host_outbox_count(void)
+{
+  return (host_outbox_count);
+}
+
+/**
+*
+*/
+void pebble_host_reset_heap_peak(void)
+{
+  host_heap_peak = host_heap_used;
+}
+
+/**
+*
+*/
+size_t pebble_host_heap_peak(void)
+{
+  return (host_heap_peak);
+}
+
+/**
+* Lists the objects of the app still alive by allocation site, returns
+* their number.
+*/
+uint32_t pebble_host_report_leaks(FILE *out)
+{
+  host_allocation_t *allocation = NULL;
+  host_allocation_t *other = NULL;
+  uint32_t leaks = 0;
+  uint32_t count = 0;
+  size_t bytes = 0;
+  bool reported = false;
+
+  for(allocation=host_allocations; allocation!=NULL; allocation=allocation->next)
+  {
+    if(allocation->system == true)
+    {
+      continue;
+    }
+    leaks++;
+    // one line per site, at its first allocation in the list
+    reported = false;
+    for(other=host_allocations; other!=allocation; other=other->next)
+    {
+      if((other->system == false) && (other->line == allocation->line) && (strcmp(other->file, allocation->file) == 0))
+      {
+        reported = true;
+        break;
+      }
+    }
+    if(reported == true)
+    {
+      continue;
+    }
+    count = 0;
+    bytes = 0;
+    for(other=allocation; other!=NULL; other=other->next)
+    {
+      if((other->system == false) && (other->line == allocation->line) && (strcmp(other->file, allocation->file) == 0))
+      {
+        count++;
+        bytes += other->size;
+      }
+    }
+    fprintf(out, "  leak: %s:%d %s, %u x, %u bytes\n", allocation->file, allocation->line, allocation->kind,
+            (unsigned)count, (unsigned)bytes);
+  }
+  return (leaks);
+}
+
+/**
+*
+*/
+uint32_t pebble_host_errors(void)
+{
+  return (host_errors);
+}
+
+/**
+*
+*/
+uint32_t pebble_host_pending_timers(void)
+{
+  AppTimer *timer = NULL;
+  uint32_t count = 0;
+
+  for(timer=host_timers; timer!=NULL; timer=timer->next)
+  {
+    count++;
+  }
+  return (count);
+}
+
+/**
+* Called after every frame drawn, NULL stops it.
+*/
+void pebble_host_set_frame_listener(PebbleHostFrameListener listener)
+{
+  host_frame_listener = listener;
+}
+
+/**
+* Writes the last frame as binary PBM on aplite, PPM on basalt.
+*/
+bool pebble_host_write_frame(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  uint8_t row[PEBBLE_HOST_SCREEN_WIDTH * 3];
+  GColor color;
+  int16_t x = 0;
+  int16_t y = 0;
+
+  if(file == NULL)
+  {
+    return (false);
+  }
+#ifdef PBL_BW
+  fprintf(file, "P4\n%d %d\n", PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT);
+#else
+  fprintf(file, "P6\n%d %d\n255\n", PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT);
+#endif
+  for(y=0; y<PEBBLE_HOST_SCREEN_HEIGHT; y++)
+  {
+    memset(row, 0, sizeof(row));
+    for(x=0; x<PEBBLE_HOST_SCREEN_WIDTH; x++)
+    {
+      color = host_get_pixel(host_frame_buffer, x, y);
+#ifdef PBL_BW
+      // 1 is black in a PBM, the first pixel in the highest bit
+      if(color.argb == GColorBlackARGB8)
+      {
+        row[x / 8] |= 0x80 >> (x % 8);
+      }
+#else
+      row[(x * 3) + 0] = color.r * 85;
+      row[(x * 3) + 1] = color.g * 85;
+      row[(x * 3) + 2] = color.b * 85;
+#endif
+    }
+#ifdef PBL_BW
+    fwrite(row, 1, PEBBLE_HOST_SCREEN_WIDTH / 8, file);
+#else
+    fwrite(row, 1, PEBBLE_HOST_SCREEN_WIDTH * 3, file);
+#endif
+  }
+  return (fclose(file) == 0);
+}
+
+//* ------------ app heap -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+size_t heap_bytes_used(void)
+{
+  return (host_heap_used);
+}
+
+/**
+*
+*/
+size_t heap_bytes_free(void)
+{
+  return ((host_heap_used < HEAP_SIZE) ? (HEAP_SIZE - host_heap_used) : 0);
+}
+
+/**
+*
+*/
+static void host_track(const void *object, const char *kind, size_t size, const char *file, int line, bool system)
+{
+  host_allocation_t *allocation = malloc(sizeof(host_allocation_t));
+
+  allocation->object = object;
+  allocation->kind = kind;
+  allocation->size = size + HEAP_HEADER;
+  allocation->file = file;
+  allocation->line = line;
+  allocation->system = system;
+  allocation->next = host_allocations;
+  host_allocations = allocation;
+  host_heap_used += allocation->size;
+  if(host_heap_used > host_heap_peak)
+  {
+    host_heap_peak = host_heap_used;
+  }
+  if(host_heap_used > HEAP_SIZE)
+  {
+    host_error("heap of %d bytes exhausted by %s at %s:%d", HEAP_SIZE, kind, file, line);
+  }
+}
+
+/**
+* Returns false for an object that is not alive or of another kind.
+*/
+static bool host_untrack(const void *object, const char *kind)
+{
+  host_allocation_t **link = NULL;
+  host_allocation_t *allocation = NULL;
+
+  if(object == NULL)
+  {
+    host_error("%s_destroy(NULL)", kind);
+    return (false);
+  }
+  for(link=&host_allocations; *link!=NULL; link=&(*link)->next)
+  {
+    allocation = *link;
+    if(allocation->object == object)
+    {
+      if(strcmp(allocation->kind, kind) != 0)
+      {
+        host_error("%s created at %s:%d destroyed as %s", allocation->kind, allocation->file, allocation->line, kind);
+        return (false);
+      }
+      *link = allocation->next;
+      host_heap_used -= allocation->size;
+      free(allocation);
+      return (true);
+    }
+  }
+  host_error("%s_destroy() of an object that is not alive", kind);
+  return (false);
+}
+
+/**
+*
+*/
+static bool host_tracked(const void *object)
+{
+  host_allocation_t *allocation = NULL;
+
+  for(allocation=host_allocations; allocation!=NULL; allocation=allocation->next)
+  {
+    if(allocation->object == object)
+    {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+/**
+*
+*/
+static void host_error(const char *fmt, ...)
+{
+  va_list args;
+
+  host_errors++;
+  va_start(args, fmt);
+  fprintf(stderr, "  error: ");
+  vfprintf(stderr, fmt, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+//* ------------- windows -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+Window* pebble_host_window_create(const char *file, int line)
+{
+  Window *window = calloc(1, sizeof(Window));
+
+  host_layer_init(&window->root_layer, GRect(0, 0, PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT));
+  window->root_layer.update_proc = host_window_update_proc;
+  window->background_color = GColorWhite;
+  host_track(window, "window", HEAP_WINDOW, file, line, false);
+  return (window);
+}
+
+/**
+* A window still on the stack is removed from it first, so it unloads.
+*/
+void window_destroy(Window *window)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<host_window_count; i++)
+  {
+    if(host_windows[i] == window)
+    {
+      memmove(&host_windows[i], &host_windows[i+1], (host_window_count - i - 1) * sizeof(Window *));
+      host_window_count--;
+      if((window->loaded == true) && (window->handlers.unload != NULL))
+      {
+        window->handlers.unload(window);
+      }
+      window->loaded = false;
+      break;
+    }
+  }
+  if(host_untrack(window, "window") == true)
+  {
+    host_layer_deinit(&window->root_layer);
+    free(window);
+  }
+}
+
+/**
+*
+*/
+void window_set_window_handlers(Window *window, WindowHandlers handlers)
+{
+  window->handlers = handlers;
+}
+
+/**
+*
+*/
+void window_set_fullscreen(Window *window, bool enabled)
+{
+}
+
+/**
+*
+*/
+void window_set_background_color(Window *window, GColor color)
+{
+  window->background_color = color;
+  host_mark_dirty(&window->root_layer);
+}
+
+/**
+*
+*/
+void window_set_click_config_provider(Window *window, ClickConfigProvider provider)
+{
+  window->click_config_provider = provider;
+  if(window == host_top_window())
+  {
+    host_configure_clicks(window);
+  }
+}
+
+/**
+*
+*/
+Layer* window_get_root_layer(const Window *window)
+{
+  return ((Layer *)&window->root_layer);
+}
+
+/**
+*
+*/
+void window_stack_push(Window *window, bool animated)
+{
+  if(host_window_count >= MAX_WINDOWS)
+  {
+    host_error("window stack full");
+    return;
+  }
+  host_windows[host_window_count++] = window;
+  if((window->loaded == false) && (window->handlers.load != NULL))
+  {
+    window->loaded = true;
+    window->handlers.load(window);
+  }
+  window->loaded = true;
+  if(window->handlers.appear != NULL)
+  {
+    window->handlers.appear(window);
+  }
+  host_configure_clicks(window);
+  host_mark_dirty(NULL);
+}
+
+/**
+*
+*/
+Window* window_stack_pop(bool animated)
+{
+  Window *window = host_top_window();
+
+  if(window == NULL)
+  {
+    return (NULL);
+  }
+  host_window_count--;
+  if(window->handlers.disappear != NULL)
+  {
+    window->handlers.disappear(window);
+  }
+  if(window->handlers.unload != NULL)
+  {
+    window->handlers.unload(window);
+  }
+  window->loaded = false;
+  if(host_top_window() != NULL)
+  {
+    host_configure_clicks(host_top_window());
+  }
+  host_mark_dirty(NULL);
+  return (window);
+}
+
+/**
+*
+*/
+void window_single_click_subscribe(ButtonId button, ClickHandler handler)
+{
+  if(host_configuring_window == NULL)
+  {
+    host_error("click subscribed outside of a click config provider");
+    return;
+  }
+  host_configuring_window->clicks[button].single = handler;
+}
+
+/**
+*
+*/
+void window_long_click_subscribe(ButtonId button, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler)
+{
+  if(host_configuring_window == NULL)
+  {
+    host_error("click subscribed outside of a click config provider");
+    return;
+  }
+  host_configuring_window->clicks[button].long_down = down_handler;
+  host_configuring_window->clicks[button].long_up = up_handler;
+  host_configuring_window->clicks[button].delay_ms = (delay_ms == 0) ? 500 : delay_ms;
+}
+
+/**
+*
+*/
+static Window* host_top_window(void)
+{
+  return ((host_window_count > 0) ? host_windows[host_window_count-1] : NULL);
+}
+
+/**
+*
+*/
+static void host_configure_clicks(Window *window)
+{
+  memset(window->clicks, 0, sizeof(window->clicks));
+  if(window->click_config_provider != NULL)
+  {
+    host_configuring_window = window;
+    window->click_config_provider(NULL);
+    host_configuring_window = NULL;
+  }
+}
+
+/**
+*
+*/
+static void host_window_update_proc(Layer *layer, GContext *ctx)
+{
+  Window *window = (Window *)layer;
+
+  graphics_context_set_fill_color(ctx, window->background_color);
+  graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+}
+
+//* -------------- layers -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+Layer* pebble_host_layer_create(GRect frame, const char *file, int line)
+{
+  Layer *layer = calloc(1, sizeof(Layer));
+
+  host_layer_init(layer, frame);
+  host_track(layer, "layer", HEAP_LAYER, file, line, false);
+  return (layer);
+}
+
+/**
+*
+*/
+void layer_destroy(Layer *layer)
+{
+  if(host_untrack(layer, "layer") == true)
+  {
+    host_layer_deinit(layer);
+    free(layer);
+  }
+}
+
+/**
+*
+*/
+static void host_layer_init(Layer *layer, GRect frame)
+{
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+}
+
+/**
+* Takes the layer out of the tree, its children lose their parent like
+* in the firmware.
+*/
+static void host_layer_deinit(Layer *layer)
+{
+  Layer *child = layer->first_child;
+  Layer *next = NULL;
+
+  layer_remove_from_parent(layer);
+  while(child != NULL)
+  {
+    next = child->next_sibling;
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    child = next;
+  }
+  layer->first_child = NULL;
+}
+
+/**
+*
+*/
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc)
+{
+  layer->update_proc = update_proc;
+}
+
+/**
+*
+*/
+void layer_mark_dirty(Layer *layer)
+{
+  host_mark_dirty(layer);
+}
+
+/**
+* Appended as the topmost child, a layer with a parent moves.
+*/
+void layer_add_child(Layer *parent, Layer *child)
+{
+  Layer **link = NULL;
+
+  if(child->parent != NULL)
+  {
+    layer_remove_from_parent(child);
+  }
+  for(link=&parent->first_child; *link!=NULL; link=&(*link)->next_sibling)
+  {
+  }
+  *link = child;
+  child->parent = parent;
+  child->next_sibling = NULL;
+  host_mark_dirty(child);
+}
+
+/**
+*
+*/
+void layer_remove_from_parent(Layer *child)
+{
+  Layer **link = NULL;
+
+  if(child->parent == NULL)
+  {
+    return;
+  }
+  host_mark_dirty(child);
+  for(link=&child->parent->first_child; *link!=NULL; link=&(*link)->next_sibling)
+  {
+    if(*link == child)
+    {
+      *link = child->next_sibling;
+      break;
+    }
+  }
+  child->parent = NULL;
+  child->next_sibling = NULL;
+}
+
+/**
+*
+*/
+void layer_set_hidden(Layer *layer, bool hidden)
+{
+  if(layer->hidden != hidden)
+  {
+    // the area is dirty while the layer is shown
+    host_mark_dirty(layer);
+    layer->hidden = hidden;
+    host_mark_dirty(layer);
+  }
+}
+
+/**
+*
+*/
+bool layer_get_hidden(const Layer *layer)
+{
+  return (layer->hidden);
+}
+
+/**
+*
+*/
+void layer_set_frame(Layer *layer, GRect frame)
+{
+  host_mark_dirty(layer);
+  layer->frame = frame;
+  layer->bounds.size = frame.size;
+  host_mark_dirty(layer);
+}
+
+/**
+*
+*/
+GRect layer_get_frame(const Layer *layer)
+{
+  return (layer->frame);
+}
+
+/**
+*
+*/
+GRect layer_get_bounds(const Layer *layer)
+{
+  return (layer->bounds);
+}
+
+//* ----------- text layers ------------ *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+TextLayer* pebble_host_text_layer_create(GRect frame, const char *file, int line)
+{
+  TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+
+  host_layer_init(&text_layer->layer, frame);
+  text_layer->layer.update_proc = host_text_layer_update_proc;
+  text_layer->font = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
+  text_layer->text_color = GColorBlack;
+  text_layer->background_color = GColorWhite;
+  text_layer->alignment = GTextAlignmentLeft;
+  host_track(text_layer, "text_layer", HEAP_TEXT_LAYER, file, line, false);
+  return (text_layer);
+}
+
+/**
+*
+*/
+void text_layer_destroy(TextLayer *text_layer)
+{
+  if(host_untrack(text_layer, "text_layer") == true)
+  {
+    host_layer_deinit(&text_layer->layer);
+    free(text_layer);
+  }
+}
+
+/**
+*
+*/
+Layer* text_layer_get_layer(TextLayer *text_layer)
+{
+  return (&text_layer->layer);
+}
+
+/**
+*
+*/
+void text_layer_set_text(TextLayer *text_layer, const char *text)
+{
+  text_layer->text = text;
+  host_mark_dirty(&text_layer->layer);
+}
+
+/**
+*
+*/
+void text_layer_set_font(TextLayer *text_layer, GFont font)
+{
+  text_layer->font = font;
+  host_mark_dirty(&text_layer->layer);
+}
+
+/**
+*
+*/
+void text_layer_set_text_color(TextLayer *text_layer, GColor color)
+{
+  text_layer->text_color = color;
+  host_mark_dirty(&text_layer->layer);
+}
+
+/**
+*
+*/
+void text_layer_set_background_color(TextLayer *text_layer, GColor color)
+{
+  text_layer->background_color = color;
+  host_mark_dirty(&text_layer->layer);
+}
+
+/**
+*
+*/
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment alignment)
+{
+  text_layer->alignment = alignment;
+  host_mark_dirty(&text_layer->layer);
+}
+
+/**
+*
+*/
+static void host_text_layer_update_proc(Layer *layer, GContext *ctx)
+{
+  TextLayer *text_layer = (TextLayer *)layer;
+
+  if(text_layer->background_color.argb != GColorClearARGB8)
+  {
+    graphics_context_set_fill_color(ctx, text_layer->background_color);
+    graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+  }
+  if((text_layer->text != NULL) && (text_layer->text[0] != '\0'))
+  {
+    graphics_context_set_text_color(ctx, text_layer->text_color);
+    graphics_draw_text(ctx, text_layer->text, text_layer->font, layer->bounds, GTextOverflowModeTrailingEllipsis,
+                       text_layer->alignment, NULL);
+  }
+}
+
+//* ---------- bitmap layers ----------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+BitmapLayer* pebble_host_bitmap_layer_create(GRect frame, const char *file, int line)
+{
+  BitmapLayer *bitmap_layer = calloc(1, sizeof(BitmapLayer));
+
+  host_layer_init(&bitmap_layer->layer, frame);
+  bitmap_layer->layer.update_proc = host_bitmap_layer_update_proc;
+  host_track(bitmap_layer, "bitmap_layer", HEAP_BITMAP_LAYER, file, line, false);
+  return (bitmap_layer);
+}
+
+/**
+*
+*/
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer)
+{
+  if(host_untrack(bitmap_layer, "bitmap_layer") == true)
+  {
+    host_layer_deinit(&bitmap_layer->layer);
+    free(bitmap_layer);
+  }
+}
+
+/**
+*
+*/
+Layer* bitmap_layer_get_layer(const BitmapLayer *bitmap_layer)
+{
+  return ((Layer *)&bitmap_layer->layer);
+}
+
+/**
+*
+*/
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap)
+{
+  bitmap_layer->bitmap = bitmap;
+  host_mark_dirty(&bitmap_layer->layer);
+}
+
+/**
+* Centered in the layer like the firmware does.
+*/
+static void host_bitmap_layer_update_proc(Layer *layer, GContext *ctx)
+{
+  BitmapLayer *bitmap_layer = (BitmapLayer *)layer;
+  GRect rect;
+
+  if(bitmap_layer->bitmap == NULL)
+  {
+    return;
+  }
+  rect.size = bitmap_layer->bitmap->bounds.size;
+  rect.origin.x = (layer->bounds.size.w - rect.size.w) / 2;
+  rect.origin.y = (layer->bounds.size.h - rect.size.h) / 2;
+  graphics_draw_bitmap_in_rect(ctx, bitmap_layer->bitmap, rect);
+}
+
+//* --------- action bar layer --------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+ActionBarLayer* pebble_host_action_bar_layer_create(const char *file, int line)
+{
+  ActionBarLayer *action_bar = calloc(1, sizeof(ActionBarLayer));
+
+  host_layer_init(&action_bar->layer, GRect(PEBBLE_HOST_SCREEN_WIDTH - ACTION_BAR_WIDTH, 0, ACTION_BAR_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT));
+  action_bar->layer.update_proc = host_action_bar_update_proc;
+  action_bar->background_color = GColorBlack;
+  host_track(action_bar, "action_bar_layer", HEAP_ACTION_BAR_LAYER, file, line, false);
+  return (action_bar);
+}
+
+/**
+*
+*/
+void action_bar_layer_destroy(ActionBarLayer *action_bar)
+{
+  if(host_untrack(action_bar, "action_bar_layer") == true)
+  {
+    host_layer_deinit(&action_bar->layer);
+    free(action_bar);
+  }
+}
+
+/**
+*
+*/
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, Window *window)
+{
+  action_bar->window = window;
+  layer_add_child(window_get_root_layer(window), &action_bar->layer);
+}
+
+/**
+*
+*/
+void action_bar_layer_remove_from_window(ActionBarLayer *action_bar)
+{
+  layer_remove_from_parent(&action_bar->layer);
+  if(action_bar->window != NULL)
+  {
+    action_bar->window->click_config_provider = NULL;
+    memset(action_bar->window->clicks, 0, sizeof(action_bar->window->clicks));
+  }
+  action_bar->window = NULL;
+}
+
+/**
+*
+*/
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider provider)
+{
+  if(action_bar->window == NULL)
+  {
+    host_error("action bar click config set before it was added to a window");
+    return;
+  }
+  window_set_click_config_provider(action_bar->window, provider);
+}
+
+/**
+*
+*/
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button, const GBitmap *icon)
+{
+  action_bar->icons[button] = icon;
+  host_mark_dirty(&action_bar->layer);
+}
+
+/**
+*
+*/
+void action_bar_layer_set_background_color(ActionBarLayer *action_bar, GColor color)
+{
+  action_bar->background_color = color;
+  host_mark_dirty(&action_bar->layer);
+}
+
+/**
+* Icons centered on the three buttons.
+*/
+static void host_action_bar_update_proc(Layer *layer, GContext *ctx)
+{
+  ActionBarLayer *action_bar = (ActionBarLayer *)layer;
+  const int16_t centers[NUM_BUTTONS] = {0, 24, PEBBLE_HOST_SCREEN_HEIGHT / 2, PEBBLE_HOST_SCREEN_HEIGHT - 24};
+  GRect rect;
+  uint8_t i = 0;
+
+  if(action_bar->background_color.argb != GColorClearARGB8)
+  {
+    graphics_context_set_fill_color(ctx, action_bar->background_color);
+    graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+  }
+  for(i=BUTTON_ID_UP; i<NUM_BUTTONS; i++)
+  {
+    if(action_bar->icons[i] == NULL)
+    {
+      continue;
+    }
+    rect.size = action_bar->icons[i]->bounds.size;
+    rect.origin.x = (ACTION_BAR_WIDTH - rect.size.w) / 2;
+    rect.origin.y = centers[i] - (rect.size.h / 2);
+    graphics_draw_bitmap_in_rect(ctx, action_bar->icons[i], rect);
+  }
+}
+
+//* ------------- bitmaps -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* The size of the resource comes from its PNG, the pixels take the heap
+* size_report.py estimates for the platform.
+*/
+GBitmap* pebble_host_gbitmap_create_with_resource(uint32_t resource_id, const char *file, int line)
+{
+  GBitmap *bitmap = NULL;
+  uint16_t width = 0;
+  uint16_t height = 0;
+  size_t bytes = 0;
+
+  if(host_read_png_size(resource_id, &width, &height, &bytes) == false)
+  {
+    host_error("resource %u not found", (unsigned)resource_id);
+    return (NULL);
+  }
+  bitmap = calloc(1, sizeof(GBitmap));
+  bitmap->bounds = GRect(0, 0, width, height);
+  bitmap->resource_id = resource_id;
+  host_track(bitmap, "gbitmap", HEAP_GBITMAP + bytes, file, line, false);
+  return (bitmap);
+}
+
+/**
+* Shares the pixels of base, base has to outlive it.
+*/
+GBitmap* pebble_host_gbitmap_create_as_sub_bitmap(const GBitmap *base, GRect rect, const char *file, int line)
+{
+  GBitmap *bitmap = NULL;
+
+  if((base == NULL) || (host_tracked(base) == false))
+  {
+    host_error("sub-bitmap at %s:%d of a bitmap that is not alive", file, line);
+    return (NULL);
+  }
+  if((rect.origin.x < 0) || (rect.origin.y < 0) || ((rect.origin.x + rect.size.w) > base->bounds.size.w) ||
+     ((rect.origin.y + rect.size.h) > base->bounds.size.h))
+  {
+    // the firmware clips it silently, the icon is cut off on the watch
+    host_error("sub-bitmap at %s:%d lies outside of its %dx%d base", file, line, base->bounds.size.w, base->bounds.size.h);
+  }
+  bitmap = calloc(1, sizeof(GBitmap));
+  bitmap->bounds = rect;
+  bitmap->parent = base;
+  bitmap->resource_id = base->resource_id;
+  host_track(bitmap, "gbitmap", HEAP_GBITMAP, file, line, false);
+  return (bitmap);
+}
+
+/**
+*
+*/
+void gbitmap_destroy(GBitmap *bitmap)
+{
+  host_allocation_t *allocation = NULL;
+
+  for(allocation=host_allocations; allocation!=NULL; allocation=allocation->next)
+  {
+    if((strcmp(allocation->kind, "gbitmap") == 0) && (((const GBitmap *)allocation->object)->parent == bitmap))
+    {
+      host_error("bitmap destroyed while the sub-bitmap of %s:%d still uses it", allocation->file, allocation->line);
+    }
+  }
+  if(host_untrack(bitmap, "gbitmap") == true)
+  {
+    free(bitmap);
+  }
+}
+
+/**
+*
+*/
+GRect gbitmap_get_bounds(const GBitmap *bitmap)
+{
+  return (GRect(0, 0, bitmap->bounds.size.w, bitmap->bounds.size.h));
+}
+
+/**
+* The platform variant first, like the resource packer.
+*/
+static bool host_read_png_size(uint32_t resource_id, uint16_t *width, uint16_t *height, size_t *bytes)
+{
+  const char* const suffixes[] = RESOURCE_SUFFIXES;
+  uint8_t header[26];
+  char path[128];
+  FILE *file = NULL;
+  uint8_t depth = 0;
+  uint8_t color = 0;
+  uint8_t i = 0;
+
+  if((resource_id == 0) || (resource_id > ARRAY_LENGTH(host_resources)))
+  {
+    return (false);
+  }
+  for(i=0; (i<ARRAY_LENGTH(suffixes)) && (file == NULL); i++)
+  {
+    snprintf(path, sizeof(path), "resources/images/%s%s.png", host_resources[resource_id-1], suffixes[i]);
+    file = fopen(path, "rb");
+  }
+  if(file == NULL)
+  {
+    return (false);
+  }
+  if(fread(header, 1, sizeof(header), file) != sizeof(header))
+  {
+    fclose(file);
+    return (false);
+  }
+  fclose(file);
+  *width = (header[18] << 8) | header[19];
+  *height = (header[22] << 8) | header[23];
+  depth = header[24];
+  color = header[25];
+#ifdef PBL_PLATFORM_APLITE
+  // 1 bit per pixel, rows padded to 32 bit
+  *bytes = (((*width + 31) / 32) * 4) * *height;
+#else
+  if((color == 3) && (depth <= 4))
+  {
+    // small palettes stay palettized
+    *bytes = (((*width * depth) + 7) / 8) * *height + (1 << depth);
+  }
+  else
+  {
+    *bytes = *width * *height;
+  }
+#endif
+  (void)depth;
+  (void)color;
+  return (true);
+}
+
+//* ------------ rendering ------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+GFont fonts_get_system_font(const char *font_key)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<ARRAY_LENGTH(host_fonts); i++)
+  {
+    if(strcmp(host_fonts[i].key, font_key) == 0)
+    {
+      return (&host_fonts[i]);
+    }
+  }
+  host_error("unknown font %s", font_key);
+  return (&host_fonts[0]);
+}
+
+/**
+*
+*/
+void graphics_context_set_stroke_color(GContext *ctx, GColor color)
+{
+  ctx->stroke_color = color;
+}
+
+/**
+*
+*/
+void graphics_context_set_fill_color(GContext *ctx, GColor color)
+{
+  ctx->fill_color = color;
+}
+
+/**
+*
+*/
+void graphics_context_set_text_color(GContext *ctx, GColor color)
+{
+  ctx->text_color = color;
+}
+
+/**
+*
+*/
+void graphics_draw_pixel(GContext *ctx, GPoint point)
+{
+  host_frame.other_draws++;
+  host_put_pixel(ctx, point.x, point.y, ctx->stroke_color);
+}
+
+/**
+*
+*/
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1)
+{
+  int16_t dx = abs(p1.x - p0.x);
+  int16_t dy = -abs(p1.y - p0.y);
+  int16_t sx = (p0.x < p1.x) ? 1 : -1;
+  int16_t sy = (p0.y < p1.y) ? 1 : -1;
+  int16_t error = dx + dy;
+  int16_t error2 = 0;
+
+  host_frame.other_draws++;
+  for(;;)
+  {
+    host_put_pixel(ctx, p0.x, p0.y, ctx->stroke_color);
+    if((p0.x == p1.x) && (p0.y == p1.y))
+    {
+      break;
+    }
+    error2 = 2 * error;
+    if(error2 >= dy)
+    {
+      error += dy;
+      p0.x += sx;
+    }
+    if(error2 <= dx)
+    {
+      error += dx;
+      p0.y += sy;
+    }
+  }
+}
+
+/**
+*
+*/
+void graphics_draw_rect(GContext *ctx, GRect rect)
+{
+  int16_t i = 0;
+
+  host_frame.other_draws++;
+  for(i=0; i<rect.size.w; i++)
+  {
+    host_put_pixel(ctx, rect.origin.x + i, rect.origin.y, ctx->stroke_color);
+    host_put_pixel(ctx, rect.origin.x + i, rect.origin.y + rect.size.h - 1, ctx->stroke_color);
+  }
+  for(i=1; i<(rect.size.h - 1); i++)
+  {
+    host_put_pixel(ctx, rect.origin.x, rect.origin.y + i, ctx->stroke_color);
+    host_put_pixel(ctx, rect.origin.x + rect.size.w - 1, rect.origin.y + i, ctx->stroke_color);
+  }
+}
+
+/**
+* The corners stay square. Written a row at a time, every frame starts
+* with the fill of the window.
+*/
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask)
+{
+#ifdef PBL_BW
+  bool white = ((ctx->fill_color.r + ctx->fill_color.g + ctx->fill_color.b) > 4);
+  uint8_t *row = NULL;
+  int16_t x = 0;
+#endif
+  int16_t y = 0;
+
+  host_frame.other_draws++;
+  rect.origin.x += ctx->offset.x;
+  rect.origin.y += ctx->offset.y;
+  rect = host_intersect(rect, ctx->clip);
+  if((rect.size.w <= 0) || (rect.size.h <= 0) || (ctx->fill_color.a == 0))
+  {
+    return;
+  }
+  host_frame.pixels_touched += rect.size.w * rect.size.h;
+  for(y=rect.origin.y; y<(rect.origin.y + rect.size.h); y++)
+  {
+#ifdef PBL_BW
+    row = &host_frame_buffer[y * FRAME_ROW_BYTES];
+    x = rect.origin.x;
+    while(x < (rect.origin.x + rect.size.w))
+    {
+      if(((x % 8) == 0) && ((x + 8) <= (rect.origin.x + rect.size.w)))
+      {
+        // whole bytes
+        row[x / 8] = (white == true) ? 0xFF : 0x00;
+        x += 8;
+        continue;
+      }
+      row[x / 8] = (white == true) ? (row[x / 8] | (1 << (x % 8))) : (row[x / 8] & ~(1 << (x % 8)));
+      x++;
+    }
+#else
+    memset(&host_frame_buffer[(y * FRAME_ROW_BYTES) + rect.origin.x], ctx->fill_color.argb, rect.size.w);
+#endif
+  }
+}
+
+/**
+* A hatched box in place of the pixels, it writes the whole rect like the
+* firmware does.
+*/
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect)
+{
+  GRect clip;
+  int16_t x = 0;
+  int16_t y = 0;
+  bool edge = false;
+
+  if(host_tracked(bitmap) == false)
+  {
+    host_error("draws a bitmap that was destroyed");
+    return;
+  }
+  else if((bitmap->parent != NULL) && (host_tracked(bitmap->parent) == false))
+  {
+    host_error("draws a sub-bitmap whose base was destroyed");
+    return;
+  }
+  host_frame.bitmap_draws++;
+  rect.origin.x += ctx->offset.x;
+  rect.origin.y += ctx->offset.y;
+  clip = host_intersect(rect, ctx->clip);
+  for(y=clip.origin.y; y<(clip.origin.y + clip.size.h); y++)
+  {
+    for(x=clip.origin.x; x<(clip.origin.x + clip.size.w); x++)
+    {
+      edge = (x == rect.origin.x) || (y == rect.origin.y) || (x == (rect.origin.x + rect.size.w - 1)) || (y == (rect.origin.y + rect.size.h - 1));
+      host_set_pixel(x, y, ((edge == true) || (((x + y - rect.origin.x - rect.origin.y) % 4) == 0)) ? GColorBlack : GColorWhite);
+    }
+  }
+  host_frame.pixels_touched += ((clip.size.w > 0) && (clip.size.h > 0)) ? (clip.size.w * clip.size.h) : 0;
+}
+
+/**
+* Wraps at spaces and new lines in every overflow mode, lines below the
+* box are left out.
+*/
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode,
+                        GTextAlignment alignment, void *text_attributes)
+{
+  uint8_t scale = (font->height >= 24) ? 2 : 1;
+  uint8_t advance = ((GLYPH_WIDTH + 1) * scale) + ((font->bold == true) ? 1 : 0);
+  uint16_t max_chars = (box.size.w > advance) ? (box.size.w / advance) : 1;
+  uint16_t length = 0;
+  uint16_t glyphs = 0;
+  uint16_t i = 0;
+  int16_t x = 0;
+  int16_t y = box.origin.y;
+
+  host_frame.text_draws++;
+  while((*text != '\0') && ((y == box.origin.y) || ((y + font->height) <= (box.origin.y + box.size.h))))
+  {
+    length = host_text_line(text, max_chars);
+    for(i=0, glyphs=0; i<length; i++)
+    {
+      glyphs += (((uint8_t)text[i] & 0xC0) != 0x80) ? 1 : 0;
+    }
+    x = box.origin.x;
+    if(alignment == GTextAlignmentCenter)
+    {
+      x += (box.size.w - (glyphs * advance)) / 2;
+    }
+    else if(alignment == GTextAlignmentRight)
+    {
+      x += box.size.w - (glyphs * advance);
+    }
+    for(i=0; i<length; i++)
+    {
+      if(((uint8_t)text[i] & 0xC0) != 0x80)
+      {
+        host_draw_glyph(ctx, text[i], font, x, y + ((font->height - (GLYPH_HEIGHT * scale)) / 2));
+        x += advance;
+      }
+    }
+    text += length;
+    if(*text == '\n')
+    {
+      text++;
+    }
+    while(*text == ' ')
+    {
+      text++;
+    }
+    y += font->height;
+  }
+}
+
+/**
+* The firmware draws the whole layer tree of the top window whenever any
+* layer of it is dirty.
+*/
+static void host_render(const char *cause)
+{
+  Window *window = host_top_window();
+  GContext ctx;
+  uint32_t number = host_frame.number;
+
+  if((host_dirty == false) || (window == NULL) || (window->loaded == false))
+  {
+    return;
+  }
+  host_dirty = false;
+  memset(&host_frame, 0, sizeof(host_frame));
+  host_frame.number = number + 1;
+  host_frame.time_ms = host_now_ms;
+  host_frame.cause = cause;
+  host_frame.pixels_dirty = host_dirty_pixels;
+  if(host_dirty_pixels > 0)
+  {
+    memset(host_dirty_area, 0, sizeof(host_dirty_area));
+    host_dirty_pixels = 0;
+  }
+
+  memset(&ctx, 0, sizeof(ctx));
+  host_render_layer(&window->root_layer, &ctx, GPoint(0, 0), GRect(0, 0, PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT));
+  host_compare_frame();
+  if(host_frame_listener != NULL)
+  {
+    host_frame_listener(&host_frame);
+  }
+}
+
+/**
+*
+*/
+static void host_render_layer(Layer *layer, GContext *ctx, GPoint offset, GRect clip)
+{
+  Layer *child = NULL;
+
+  if(layer->hidden == true)
+  {
+    return;
+  }
+  host_frame.layers++;
+  offset.x += layer->frame.origin.x;
+  offset.y += layer->frame.origin.y;
+  clip = host_intersect(clip, GRect(offset.x, offset.y, layer->frame.size.w, layer->frame.size.h));
+  if((clip.size.w <= 0) || (clip.size.h <= 0))
+  {
+    return;
+  }
+  offset.x += layer->bounds.origin.x;
+  offset.y += layer->bounds.origin.y;
+  if(layer->update_proc != NULL)
+  {
+    ctx->offset = offset;
+    ctx->clip = clip;
+    layer->update_proc(layer, ctx);
+  }
+  for(child=layer->first_child; child!=NULL; child=child->next_sibling)
+  {
+    host_render_layer(child, ctx, offset, clip);
+  }
+}
+
+/**
+* Adds the area of the layer on the screen to what the next frame has to
+* repaint, NULL for the whole screen. Layers hidden or outside of the top
+* window add nothing, the frame is drawn anyway.
+*/
+static void host_mark_dirty(const Layer *layer)
+{
+  Window *window = host_top_window();
+  const Layer *root = layer;
+  const Layer *parent = NULL;
+  GRect rect = GRect(0, 0, PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT);
+  int16_t x = 0;
+  int16_t y = 0;
+
+  host_dirty = true;
+  if(window == NULL)
+  {
+    return;
+  }
+  if(layer != NULL)
+  {
+    if(layer->hidden == true)
+    {
+      return;
+    }
+    rect = layer->frame;
+    for(parent=layer->parent; parent!=NULL; parent=parent->parent)
+    {
+      if(parent->hidden == true)
+      {
+        return;
+      }
+      rect.origin.x += parent->frame.origin.x + parent->bounds.origin.x;
+      rect.origin.y += parent->frame.origin.y + parent->bounds.origin.y;
+      rect = host_intersect(rect, parent->frame);
+      root = parent;
+    }
+    if(root != &window->root_layer)
+    {
+      return;
+    }
+  }
+  rect = host_intersect(rect, GRect(0, 0, PEBBLE_HOST_SCREEN_WIDTH, PEBBLE_HOST_SCREEN_HEIGHT));
+  for(y=rect.origin.y; y<(rect.origin.y + rect.size.h); y++)
+  {
+    for(x=rect.origin.x; x<(rect.origin.x + rect.size.w); x++)
+    {
+      host_dirty_pixels += 1 - host_dirty_area[(y * PEBBLE_HOST_SCREEN_WIDTH) + x];
+      host_dirty_area[(y * PEBBLE_HOST_SCREEN_WIDTH) + x] = 1;
+    }
+  }
+}
+
+/**
+*
+*/
+static GRect host_intersect(GRect a, GRect b)
+{
+  int16_t x0 = (a.origin.x > b.origin.x) ? a.origin.x : b.origin.x;
+  int16_t y0 = (a.origin.y > b.origin.y) ? a.origin.y : b.origin.y;
+  int16_t x1 = ((a.origin.x + a.size.w) < (b.origin.x + b.size.w)) ? (a.origin.x + a.size.w) : (b.origin.x + b.size.w);
+  int16_t y1 = ((a.origin.y + a.size.h) < (b.origin.y + b.size.h)) ? (a.origin.y + a.size.h) : (b.origin.y + b.size.h);
+
+  return (GRect(x0, y0, x1 - x0, y1 - y0));
+}
+
+/**
+* x and y in the layer being drawn. Clear is not drawn, aplite takes the
+* light colors as white.
+*/
+static void host_put_pixel(GContext *ctx, int16_t x, int16_t y, GColor color)
+{
+  x += ctx->offset.x;
+  y += ctx->offset.y;
+  if((x < ctx->clip.origin.x) || (y < ctx->clip.origin.y) ||
+     (x >= (ctx->clip.origin.x + ctx->clip.size.w)) || (y >= (ctx->clip.origin.y + ctx->clip.size.h)) || (color.a == 0))
+  {
+    return;
+  }
+  host_frame.pixels_touched++;
+  host_set_pixel(x, y, color);
+}
+
+/**
+* x and y on the screen, already clipped.
+*/
+static void host_set_pixel(int16_t x, int16_t y, GColor color)
+{
+  uint8_t *pixel = NULL;
+
+#ifdef PBL_BW
+  pixel = &host_frame_buffer[(y * FRAME_ROW_BYTES) + (x / 8)];
+  if((color.r + color.g + color.b) > 4)
+  {
+    *pixel |= 1 << (x % 8);
+  }
+  else
+  {
+    *pixel &= ~(1 << (x % 8));
+  }
+#else
+  pixel = &host_frame_buffer[(y * FRAME_ROW_BYTES) + x];
+  *pixel = color.argb;
+#endif
+}
+
+/**
+*
+*/
+static GColor host_get_pixel(const uint8_t *frame, int16_t x, int16_t y)
+{
+#ifdef PBL_BW
+  return (((frame[(y * FRAME_ROW_BYTES) + (x / 8)] >> (x % 8)) & 1) ? GColorWhite : GColorBlack);
+#else
+  return ((GColor8){.argb=frame[(y * FRAME_ROW_BYTES) + x]});
+#endif
+}
+
+/**
+* Bold is drawn twice, one pixel apart.
+*/
+static void host_draw_glyph(GContext *ctx, char c, GFont font, int16_t x, int16_t y)
+{
+  const uint8_t *glyph = host_glyphs[((c >= ' ') && (c <= '~')) ? (c - ' ') : ('?' - ' ')];
+  uint8_t scale = (font->height >= 24) ? 2 : 1;
+  uint8_t column = 0;
+  uint8_t row = 0;
+  uint8_t i = 0;
+
+  for(column=0; column<GLYPH_WIDTH; column++)
+  {
+    for(row=0; row<GLYPH_HEIGHT; row++)
+    {
+      if(((glyph[column] >> row) & 1) == 0)
+      {
+        continue;
+      }
+      for(i=0; i<(scale * scale); i++)
+      {
+        host_put_pixel(ctx, x + (column * scale) + (i % scale), y + (row * scale) + (i / scale), ctx->text_color);
+        if(font->bold == true)
+        {
+          host_put_pixel(ctx, x + (column * scale) + (i % scale) + 1, y + (row * scale) + (i / scale), ctx->text_color);
+        }
+      }
+    }
+  }
+}
+
+/**
+* Length in bytes of the next line of text, broken after at most
+* max_chars glyphs at the last space, or within the word if it has none.
+*/
+static uint16_t host_text_line(const char *text, uint16_t max_chars)
+{
+  uint16_t glyphs = 0;
+  uint16_t space = 0;
+  uint16_t i = 0;
+
+  for(i=0; (text[i] != '\0') && (text[i] != '\n'); i++)
+  {
+    if(((uint8_t)text[i] & 0xC0) == 0x80)
+    {
+      // rest of a UTF-8 character
+      continue;
+    }
+    if(glyphs == max_chars)
+    {
+      return ((space > 0) ? space : i);
+    }
+    space = (text[i] == ' ') ? i : space;
+    glyphs++;
+  }
+  return (i);
+}
+
+/**
+* Counts the pixels that differ from the frame before and keeps this one.
+*/
+static void host_compare_frame(void)
+{
+  int16_t x0 = PEBBLE_HOST_SCREEN_WIDTH;
+  int16_t y0 = PEBBLE_HOST_SCREEN_HEIGHT;
+  int16_t x1 = -1;
+  int16_t y1 = -1;
+  int16_t x = 0;
+  int16_t y = 0;
+
+  for(y=0; y<PEBBLE_HOST_SCREEN_HEIGHT; y++)
+  {
+    if(memcmp(&host_frame_buffer[y * FRAME_ROW_BYTES], &host_previous_frame[y * FRAME_ROW_BYTES], FRAME_ROW_BYTES) == 0)
+    {
+      continue;
+    }
+    for(x=0; x<PEBBLE_HOST_SCREEN_WIDTH; x++)
+    {
+      if(host_get_pixel(host_frame_buffer, x, y).argb != host_get_pixel(host_previous_frame, x, y).argb)
+      {
+        host_frame.pixels_changed++;
+        x0 = (x < x0) ? x : x0;
+        y0 = (y < y0) ? y : y0;
+        x1 = (x > x1) ? x : x1;
+        y1 = (y > y1) ? y : y1;
+      }
+    }
+  }
+  host_frame.changed = (host_frame.pixels_changed > 0) ? GRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1) : GRectZero;
+  memcpy(host_previous_frame, host_frame_buffer, sizeof(host_frame_buffer));
+}
+
+//* ---------- time and timers --------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler)
+{
+  host_tick_units = tick_units;
+  host_tick_handler = handler;
+}
+
+/**
+*
+*/
+void tick_timer_service_unsubscribe(void)
+{
+  host_tick_handler = NULL;
+}
+
+/**
+*
+*/
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms)
+{
+  uint16_t ms = host_now_ms % 1000;
+
+  pebble_host_time(tloc);
+  if(out_ms != NULL)
+  {
+    *out_ms = ms;
+  }
+  return (ms);
+}
+
+/**
+*
+*/
+static void host_tick(void)
+{
+  time_t now = pebble_host_time(NULL);
+  struct tm tick_time = *localtime(&now);
+  TimeUnits changed = SECOND_UNIT;
+
+  changed |= (tick_time.tm_min != host_last_tick.tm_min) ? MINUTE_UNIT : 0;
+  changed |= (tick_time.tm_hour != host_last_tick.tm_hour) ? HOUR_UNIT : 0;
+  changed |= (tick_time.tm_mday != host_last_tick.tm_mday) ? DAY_UNIT : 0;
+  host_last_tick = tick_time;
+  if((host_tick_handler != NULL) && ((changed & host_tick_units) != 0))
+  {
+    host_tick_handler(&tick_time, changed);
+  }
+}
+
+/**
+*
+*/
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *data)
+{
+  AppTimer *timer = calloc(1, sizeof(AppTimer));
+
+  timer->due_ms = host_now_ms + timeout_ms;
+  timer->callback = callback;
+  timer->data = data;
+  timer->next = host_timers;
+  host_timers = timer;
+  return (timer);
+}
+
+/**
+*
+*/
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms)
+{
+  AppTimer *pending = NULL;
+
+  for(pending=host_timers; pending!=NULL; pending=pending->next)
+  {
+    if(pending == timer)
+    {
+      timer->due_ms = host_now_ms + new_timeout_ms;
+      return (true);
+    }
+  }
+  return (false);
+}
+
+/**
+* Timers that already fired are ignored like in the firmware.
+*/
+void app_timer_cancel(AppTimer *timer)
+{
+  AppTimer **link = NULL;
+
+  for(link=&host_timers; *link!=NULL; link=&(*link)->next)
+  {
+    if(*link == timer)
+    {
+      *link = timer->next;
+      free(timer);
+      return;
+    }
+  }
+}
+
+/**
+* Fires the earliest timer due until until_ms, returns false if there is
+* none. The clock moves to its due time.
+*/
+static bool host_fire_next_timer(uint64_t until_ms)
+{
+  AppTimer **link = NULL;
+  AppTimer **earliest = NULL;
+  AppTimer *timer = NULL;
+
+  for(link=&host_timers; *link!=NULL; link=&(*link)->next)
+  {
+    if(((*link)->due_ms <= until_ms) && ((earliest == NULL) || ((*link)->due_ms <= (*earliest)->due_ms)))
+    {
+      earliest = link;
+    }
+  }
+  if(earliest == NULL)
+  {
+    return (false);
+  }
+  timer = *earliest;
+  *earliest = timer->next;
+  if(timer->due_ms > host_now_ms)
+  {
+    host_now_ms = timer->due_ms;
+  }
+  timer->callback(timer->data);
+  free(timer);
+  return (true);
+}
+
+//* ------------ AppMessage ------------ *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* The buffers belong to the firmware, they are not leaks of the app.
+*/
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound)
+{
+  if(host_inbox != NULL)
+  {
+    host_error("app_message_open() called twice");
+    return (APP_MSG_INVALID_ARGS);
+  }
+  host_inbox = calloc(1, size_inbound);
+  host_outbox = calloc(1, size_outbound);
+  host_inbox_size = size_inbound;
+  host_outbox_size = size_outbound;
+  host_track(host_inbox, "AppMessage inbox", size_inbound, __FILE__, __LINE__, true);
+  host_track(host_outbox, "AppMessage outbox", size_outbound, __FILE__, __LINE__, true);
+  return (APP_MSG_OK);
+}
+
+/**
+*
+*/
+void app_message_deregister_callbacks(void)
+{
+  host_inbox_received = NULL;
+  host_outbox_sent = NULL;
+  host_outbox_failed = NULL;
+}
+
+/**
+*
+*/
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback)
+{
+  host_inbox_received = received_callback;
+}
+
+/**
+*
+*/
+void app_message_register_outbox_sent(AppMessageOutboxSent sent_callback)
+{
+  host_outbox_sent = sent_callback;
+}
+
+/**
+*
+*/
+void app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback)
+{
+  host_outbox_failed = failed_callback;
+}
+
+/**
+*
+*/
+uint32_t app_message_inbox_size_maximum(void)
+{
+  return (656);
+}
+
+/**
+*
+*/
+uint32_t app_message_outbox_size_maximum(void)
+{
+  return (656);
+}
+
+/**
+*
+*/
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator)
+{
+  if(host_outbox == NULL)
+  {
+    return (APP_MSG_INVALID_ARGS);
+  }
+  if(host_outbox_sending == true)
+  {
+    return (APP_MSG_BUSY);
+  }
+  host_outbox[0] = 0;
+  host_outbox_iterator.buffer = host_outbox;
+  host_outbox_iterator.size = host_outbox_size;
+  host_outbox_iterator.used = 1;
+  *iterator = &host_outbox_iterator;
+  return (APP_MSG_OK);
+}
+
+/**
+* The phone acknowledges every message after MESSAGE_DELAY.
+*/
+AppMessageResult app_message_outbox_send(void)
+{
+  if((host_outbox == NULL) || (host_outbox_sending == true))
+  {
+    return (APP_MSG_BUSY);
+  }
+  host_outbox_sending = true;
+  host_outbox_due_ms = host_now_ms + MESSAGE_DELAY;
+  return (APP_MSG_OK);
+}
+
+/**
+*
+*/
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...)
+{
+  va_list sizes;
+  uint32_t size = 1 + (tuple_count * sizeof(Tuple));
+  uint8_t i = 0;
+
+  va_start(sizes, tuple_count);
+  for(i=0; i<tuple_count; i++)
+  {
+    size += va_arg(sizes, unsigned int);
+  }
+  va_end(sizes);
+  return (size);
+}
+
+/**
+*
+*/
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size)
+{
+  Tuple *tuple = NULL;
+
+  if((iter->used + sizeof(Tuple) + size) > iter->size)
+  {
+    return (DICT_NOT_ENOUGH_STORAGE);
+  }
+  tuple = (Tuple *)&iter->buffer[iter->used];
+  tuple->key = key;
+  tuple->type = TUPLE_BYTE_ARRAY;
+  tuple->length = size;
+  memcpy(tuple->value->data, data, size);
+  iter->used += sizeof(Tuple) + size;
+  iter->buffer[0]++;
+  return (DICT_OK);
+}
+
+/**
+*
+*/
+Tuple* dict_find(const DictionaryIterator *iter, const uint32_t key)
+{
+  uint32_t offset = 1;
+  uint8_t i = 0;
+  Tuple *tuple = NULL;
+
+  for(i=0; i<iter->buffer[0]; i++)
+  {
+    tuple = (Tuple *)&iter->buffer[offset];
+    if(tuple->key == key)
+    {
+      return (tuple);
+    }
+    offset += sizeof(Tuple) + tuple->length;
+  }
+  return (NULL);
+}
+
+//* ------------- storage -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+bool persist_exists(const uint32_t key)
+{
+  return (host_persist_find(key) != NULL);
+}
+
+/**
+*
+*/
+int persist_get_size(const uint32_t key)
+{
+  host_persist_entry_t *entry = host_persist_find(key);
+
+  return ((entry != NULL) ? entry->length : E_DOES_NOT_EXIST);
+}
+
+/**
+*
+*/
+int32_t persist_read_int(const uint32_t key)
+{
+  int32_t value = 0;
+
+  persist_read_data(key, &value, sizeof(value));
+  return (value);
+}
+
+/**
+*
+*/
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size)
+{
+  host_persist_entry_t *entry = host_persist_find(key);
+  size_t length = 0;
+
+  if(entry == NULL)
+  {
+    return (E_DOES_NOT_EXIST);
+  }
+  length = ((size_t)entry->length < buffer_size) ? (size_t)entry->length : buffer_size;
+  memcpy(buffer, entry->data, length);
+  return (length);
+}
+
+/**
+*
+*/
+int persist_write_int(const uint32_t key, const int32_t value)
+{
+  return (persist_write_data(key, &value, sizeof(value)));
+}
+
+/**
+* Longer data is cut like on the watch, which the app must never rely on.
+*/
+int persist_write_data(const uint32_t key, const void *data, const size_t size)
+{
+  host_persist_entry_t *entry = host_persist_find(key);
+  size_t length = (size < PERSIST_DATA_MAX_LENGTH) ? size : PERSIST_DATA_MAX_LENGTH;
+  uint32_t total = 0;
+  uint8_t i = 0;
+
+  if(size > PERSIST_DATA_MAX_LENGTH)
+  {
+    host_error("persist key 0x%04x: %u bytes cut to %d", (unsigned)key, (unsigned)size, PERSIST_DATA_MAX_LENGTH);
+  }
+  for(i=0; (i<PERSIST_KEYS) && (entry == NULL); i++)
+  {
+    if(host_persist[i].length < 0)
+    {
+      entry = &host_persist[i];
+    }
+  }
+  if(entry == NULL)
+  {
+    host_error("more than %d persist keys", PERSIST_KEYS);
+    return (E_RANGE);
+  }
+  entry->key = key;
+  entry->length = length;
+  memcpy(entry->data, data, length);
+  for(i=0; i<PERSIST_KEYS; i++)
+  {
+    total += (host_persist[i].length > 0) ? host_persist[i].length : 0;
+  }
+  if(total > PERSIST_TOTAL_SIZE)
+  {
+    host_error("persist storage of %u bytes exceeds the %d of the watch", (unsigned)total, PERSIST_TOTAL_SIZE);
+  }
+  return (length);
+}
+
+/**
+*
+*/
+int persist_delete(const uint32_t key)
+{
+  host_persist_entry_t *entry = host_persist_find(key);
+
+  if(entry == NULL)
+  {
+    return (E_DOES_NOT_EXIST);
+  }
+  entry->length = -1;
+  return (0);
+}
+
+/**
+*
+*/
+static host_persist_entry_t* host_persist_find(uint32_t key)
+{
+  uint8_t i = 0;
+
+  for(i=0; i<PERSIST_KEYS; i++)
+  {
+    if((host_persist[i].length >= 0) && (host_persist[i].key == key))
+    {
+      return (&host_persist[i]);
+    }
+  }
+  return (NULL);
+}
+
+//* --------------- misc --------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+void vibes_short_pulse(void)
+{
+}
+
+/**
+*
+*/
+void vibes_long_pulse(void)
+{
+}
+
+/**
+*
+*/
+void vibes_double_pulse(void)
+{
+}
+
+/**
+*
+*/
+void light_enable_interaction(void)
+{
+}
+
+/**
+*
+*/
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+{
+  va_list args;
+
+  if(log_level > host_log_level)
+  {
+    return;
+  }
+  va_start(args, fmt);
+  printf("  [%s] %s:%d ", (log_level <= APP_LOG_LEVEL_ERROR) ? "ERROR" : (log_level <= APP_LOG_LEVEL_WARNING) ? "WARNING" :
+         (log_level <= APP_LOG_LEVEL_INFO) ? "INFO" : "DEBUG", src_filename, src_line_number);
+  vprintf(fmt, args);
+  printf("\n");
+  va_end(args);
+}
+
+/**
+* Runs what the harness set, the app ends when it returns. Whatever the
+* app left pending ends with it.
+*/
+void app_event_loop(void)
+{
+  AppTimer *timer = NULL;
+
+  host_render("launch");
+  if(host_event_loop != NULL)
+  {
+    host_event_loop();
+  }
+  while(host_timers != NULL)
+  {
+    timer = host_timers;
+    host_timers = timer->next;
+    free(timer);
+  }
+  host_outbox_sending = false;
+}
@@ -0,0 +1,74 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER                                     
+//                                                                                  
+//  DESCRIPTION: 
+//
+//  Host tool printing every transition of the user interface state table
+//  together with the tick and auto repeat policy of each screen.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -DSCBA_HOST_BUILD -Isrc -o build/host/print_transitions tools/print_transitions.c src/scba_states.c
+//    ./build/host/print_transitions
+//                                                                          
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdio.h>
+#include "scba_states.h"
+
+//* ----------- main call -------------- *//
+//                                        //
+//* ------------------------------------ *//
+int main(void)
+{
+  uint8_t i;
+  uint8_t state;
+  uint8_t button;
+  bool handled;
+  
+  printf("%-28s %-12s %-14s %-22s %s\n", "state", "button", "guard", "action", "next state");
+  for(i=0; i<scba_transition_count; i++)
+  {
+    printf("%-28s %-12s %-14s %-22s %s\n",
+           scba_state_names[scba_transitions[i].state],
+           scba_button_names[scba_transitions[i].button],
+           scba_guard_names[scba_transitions[i].guard],
+           scba_action_names[scba_transitions[i].action],
+           scba_state_names[scba_transitions[i].next_state]);
+  }
+  
+  printf("\n%-28s %-14s %s\n", "state", "tick", "auto repeat");
+  for(state=0; state<SCBA_SCREENS; state++)
+  {
+    printf("%-28s %-14s %s\n", scba_state_names[state],
+           (scba_state_policies[state].tick_policy == SCBA_TICK_RUN) ? "run" :
+           (scba_state_policies[state].tick_policy == SCBA_TICK_FREEZE_AIR) ? "freeze air" : "freeze active",
+           (scba_state_policies[state].repeat_policy == SCBA_REPEAT_FAST) ? "fast" : "none");
+  }
+  
+  // report buttons without any row, they are silently ignored on the watch
+  printf("\nunhandled buttons:\n");
+  for(state=0; state<SCBA_SCREENS; state++)
+  {
+    for(button=0; button<CLICK_BUTTONS; button++)
+    {
+      handled = false;
+      for(i=0; i<scba_transition_count; i++)
+      {
+        if((scba_transitions[i].state == state) && (scba_transitions[i].button == button))
+        {
+          handled = true;
+        }
+      }
+      if(handled == false)
+      {
+        printf("  %-28s %s\n", scba_state_names[state], scba_button_names[button]);
+      }
+    }
+  }
+  return 0;
+}
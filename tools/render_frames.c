@@ -0,0 +1,300 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Plays a recorded ten minute scenario on the host Pebble stand-in
+//  (tools/pebble_host) and shows what every frame costs: two teams are
+//  started, a cylinder pressure arrives by telemetry and the commander
+//  opens the overview. The stand-in draws every frame into a framebuffer
+//  of the platform and counts the layers visited, the text and bitmap
+//  draw calls and the pixels written, marked dirty by the app and changed
+//  against the frame before.
+//
+//  The frames are summed up by what caused them, the second ticks split
+//  into those that change nothing on the screen, those of a new minute on
+//  the clock and those where the values of a team change. --frames lists
+//  every frame, --dump writes them as PBM (aplite) or PPM (basalt) images.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -Wall -Wno-address-of-packed-member -DPBL_PLATFORM_APLITE -Itools/pebble_host -Isrc -o build/host/render_frames tools/render_frames.c tools/pebble_host/pebble_host.c src/*.c
+//    ./build/host/render_frames [--frames] [--dump directory] [-v]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#define PEBBLE_HOST_HARNESS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pebble.h"
+#include "scba_model.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// as in main.h
+#define TEAMS 3
+#define MSG_KEY_TELEMETRY 0x000E
+
+#define SCENARIO_END 600         // in s
+
+#ifdef PBL_BW
+#define PLATFORM_NAME "aplite"
+#define FRAME_SUFFIX "pbm"
+#else
+#define PLATFORM_NAME "basalt"
+#define FRAME_SUFFIX "ppm"
+#endif
+
+enum
+{
+  STEP_CLICK,
+  STEP_HOLD,
+  STEP_TELEMETRY
+};
+
+enum
+{
+  CLASS_TICK_UNCHANGED,
+  CLASS_TICK_CLOCK,
+  CLASS_TICK_TEAM,
+  CLASS_INPUT,
+  NUM_CLASSES
+};
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint16_t at;         // in s from the launch
+  uint8_t kind;
+  uint8_t button;      // or the team for STEP_TELEMETRY
+  uint16_t value;      // pressure in bar for STEP_TELEMETRY
+}step_t;
+
+typedef struct
+{
+  uint32_t frames;
+  uint64_t layers;
+  uint64_t text_draws;
+  uint64_t bitmap_draws;
+  uint64_t other_draws;
+  uint64_t pixels_touched;
+  uint64_t pixels_dirty;
+  uint64_t pixels_changed;
+}frame_sum_t;
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+// the app state the script looks at, defined by main.h
+extern scba_team_t scba_team_data[TEAMS];
+
+static const step_t scenario[] = {
+  {2, STEP_HOLD, BUTTON_ID_UP, 0},          // fast start of the first team
+  {22, STEP_CLICK, BUTTON_ID_DOWN, 0},
+  {23, STEP_HOLD, BUTTON_ID_UP, 0},         // and of the second
+  {240, STEP_TELEMETRY, 0, 260},
+  {300, STEP_HOLD, BUTTON_ID_DOWN, 0},      // commander overview
+  {330, STEP_CLICK, BUTTON_ID_UP, 0},
+  {420, STEP_CLICK, BUTTON_ID_UP, 0}        // back to the first team
+};
+
+static const char* const class_names[NUM_CLASSES] = {
+  "tick, nothing changed", "tick, clock minute", "tick, team values", "buttons and messages"
+};
+
+static frame_sum_t sums[NUM_CLASSES];
+static uint64_t launch_ms = 0;
+static const char *dump_directory = NULL;
+static bool list_frames = false;
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void play_scenario(void);
+static void frame_listener(const pebble_host_frame_t *frame);
+static uint8_t frame_class(const pebble_host_frame_t *frame);
+static void print_sum(const char *name, const frame_sum_t *sum);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+static void play_scenario(void)
+{
+  time_t start = pebble_host_time(NULL);
+  uint8_t message[4] = {0};
+  uint8_t i = 0;
+
+  for(i=0; i<ARRAY_LENGTH(scenario); i++)
+  {
+    pebble_host_advance((start + scenario[i].at - pebble_host_time(NULL)) * 1000);
+    switch(scenario[i].kind)
+    {
+      case STEP_CLICK:
+        pebble_host_click(scenario[i].button);
+        break;
+
+      case STEP_HOLD:
+        pebble_host_long_click(scenario[i].button, 0);
+        break;
+
+      case STEP_TELEMETRY:
+        message[0] = scba_team_data[scenario[i].button].scba_team_nr;
+        message[1] = scenario[i].value & 0xFF;
+        message[2] = scenario[i].value >> 8;
+        pebble_host_receive(MSG_KEY_TELEMETRY, message, sizeof(message));
+        break;
+    }
+  }
+  pebble_host_advance((start + SCENARIO_END - pebble_host_time(NULL)) * 1000);
+}
+
+/**
+*
+*/
+static void frame_listener(const pebble_host_frame_t *frame)
+{
+  frame_sum_t *sum = &sums[frame_class(frame)];
+  uint64_t time_ms = 0;
+  char path[256];
+
+  if(frame->number == 1)
+  {
+    launch_ms = frame->time_ms;
+  }
+  time_ms = frame->time_ms - launch_ms;
+  sum->frames++;
+  sum->layers += frame->layers;
+  sum->text_draws += frame->text_draws;
+  sum->bitmap_draws += frame->bitmap_draws;
+  sum->other_draws += frame->other_draws;
+  sum->pixels_touched += frame->pixels_touched;
+  sum->pixels_dirty += frame->pixels_dirty;
+  sum->pixels_changed += frame->pixels_changed;
+
+  if(list_frames == true)
+  {
+    printf("%5u %3u:%02u.%03u %-8s %3u %4u %4u %4u %7u %7u %7u  %d,%d %dx%d\n", (unsigned)frame->number,
+           (unsigned)(time_ms / 60000), (unsigned)(time_ms / 1000) % 60, (unsigned)(time_ms % 1000),
+           frame->cause, frame->layers, frame->text_draws, frame->bitmap_draws, frame->other_draws,
+           (unsigned)frame->pixels_touched, (unsigned)frame->pixels_dirty, (unsigned)frame->pixels_changed,
+           frame->changed.origin.x, frame->changed.origin.y, frame->changed.size.w, frame->changed.size.h);
+  }
+  if(dump_directory != NULL)
+  {
+    snprintf(path, sizeof(path), "%s/frame_%05u.%s", dump_directory, (unsigned)frame->number, FRAME_SUFFIX);
+    if(pebble_host_write_frame(path) == false)
+    {
+      perror(path);
+      exit(2);
+    }
+  }
+}
+
+/**
+* A tick at a full minute changes the clock, every other tick that
+* changes a pixel changes the values of a team.
+*/
+static uint8_t frame_class(const pebble_host_frame_t *frame)
+{
+  if(strcmp(frame->cause, "tick") != 0)
+  {
+    return (CLASS_INPUT);
+  }
+  if(frame->pixels_changed == 0)
+  {
+    return (CLASS_TICK_UNCHANGED);
+  }
+  return ((((frame->time_ms / 1000) % 60) == 0) ? CLASS_TICK_CLOCK : CLASS_TICK_TEAM);
+}
+
+/**
+* Averages per frame.
+*/
+static void print_sum(const char *name, const frame_sum_t *sum)
+{
+  uint32_t frames = (sum->frames > 0) ? sum->frames : 1;
+
+  printf("%-22s %6u %6u %5u %7u %6u %8u %7u %7u\n", name, (unsigned)sum->frames,
+         (unsigned)(sum->layers / frames), (unsigned)(sum->text_draws / frames), (unsigned)(sum->bitmap_draws / frames),
+         (unsigned)(sum->other_draws / frames), (unsigned)(sum->pixels_touched / frames),
+         (unsigned)(sum->pixels_dirty / frames), (unsigned)(sum->pixels_changed / frames));
+}
+
+//* ----------- main call -------------- *//
+//                                        //
+//* ------------------------------------ *//
+int main(int argc, char *argv[])
+{
+  frame_sum_t total;
+  uint8_t c = 0;
+  int i = 0;
+
+  for(i=1; i<argc; i++)
+  {
+    if(strcmp(argv[i], "--frames") == 0)
+    {
+      list_frames = true;
+    }
+    else if((strcmp(argv[i], "--dump") == 0) && (i + 1 < argc))
+    {
+      dump_directory = argv[++i];
+    }
+    else if(strcmp(argv[i], "-v") == 0)
+    {
+      pebble_host_set_log_level(APP_LOG_LEVEL_INFO);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--frames] [--dump directory] [-v]\n", argv[0]);
+      return (2);
+    }
+  }
+
+  setenv("TZ", "UTC", 1);
+  tzset();
+  pebble_host_init();
+  pebble_host_set_frame_listener(frame_listener);
+  pebble_host_set_event_loop(play_scenario);
+
+  if(list_frames == true)
+  {
+    printf("frame    time    cause   lay text bmps draw touched   dirty changed  changed area\n");
+  }
+  pebble_app_main();
+
+  printf("%u s scenario on %s, %d pixels, averages per frame:\n", (unsigned)SCENARIO_END, PLATFORM_NAME,
+         PEBBLE_HOST_SCREEN_WIDTH * PEBBLE_HOST_SCREEN_HEIGHT);
+  printf("                       frames layers  text bitmaps  other  touched   dirty changed\n");
+  memset(&total, 0, sizeof(total));
+  for(c=0; c<NUM_CLASSES; c++)
+  {
+    print_sum(class_names[c], &sums[c]);
+    total.frames += sums[c].frames;
+    total.layers += sums[c].layers;
+    total.text_draws += sums[c].text_draws;
+    total.bitmap_draws += sums[c].bitmap_draws;
+    total.other_draws += sums[c].other_draws;
+    total.pixels_touched += sums[c].pixels_touched;
+    total.pixels_dirty += sums[c].pixels_dirty;
+    total.pixels_changed += sums[c].pixels_changed;
+  }
+  print_sum("all", &total);
+  if(pebble_host_errors() > 0)
+  {
+    printf("%u errors of the stand-in\n", (unsigned)pebble_host_errors());
+    return (1);
+  }
+  return (0);
+}
@@ -0,0 +1,679 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Sweeps the air and alarm rules of the watch over many teams on the host
+//  and reports how early or late every alarm fires compared with the air
+//  that is really left. A scenario is one bottle type, one configured
+//  breathing rate, one gauge report interval and resolution, and one true
+//  breathing profile: a base rate that changes to a factor of it after
+//  some minutes of work. The watch side follows scba_model.c and
+//  scba_rate.c: air is taken off every 30 s at the configured rate, each
+//  gauge report replaces the air and feeds the rate estimate.
+//
+//  Scenarios of one batch share everything but the true profile, so the
+//  lanes of a batch are kept as arrays and the inner loops vectorize.
+//  Batches are spread over all CPU cores. --check runs random lanes again
+//  second by second through the functions of the watch and compares.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -O3 -march=native -Wall -pthread -Isrc -o build/host/scenario_sweep tools/scenario_sweep.c src/scba_model.c src/scba_bottles.c src/scba_rate.c
+//    ./build/host/scenario_sweep [-j threads] [--by bottle|rate|interval|resolution] [--alarm 0-4] [--check count]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "scba_model.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define STEP SCBA_MODEL_BREATH_PERIOD      // in s
+#define MAX_STEPS (6 * 3600 / STEP)
+#define NEVER 0x7FFFFFFF
+#define ALARMS 5                           // third full, half full, third empty, return, mayday
+#define LEAD_RANGE 240                     // in steps either side
+#define MARGIN_RANGE 200                   // in bar either side
+
+// sweep dimensions, the true profiles are the lanes of a batch
+static const uint16_t config_rates[] = {300, 400, 500, 600, 700};  // in dliter per minute
+static const uint8_t gauge_intervals[] = {0, 5, 10, 15, 20};       // in minutes, 0: no reports
+static const uint8_t gauge_resolutions[] = {5, 10};                // in bar
+static const uint8_t change_minutes[] = {0, 5, 10, 15, 20, 25, 30, 35, 40};  // 0: no change
+static const uint8_t change_factors[] = {50, 75, 125, 150, 200};   // in percent of the base rate
+#define BASE_RATE_MIN 200                  // in dliter per minute
+#define BASE_RATE_STEP 10
+#define BASE_RATES 100
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+#define LANES (BASE_RATES * COUNT(change_minutes) * COUNT(change_factors))
+
+#define BY_BOTTLE 0
+#define BY_RATE 1
+#define BY_INTERVAL 2
+#define BY_RESOLUTION 3
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  uint8_t  bottle;
+  uint16_t rate;
+  uint8_t  interval;
+  uint8_t  resolution;
+  uint32_t lead[ALARMS][2 * LEAD_RANGE + 1];      // true crossing minus alarm, in steps
+  uint32_t margin[ALARMS][2 * MARGIN_RANGE + 1];  // true pressure at the alarm minus the threshold
+  uint32_t missed[ALARMS];                        // the alarm never came
+}batch_t;
+
+// one array per value, index is the lane
+typedef struct
+{
+  int32_t true_air[LANES];
+  int32_t true_step[LANES];
+  int32_t changed_step[LANES];
+  int32_t change_at[LANES];
+  int32_t model_air[LANES];
+  int32_t model_step[LANES];
+  int32_t ref_air[LANES];
+  int32_t est_rate[LANES];
+  int32_t fire[ALARMS][LANES];
+  int32_t fire_air[ALARMS][LANES];
+  int32_t cross[ALARMS][LANES];
+}lanes_t;
+
+typedef struct
+{
+  batch_t *batches;
+  uint32_t count;
+  volatile uint32_t next;
+}sweep_t;
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+static const char* const alarm_names[ALARMS] = {
+  "third full", "half full", "third empty", "return", "mayday"
+};
+
+static const char* const by_names[] = {"bottle", "rate", "interval", "resolution"};
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+* Thresholds of the alarms in bar.
+*/
+static void get_thresholds(const scba_pressure_levels_t *levels, int32_t *thresholds)
+{
+  thresholds[0] = levels->third_full_pressure;
+  thresholds[1] = levels->half_full_pressure;
+  thresholds[2] = levels->third_empty_pressure;
+  thresholds[3] = levels->min_pressure;
+  thresholds[4] = levels->empty_pressure;
+}
+
+/**
+* Base rate, change step and rate after the change of a lane, in dliter
+* per minute and steps.
+*/
+static void get_profile(uint32_t lane, int32_t *base_rate, int32_t *change_at, int32_t *changed_rate)
+{
+  uint32_t factor = lane % COUNT(change_factors);
+  uint32_t minute = (lane / COUNT(change_factors)) % COUNT(change_minutes);
+
+  *base_rate = BASE_RATE_MIN + (BASE_RATE_STEP * (lane / (COUNT(change_factors) * COUNT(change_minutes))));
+  *change_at = (change_minutes[minute] == 0) ? NEVER : ((change_minutes[minute] * 60) / STEP);
+  *changed_rate = (*base_rate * change_factors[factor]) / 100;
+}
+
+/**
+* Pressure a firefighter reads from the gauge, to the nearest resolution.
+* Divisions are done in double, exact for these ranges, so they vectorize.
+*/
+static inline int32_t read_gauge(int32_t air, double per_bar, double resolution)
+{
+  int32_t pressure = (int32_t)((double)air / per_bar);
+
+  return ((int32_t)(((double)pressure + (resolution / 2)) / resolution) * (int32_t)resolution);
+}
+
+/**
+* Runs all lanes of a batch, the fire and cross steps are left in lanes.
+*/
+static void run_lanes(const batch_t *batch, lanes_t *restrict lanes)
+{
+  const scba_bottle_t *bottle = &scba_bottle_types[batch->bottle];
+  const scba_pressure_levels_t *levels = &bottle->levels[SCBA_UNIT_BAR];
+  const int32_t per_bar = bottle->air_volume_in_dliter_per_bar;
+  const int32_t config_rate = batch->rate;
+  const int32_t interval_steps = (batch->interval * 60) / STEP;
+  const double interval_seconds = batch->interval * 60;
+  int32_t thresholds[ALARMS];
+  int32_t base_rate = 0;
+  int32_t changed_rate = 0;
+  int32_t readings = 0;
+  int32_t samples = 0;
+  int32_t weight = 0;
+  int32_t confidence = 0;
+  int32_t running = 0;
+  int32_t t = 0;
+  uint32_t i = 0;
+  uint8_t k = 0;
+
+  get_thresholds(levels, thresholds);
+  for(k=0; k<ALARMS; k++)
+  {
+    thresholds[k] *= per_bar;
+  }
+
+  for(i=0; i<LANES; i++)
+  {
+    get_profile(i, &base_rate, &lanes->change_at[i], &changed_rate);
+    lanes->true_step[i] = (base_rate * STEP) / 60;
+    lanes->changed_step[i] = (changed_rate * STEP) / 60;
+    lanes->true_air[i] = levels->full_pressure * per_bar;
+    lanes->model_air[i] = levels->full_pressure * per_bar;
+    lanes->model_step[i] = (config_rate * STEP) / 60;
+    lanes->ref_air[i] = 0;
+    lanes->est_rate[i] = 0;
+    for(k=0; k<ALARMS; k++)
+    {
+      lanes->fire[k][i] = NEVER;
+      lanes->fire_air[k][i] = 0;
+      lanes->cross[k][i] = NEVER;
+    }
+  }
+
+  for(t=1; t<=MAX_STEPS; t++)
+  {
+    for(i=0; i<LANES; i++)
+    {
+      int32_t step = (t > lanes->change_at[i]) ? lanes->changed_step[i] : lanes->true_step[i];
+      int32_t true_air = lanes->true_air[i] - step;
+      int32_t model_air = lanes->model_air[i] - lanes->model_step[i];
+
+      lanes->true_air[i] = (true_air > 0) ? true_air : 0;
+      lanes->model_air[i] = (model_air > 0) ? model_air : 0;
+    }
+
+    // gauge report, the same for all lanes of the batch as in scba_rate.c
+    if((interval_steps > 0) && ((t % interval_steps) == 0))
+    {
+      readings++;
+      weight = (samples < SCBA_RATE_AVERAGE_WINDOW) ? (samples + 1) : SCBA_RATE_AVERAGE_WINDOW;
+      if((readings >= 2) && (samples < SCBA_RATE_AVERAGE_WINDOW))
+      {
+        samples++;
+      }
+      confidence = (samples < SCBA_RATE_FULL_CONFIDENCE) ? samples : SCBA_RATE_FULL_CONFIDENCE;
+
+      for(i=0; i<LANES; i++)
+      {
+        int32_t air = read_gauge(lanes->true_air[i], per_bar, batch->resolution) * per_bar;
+        int32_t measured = (int32_t)((double)((lanes->ref_air[i] - air) * 60) / interval_seconds);
+        int32_t rate = 0;
+
+        measured = (measured < SCBA_RATE_MIN) ? SCBA_RATE_MIN : ((measured > SCBA_RATE_MAX) ? SCBA_RATE_MAX : measured);
+        rate = lanes->est_rate[i] + (int32_t)((double)(measured - lanes->est_rate[i]) / weight);
+        lanes->est_rate[i] = (readings >= 2) ? rate : lanes->est_rate[i];
+        lanes->ref_air[i] = air;
+        lanes->model_air[i] = air;
+        rate = ((config_rate * (SCBA_RATE_FULL_CONFIDENCE - confidence)) + (lanes->est_rate[i] * confidence)) / SCBA_RATE_FULL_CONFIDENCE;
+        lanes->model_step[i] = (rate * STEP) / 60;
+      }
+    }
+
+    for(k=0; k<ALARMS; k++)
+    {
+      const int32_t threshold = thresholds[k];
+      int32_t *restrict fire = lanes->fire[k];
+      int32_t *restrict fire_air = lanes->fire_air[k];
+      int32_t *restrict cross = lanes->cross[k];
+
+      for(i=0; i<LANES; i++)
+      {
+        int32_t hit = (fire[i] == NEVER) & (lanes->model_air[i] < threshold);
+
+        fire_air[i] = hit ? lanes->true_air[i] : fire_air[i];
+        fire[i] = hit ? t : fire[i];
+        cross[i] = ((cross[i] == NEVER) & (lanes->true_air[i] < threshold)) ? t : cross[i];
+      }
+    }
+
+    // done once the mayday came and the true air crossed it in all lanes
+    if((t % 16) == 0)
+    {
+      running = 0;
+      for(i=0; i<LANES; i++)
+      {
+        running |= (lanes->fire[ALARMS-1][i] == NEVER) | (lanes->cross[ALARMS-1][i] == NEVER);
+      }
+      if(running == 0)
+      {
+        break;
+      }
+    }
+  }
+}
+
+/**
+*
+*/
+static void run_batch(batch_t *batch, lanes_t *lanes)
+{
+  const scba_bottle_t *bottle = &scba_bottle_types[batch->bottle];
+  int32_t thresholds[ALARMS];
+  int32_t lead = 0;
+  int32_t margin = 0;
+  uint32_t i = 0;
+  uint8_t k = 0;
+
+  run_lanes(batch, lanes);
+  get_thresholds(&bottle->levels[SCBA_UNIT_BAR], thresholds);
+
+  for(k=0; k<ALARMS; k++)
+  {
+    for(i=0; i<LANES; i++)
+    {
+      if(lanes->fire[k][i] == NEVER)
+      {
+        batch->missed[k]++;
+        continue;
+      }
+      lead = lanes->cross[k][i] - lanes->fire[k][i];
+      lead = (lead < -LEAD_RANGE) ? -LEAD_RANGE : ((lead > LEAD_RANGE) ? LEAD_RANGE : lead);
+      batch->lead[k][lead + LEAD_RANGE]++;
+      margin = (lanes->fire_air[k][i] / bottle->air_volume_in_dliter_per_bar) - thresholds[k];
+      margin = (margin < -MARGIN_RANGE) ? -MARGIN_RANGE : ((margin > MARGIN_RANGE) ? MARGIN_RANGE : margin);
+      batch->margin[k][margin + MARGIN_RANGE]++;
+    }
+  }
+}
+
+/**
+* Worker, takes the next batch until none is left.
+*/
+static void* sweep_worker(void *data)
+{
+  sweep_t *sweep = data;
+  lanes_t *lanes = malloc(sizeof(lanes_t));
+  uint32_t n = 0;
+
+  if(lanes == NULL)
+  {
+    return (NULL);
+  }
+  while((n = __sync_fetch_and_add(&sweep->next, 1)) < sweep->count)
+  {
+    run_batch(&sweep->batches[n], lanes);
+  }
+  free(lanes);
+  return (NULL);
+}
+
+/**
+* Alarm steps of one lane, second by second through the watch functions.
+*/
+static void run_reference(const batch_t *batch, uint32_t lane, int32_t *fire)
+{
+  const scba_bottle_t *bottle = &scba_bottle_types[batch->bottle];
+  const scba_pressure_levels_t *levels = &bottle->levels[SCBA_UNIT_BAR];
+  scba_team_t team;
+  int32_t base_rate = 0;
+  int32_t change_at = 0;
+  int32_t changed_rate = 0;
+  int32_t true_air = 0;
+  int32_t second = 0;
+  uint16_t seconds = 0;
+  uint8_t level = 0;
+  uint8_t k = 0;
+
+  get_profile(lane, &base_rate, &change_at, &changed_rate);
+  memset(&team, 0, sizeof(team));
+  team.scba_team_bottle_type = batch->bottle;
+  team.scba_team_status = SCBA_FULL_BOTTLE_NO_ALARM;
+  team.scba_team_bottle_pressure = levels->full_pressure;
+  team.scba_team_bottle_air_volume = scba_model_air_volume(&team, bottle, SCBA_UNIT_BAR);
+  scba_rate_reset(&team.scba_team_rate);
+  true_air = team.scba_team_bottle_air_volume;
+
+  for(k=0; k<ALARMS; k++)
+  {
+    fire[k] = NEVER;
+  }
+  for(second=1; second<=(MAX_STEPS * STEP); second++)
+  {
+    if((second % STEP) == 0)
+    {
+      true_air -= ((((second / STEP) > change_at) ? changed_rate : base_rate) * STEP) / 60;
+      true_air = (true_air > 0) ? true_air : 0;
+    }
+    seconds++;
+    if(scba_model_breathe(&team, &seconds, scba_rate_get(&team.scba_team_rate, batch->rate)) == true)
+    {
+      team.scba_team_bottle_pressure = scba_model_pressure(&team, bottle, SCBA_UNIT_BAR);
+    }
+    if((batch->interval > 0) && ((second % (batch->interval * 60)) == 0))
+    {
+      team.scba_team_bottle_pressure = read_gauge(true_air, bottle->air_volume_in_dliter_per_bar, batch->resolution);
+      team.scba_team_bottle_air_volume = scba_model_air_volume(&team, bottle, SCBA_UNIT_BAR);
+      scba_rate_add_reading(&team.scba_team_rate, second, team.scba_team_bottle_air_volume);
+    }
+
+    level = scba_model_level(team.scba_team_bottle_pressure, levels);
+    for(k=0; k<ALARMS; k++)
+    {
+      if((fire[k] == NEVER) && (level > k))
+      {
+        fire[k] = second / STEP;
+      }
+    }
+  }
+}
+
+/**
+* Compares random lanes of random batches with the watch functions.
+*/
+static int check_lanes(batch_t *batches, uint32_t count, long checks)
+{
+  lanes_t *lanes = malloc(sizeof(lanes_t));
+  int32_t fire[ALARMS];
+  uint32_t lane = 0;
+  long failures = 0;
+  long n = 0;
+  uint8_t k = 0;
+  batch_t *batch = NULL;
+
+  srand(1);
+  for(n=0; n<checks; n++)
+  {
+    batch = &batches[rand() % count];
+    run_lanes(batch, lanes);
+    lane = rand() % LANES;
+    run_reference(batch, lane, fire);
+    for(k=0; k<ALARMS; k++)
+    {
+      if(fire[k] != lanes->fire[k][lane])
+      {
+        printf("differs: bottle %d rate %d interval %d resolution %d lane %u alarm %s: %d, watch %d\n", batch->bottle,
+               batch->rate / 10, batch->interval, batch->resolution, lane, alarm_names[k], lanes->fire[k][lane], fire[k]);
+        failures++;
+      }
+    }
+  }
+  printf("%ld lanes checked against the watch functions, %ld differences\n", checks, failures);
+  free(lanes);
+  return ((failures == 0) ? 0 : 1);
+}
+
+/**
+* Value at the given permille of a histogram, offset is the value of bin 0.
+*/
+static int32_t percentile(const uint64_t *hist, uint32_t bins, int32_t offset, uint32_t permille)
+{
+  uint64_t total = 0;
+  uint64_t sum = 0;
+  uint32_t i = 0;
+
+  for(i=0; i<bins; i++)
+  {
+    total += hist[i];
+  }
+  for(i=0; i<bins; i++)
+  {
+    sum += hist[i];
+    if((sum * 1000) >= (total * permille) && (sum > 0))
+    {
+      return ((int32_t)i + offset);
+    }
+  }
+  return (0);
+}
+
+/**
+* Prints one row of the summed histograms, lead in minutes.
+*/
+static void print_row(const char *label, const uint64_t *lead, const uint64_t *margin, uint64_t missed)
+{
+  uint64_t total = missed;
+  uint64_t late = 0;
+  int32_t worst = 0;
+  uint32_t i = 0;
+
+  for(i=0; i<(2 * LEAD_RANGE + 1); i++)
+  {
+    total += lead[i];
+    late += (i < LEAD_RANGE) ? lead[i] : 0;
+    if((lead[i] > 0) && (worst == 0))
+    {
+      worst = (int32_t)i - LEAD_RANGE;
+    }
+  }
+  printf("%-12s %7.2f %8.2f %6.1f %6.1f %6.1f %6.1f %7d %6d\n", label,
+         (100.0 * late) / (total ? total : 1), (100.0 * missed) / (total ? total : 1),
+         (percentile(lead, 2 * LEAD_RANGE + 1, -LEAD_RANGE, 50) * STEP) / 60.0,
+         (percentile(lead, 2 * LEAD_RANGE + 1, -LEAD_RANGE, 500) * STEP) / 60.0,
+         (percentile(lead, 2 * LEAD_RANGE + 1, -LEAD_RANGE, 950) * STEP) / 60.0,
+         (((worst < 0) ? worst : 0) * STEP) / 60.0,
+         percentile(margin, 2 * MARGIN_RANGE + 1, -MARGIN_RANGE, 50),
+         percentile(margin, 2 * MARGIN_RANGE + 1, -MARGIN_RANGE, 500));
+}
+
+/**
+*
+*/
+static void print_header(const char *label)
+{
+  printf("%-12s %7s %8s %6s %6s %6s %6s %7s %6s\n", label, "late %", "missed %", "p5", "p50", "p95", "worst", "bar p5", "p50");
+}
+
+/**
+*
+*/
+static uint32_t group_of(const batch_t *batch, uint8_t by, char *label, size_t size)
+{
+  switch(by)
+  {
+    case BY_RATE:
+      snprintf(label, size, "%d l/min", batch->rate / 10);
+      return (batch->rate);
+
+    case BY_INTERVAL:
+      snprintf(label, size, (batch->interval == 0) ? "no reports" : "%d min", batch->interval);
+      return (batch->interval);
+
+    case BY_RESOLUTION:
+      snprintf(label, size, "%d bar", batch->resolution);
+      return (batch->resolution);
+
+    default:
+      snprintf(label, size, "%s", scba_bottle_types[batch->bottle].bottle_name);
+      return (batch->bottle);
+  }
+}
+
+/**
+*
+*/
+static double seconds_since(const struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return ((now.tv_sec - start->tv_sec) + ((now.tv_usec - start->tv_usec) / 1e6));
+}
+
+/**
+*
+*/
+int main(int argc, char **argv)
+{
+  static uint64_t lead[2 * LEAD_RANGE + 1];
+  static uint64_t margin[2 * MARGIN_RANGE + 1];
+  pthread_t threads[64];
+  sweep_t sweep;
+  struct timeval start;
+  char label[16];
+  char seen_label[16];
+  long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  long checks = 0;
+  uint64_t missed = 0;
+  uint32_t group = 0;
+  uint32_t bin = 0;
+  uint32_t n = 0;
+  uint32_t m = 0;
+  uint8_t by = BY_BOTTLE;
+  uint8_t alarm = 3;
+  uint8_t k = 0;
+  int arg = 0;
+  int b = 0;
+  size_t r = 0;
+  size_t g = 0;
+  size_t s = 0;
+
+  for(arg=1; arg<argc; arg++)
+  {
+    if((strcmp(argv[arg], "-j") == 0) && ((arg + 1) < argc))
+    {
+      thread_count = atol(argv[++arg]);
+    }
+    else if((strcmp(argv[arg], "--alarm") == 0) && ((arg + 1) < argc))
+    {
+      alarm = atoi(argv[++arg]);
+    }
+    else if((strcmp(argv[arg], "--check") == 0) && ((arg + 1) < argc))
+    {
+      checks = atol(argv[++arg]);
+    }
+    else if((strcmp(argv[arg], "--by") == 0) && ((arg + 1) < argc))
+    {
+      arg++;
+      for(by=0; (by<COUNT(by_names)) && (strcmp(argv[arg], by_names[by]) != 0); by++);
+    }
+    else
+    {
+      by = COUNT(by_names);
+    }
+  }
+  if((by >= COUNT(by_names)) || (alarm >= ALARMS) ||
+     (scba_bottles_load(scba_default_bottle_catalog, SCBA_DEFAULT_BOTTLE_TYPES, 0xFF) == false))
+  {
+    fprintf(stderr, "usage: %s [-j threads] [--by bottle|rate|interval|resolution] [--alarm 0-4] [--check count]\n", argv[0]);
+    return (1);
+  }
+  thread_count = (thread_count < 1) ? 1 : ((thread_count > 64) ? 64 : thread_count);
+
+  memset(&sweep, 0, sizeof(sweep));
+  sweep.count = scba_bottle_type_count * COUNT(config_rates) * COUNT(gauge_intervals) * COUNT(gauge_resolutions);
+  sweep.batches = calloc(sweep.count, sizeof(batch_t));
+  if(sweep.batches == NULL)
+  {
+    return (1);
+  }
+  for(b=0; b<scba_bottle_type_count; b++)
+  {
+    for(r=0; r<COUNT(config_rates); r++)
+    {
+      for(g=0; g<COUNT(gauge_intervals); g++)
+      {
+        for(s=0; s<COUNT(gauge_resolutions); s++)
+        {
+          sweep.batches[n].bottle = b;
+          sweep.batches[n].rate = config_rates[r];
+          sweep.batches[n].interval = gauge_intervals[g];
+          sweep.batches[n].resolution = gauge_resolutions[s];
+          n++;
+        }
+      }
+    }
+  }
+
+  if(checks > 0)
+  {
+    return (check_lanes(sweep.batches, sweep.count, checks));
+  }
+
+  gettimeofday(&start, NULL);
+  for(n=0; n<thread_count; n++)
+  {
+    pthread_create(&threads[n], NULL, sweep_worker, &sweep);
+  }
+  for(n=0; n<thread_count; n++)
+  {
+    pthread_join(threads[n], NULL);
+  }
+  printf("%u scenarios in %u batches on %ld threads, %.2f s\n\n", sweep.count * (uint32_t)LANES, sweep.count, thread_count,
+         seconds_since(&start));
+
+  printf("lead of each alarm before the true pressure crossed its threshold, in min, negative is late;\n");
+  printf("bar is the true pressure at the alarm above its threshold\n\n");
+  print_header("alarm");
+  for(k=0; k<ALARMS; k++)
+  {
+    memset(lead, 0, sizeof(lead));
+    memset(margin, 0, sizeof(margin));
+    missed = 0;
+    for(n=0; n<sweep.count; n++)
+    {
+      for(bin=0; bin<(2 * LEAD_RANGE + 1); bin++)
+      {
+        lead[bin] += sweep.batches[n].lead[k][bin];
+      }
+      for(bin=0; bin<(2 * MARGIN_RANGE + 1); bin++)
+      {
+        margin[bin] += sweep.batches[n].margin[k][bin];
+      }
+      missed += sweep.batches[n].missed[k];
+    }
+    print_row(alarm_names[k], lead, margin, missed);
+  }
+
+  printf("\n%s alarm by %s\n\n", alarm_names[alarm], by_names[by]);
+  print_header(by_names[by]);
+  for(n=0; n<sweep.count; n++)
+  {
+    // first batch of each group, in sweep order
+    group = group_of(&sweep.batches[n], by, label, sizeof(label));
+    for(m=0; (m<n) && (group_of(&sweep.batches[m], by, seen_label, sizeof(seen_label)) != group); m++);
+    if(m < n)
+    {
+      continue;
+    }
+    memset(lead, 0, sizeof(lead));
+    memset(margin, 0, sizeof(margin));
+    missed = 0;
+    for(m=n; m<sweep.count; m++)
+    {
+      if(group_of(&sweep.batches[m], by, seen_label, sizeof(seen_label)) != group)
+      {
+        continue;
+      }
+      for(bin=0; bin<(2 * LEAD_RANGE + 1); bin++)
+      {
+        lead[bin] += sweep.batches[m].lead[alarm][bin];
+      }
+      for(bin=0; bin<(2 * MARGIN_RANGE + 1); bin++)
+      {
+        margin[bin] += sweep.batches[m].margin[alarm][bin];
+      }
+      missed += sweep.batches[m].missed[alarm];
+    }
+    print_row(label, lead, margin, missed);
+  }
+  free(sweep.batches);
+  return (0);
+}
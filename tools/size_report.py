@@ -0,0 +1,314 @@
+#!/usr/bin/env python
+#
+# Reports per platform how much of the app budget the code, the static data
+# and the resources take, and estimates the heap used right after launch.
+# Fails when one of the budgets in tools/size_budget.json is exceeded.
+#
+# Usage: python tools/size_report.py [--nm arm-none-eabi-nm] [--build build]
+#        (run from the project root after a build, the wscript runs it after
+#        every build)
+#
+# The heap estimate is the worst case: every bitmap resource named in
+# src/main.c is counted as loaded, even the ones loaded on first use, and
+# every layer created in the functions listed as per_team_functions is
+# counted once per team. Object sizes are approximations of the firmware
+# structs including the allocator header.
+#
+
+import glob
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+
+BUDGET_FILE = os.path.join('tools', 'size_budget.json')
+APPINFO_FILE = 'appinfo.json'
+RESOURCE_DIR = 'resources'
+SOURCE_DIR = 'src'
+MAIN_SOURCE = os.path.join(SOURCE_DIR, 'main.c')
+
+# nm symbol type -> section as counted by arm-none-eabi-size
+SECTIONS = {
+    't': '.text', 'T': '.text', 'w': '.text', 'W': '.text',
+    'r': '.text', 'R': '.text',
+    'd': '.data', 'D': '.data',
+    'b': '.bss', 'B': '.bss', 'c': '.bss', 'C': '.bss',
+}
+
+HEAP_HEADER = 8
+HEAP_OBJECTS = {
+    'window_create': 120,
+    'layer_create': 48,
+    'text_layer_create': 96,
+    'bitmap_layer_create': 64,
+    'action_bar_layer_create': 200,
+    'gbitmap_create_as_sub_bitmap': 24,
+}
+GBITMAP_SIZE = 24
+
+# sizes of the field types used in the packed message structs
+FIELD_SIZES = {
+    'char': 1, 'int8_t': 1, 'uint8_t': 1,
+    'int16_t': 2, 'uint16_t': 2,
+    'int32_t': 4, 'uint32_t': 4,
+}
+
+# variants the resource packer prefers per platform, most specific first
+PLATFORM_TAGS = {
+    'aplite': ['~aplite', '~bw', ''],
+    'basalt': ['~basalt', '~color', ''],
+}
+
+
+def read_png_header(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        return None
+    width, height, depth, color = struct.unpack('>IIBB', data[16:26])
+    return width, height, depth, color
+
+
+def bitmap_bytes(path, platform):
+    header = read_png_header(path)
+    if header is None:
+        return 0
+    width, height, depth, color = header
+    if platform == 'aplite':
+        # 1 bit per pixel, rows padded to 32 bit
+        row = ((width + 31) // 32) * 4
+        palette = 0
+    elif color == 3 and depth <= 4:
+        # small palettes stay palettized
+        row = (width * depth + 7) // 8
+        palette = 1 << depth
+    else:
+        row = width
+        palette = 0
+    return GBITMAP_SIZE + HEAP_HEADER + row * height + palette
+
+
+def resource_file(entry, platform):
+    base, ext = os.path.splitext(entry['file'])
+    for tag in PLATFORM_TAGS.get(platform, ['']):
+        path = os.path.join(RESOURCE_DIR, base + tag + ext)
+        if os.path.exists(path):
+            return path
+    return None
+
+
+def read_defines():
+    defines = {}
+    for path in glob.glob(os.path.join(SOURCE_DIR, '*.h')):
+        with open(path) as f:
+            for line in f:
+                match = re.match(r'\s*#define\s+(\w+)\s+([^/]+)', line)
+                if match:
+                    defines[match.group(1)] = match.group(2).strip()
+    return defines
+
+
+def evaluate(name, defines, depth=0):
+    expression = defines[name]
+    if depth > 10:
+        raise ValueError('cannot evaluate %s' % name)
+    expression = re.sub(r'[A-Za-z_]\w*',
+                        lambda m: str(evaluate(m.group(0), defines, depth + 1)),
+                        expression)
+    return int(eval(expression, {'__builtins__': {}}))
+
+
+def read_headers():
+    headers = ''
+    for path in sorted(glob.glob(os.path.join(SOURCE_DIR, '*.h'))):
+        with open(path) as f:
+            headers += f.read()
+    return headers
+
+
+def packed_offset(name, headers, defines, field=None):
+    # byte offset of field in the packed struct name, its size without field
+    match = re.search(r'typedef\s+struct\s*\{([^}]*)\}\s*__attribute__\(\(__packed__\)\)\s*%s\s*;' % name,
+                      headers)
+    if not match:
+        raise ValueError('packed struct %s not found' % name)
+    offset = 0
+    for member in re.findall(r'(\w+)\s+(\w+)\s*(?:\[(\w+)\])?\s*;', re.sub(r'//.*', '', match.group(1))):
+        kind, member_name, count = member
+        if member_name == field:
+            return offset
+        size = FIELD_SIZES[kind] if kind in FIELD_SIZES else packed_offset(kind, headers, defines)
+        if count:
+            size *= int(count) if count.isdigit() else evaluate(count, defines)
+        offset += size
+    if field:
+        raise ValueError('%s has no field %s' % (name, field))
+    return offset
+
+
+def function_bodies(source):
+    # top level functions of the repo style: name at line start, body in braces
+    bodies = {}
+    for match in re.finditer(r'^[\w\s\*]+?\b(\w+)\s*\([^;{]*\)\s*\{', source, re.M):
+        depth = 0
+        for pos in range(match.end() - 1, len(source)):
+            if source[pos] == '{':
+                depth += 1
+            elif source[pos] == '}':
+                depth -= 1
+                if depth == 0:
+                    bodies[match.group(1)] = source[match.end():pos]
+                    break
+    return bodies
+
+
+def estimate_heap(platform, budget, media):
+    with open(MAIN_SOURCE) as f:
+        source = f.read()
+    defines = read_defines()
+    teams = evaluate('SCBA_TEAMS', defines)
+    per_team = budget.get('per_team_functions', [])
+    items = []
+
+    for name, body in sorted(function_bodies(source).items()):
+        factor = teams if name in per_team else 1
+        for call, size in sorted(HEAP_OBJECTS.items()):
+            count = len(re.findall(r'\b%s\s*\(' % call, body)) * factor
+            if count:
+                items.append(('%s in %s()' % (call, name), count * (size + HEAP_HEADER)))
+
+    for resource in sorted(set(re.findall(r'RESOURCE_ID_(\w+)', source))):
+        entry = media.get(resource)
+        path = resource_file(entry, platform) if entry else None
+        if path:
+            items.append(('bitmap %s' % resource, bitmap_bytes(path, platform)))
+
+    # the buffers opened in handle_init(), dict_calc_buffer_size(1, n) = n + 8
+    # SCBA_CONFIG_SIZE(SCBA_MAX_BOTTLE_TYPES) as in src/main.h
+    headers = read_headers()
+    config_size = (packed_offset('scba_config_msg_t', headers, defines, 'bottles') +
+                   evaluate('SCBA_MAX_BOTTLE_TYPES', defines) * packed_offset('scba_bottle_cnfg_t', headers, defines))
+    sync_size = evaluate('SCBA_SYNC_MAX_BATCH_SIZE', defines)
+    items.append(('AppMessage inbox', max(config_size, sync_size) + 8 + HEAP_HEADER))
+    items.append(('AppMessage outbox', sync_size + 8 + HEAP_HEADER))
+    return items
+
+
+def object_symbols(nm, build, platform):
+    owners = {}
+    objects = []
+    for root, _, names in os.walk(os.path.join(build, platform)):
+        objects += [os.path.join(root, name) for name in names if name.endswith('.o')]
+    for path in objects:
+        source = os.path.basename(path).split('.c.')[0] + '.c'
+        try:
+            output = subprocess.check_output([nm, '--defined-only', path]).decode()
+        except (OSError, subprocess.CalledProcessError):
+            continue
+        for line in output.splitlines():
+            parts = line.split()
+            if len(parts) == 3:
+                owners[parts[2]] = source
+    return owners
+
+
+def elf_symbols(nm, elf):
+    output = subprocess.check_output([nm, '-S', '-t', 'd', '--size-sort', elf]).decode()
+    symbols = []
+    for line in output.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in SECTIONS:
+            symbols.append((parts[3], SECTIONS[parts[2]], int(parts[1])))
+    return symbols
+
+
+def report_platform(platform, nm, build, budget, media, out):
+    errors = []
+    elf = os.path.join(build, platform, 'pebble-app.elf')
+    if not os.path.exists(elf):
+        out.append('%s: %s not found, skipped' % (platform, elf))
+        return errors
+
+    symbols = elf_symbols(nm, elf)
+    owners = object_symbols(nm, build, platform)
+    totals = {'.text': 0, '.data': 0, '.bss': 0}
+    files = {}
+
+    out.append('== %s ==' % platform)
+    out.append('%-40s %-8s %-16s %8s' % ('symbol', 'section', 'file', 'bytes'))
+    for name, section, size in sorted(symbols, key=lambda s: -s[2]):
+        owner = owners.get(name, '-')
+        totals[section] += size
+        files.setdefault(owner, {'.text': 0, '.data': 0, '.bss': 0})[section] += size
+        out.append('%-40s %-8s %-16s %8d' % (name, section, owner, size))
+
+    out.append('')
+    out.append('%-16s %8s %8s %8s' % ('file', '.text', '.data', '.bss'))
+    for owner in sorted(files):
+        out.append('%-16s %8d %8d %8d' % (owner, files[owner]['.text'], files[owner]['.data'], files[owner]['.bss']))
+    static = totals['.text'] + totals['.data'] + totals['.bss']
+    out.append('%-16s %8d %8d %8d   = %d bytes' % ('total', totals['.text'], totals['.data'], totals['.bss'], static))
+
+    out.append('')
+    out.append('%-40s %8s %8s' % ('resource', 'file', 'bitmap'))
+    resources = 0
+    for name in sorted(media):
+        path = resource_file(media[name], platform)
+        if path is None:
+            continue
+        size = os.path.getsize(path)
+        resources += size
+        out.append('%-40s %8d %8d' % (os.path.basename(path), size, bitmap_bytes(path, platform)))
+    out.append('%-40s %8d' % ('total', resources))
+
+    out.append('')
+    heap = 0
+    for name, size in estimate_heap(platform, budget, media):
+        heap += size
+        out.append('%-48s %8d' % (name, size))
+    out.append('%-48s %8d' % ('heap at launch (worst case)', heap))
+
+    limits = budget.get(platform, {})
+    for key, value in (('static', static), ('resources', resources), ('heap_at_launch', heap), ('total', static + heap)):
+        if key in limits:
+            state = 'ok' if value <= limits[key] else 'OVER BUDGET'
+            out.append('budget %-16s %8d of %8d  %s' % (key, value, limits[key], state))
+            if value > limits[key]:
+                errors.append('%s: %s uses %d bytes, budget is %d' % (platform, key, value, limits[key]))
+    out.append('')
+    return errors
+
+
+def main(argv):
+    nm = 'arm-none-eabi-nm'
+    build = 'build'
+    if '--nm' in argv:
+        nm = argv[argv.index('--nm') + 1]
+    if '--build' in argv:
+        build = argv[argv.index('--build') + 1]
+
+    with open(APPINFO_FILE) as f:
+        appinfo = json.load(f)
+    with open(BUDGET_FILE) as f:
+        budget = json.load(f)
+    media = dict((entry['name'], entry) for entry in appinfo['resources']['media'])
+
+    out = []
+    errors = []
+    for platform in appinfo.get('targetPlatforms', ['aplite']):
+        errors += report_platform(platform, nm, build, budget, media, out)
+
+    text = '\n'.join(out) + '\n'
+    sys.stdout.write(text)
+    if os.path.isdir(build):
+        with open(os.path.join(build, 'size_report.txt'), 'w') as f:
+            f.write(text)
+    for error in errors:
+        sys.stderr.write('size budget exceeded: %s\n' % error)
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
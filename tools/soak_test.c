@@ -0,0 +1,518 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Runs the whole app on the host Pebble stand-in (tools/pebble_host) and
+//  looks for heap leaks. First a simulated 12 hour incident: every hour
+//  three teams are started, report their gauges by hand or by telemetry,
+//  get their alarms acknowledged and are stopped again, the commander
+//  looks at the overview, handover, ack summary and detail screens. The
+//  heap is sampled at the end of every hour, when the watch is back in the
+//  same state, so it has to stay the same. Then the app is launched and
+//  closed again and again with random buttons pressed in between, every
+//  launch in a process of its own that keeps the storage like the watch.
+//
+//  After every exit the objects still alive are reported by the line that
+//  created them. A leak, a heap that grows from hour to hour or an error of
+//  the stand-in fails the run.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -Wall -Wno-address-of-packed-member -DPBL_PLATFORM_APLITE -Itools/pebble_host -Isrc -o build/host/soak_test tools/soak_test.c tools/pebble_host/pebble_host.c src/*.c
+//    ./build/host/soak_test [--launches count] [--hours count] [--seed number] [-v]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#define PEBBLE_HOST_HARNESS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "pebble.h"
+#include "scba_model.h"
+#include "scba_states.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+// as in main.h
+#define TEAMS 3
+#define MSG_KEY_ROSTER 0x000D
+#define MSG_KEY_TELEMETRY 0x000E
+
+#define DEFAULT_LAUNCHES 40
+#define DEFAULT_HOURS 12
+#define MAX_HOURS 48
+#define RANDOM_STEPS 60          // button presses and waits per launch
+#define PRESS_TIME 300           // in ms between two presses
+#define REPORT_INTERVAL 10       // in minutes between two gauge reports of a team
+#define TEAM_DURATION 40         // in minutes a team works
+#define BAR_PER_MINUTE 6
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+// the app state the script looks at, defined by main.h
+extern scba_team_t scba_team_data[TEAMS];
+extern uint8_t screen_status;
+extern uint8_t active_scba;
+uint8_t get_scba_team_guards(uint8_t team_nr);
+
+static uint32_t incident_hours = DEFAULT_HOURS;
+static uint32_t random_seed = 1;
+static size_t hour_heap[MAX_HOURS];
+static size_t hour_peak[MAX_HOURS];
+
+//  -------- function prototypes -------  //
+//                                        //
+//  ------------------------------------  //
+static void press(ButtonId button);
+static void hold(ButtonId button, uint32_t ms);
+static void back_to_info(void);
+static void select_team(uint8_t team);
+static void start_team(uint8_t team, uint8_t team_nr, bool fast);
+static void report_pressure(uint8_t team, uint16_t pressure);
+static void ack_alarms(void);
+static void stop_team(uint8_t team);
+static void visit_screens(void);
+static void send_telemetry(uint8_t team_nr, uint16_t pressure);
+static void send_roster(void);
+static void incident_loop(void);
+static void launch_loop(void);
+static bool report_heap(void);
+static bool run_app(void (*event_loop)(void), bool (*report)(void), const char *name);
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+static void press(ButtonId button)
+{
+  pebble_host_click(button);
+  pebble_host_advance(PRESS_TIME);
+}
+
+/**
+*
+*/
+static void hold(ButtonId button, uint32_t ms)
+{
+  pebble_host_long_click(button, ms);
+  pebble_host_advance(PRESS_TIME);
+}
+
+/**
+* Closes whatever screen is open on top of the teams.
+*/
+static void back_to_info(void)
+{
+  uint8_t i = 0;
+
+  for(i=0; (i<4) && (screen_status != SCBA_INFO_SCREEN) && (screen_status != SCBA_START_SCREEN); i++)
+  {
+    switch(screen_status)
+    {
+      case SCBA_CNFG_SCREEN_NR:
+      case SCBA_CNFG_SCREEN_BOTTLE_TYPE:
+      case SCBA_CNFG_SCREEN_BOTTLE_PRESSURE:
+      case SCBA_UPDATE_PRESSURE:
+        // the input screens have no way back, take what is shown
+        press(BUTTON_ID_SELECT);
+        break;
+
+      case SCBA_DRILL_SCREEN:
+        hold(BUTTON_ID_SELECT, 0);
+        break;
+
+      default:
+        press(BUTTON_ID_UP);
+        break;
+    }
+  }
+}
+
+/**
+*
+*/
+static void select_team(uint8_t team)
+{
+  uint8_t i = 0;
+
+  back_to_info();
+  for(i=0; (i<TEAMS) && (active_scba != team); i++)
+  {
+    press(BUTTON_ID_DOWN);
+  }
+}
+
+/**
+* Fast start with the default bottle or through the team input.
+*/
+static void start_team(uint8_t team, uint8_t team_nr, bool fast)
+{
+  uint8_t i = 0;
+
+  select_team(team);
+  if(scba_team_data[team].scba_team_status != SCBA_NOT_STARTED)
+  {
+    return;
+  }
+  if(fast == true)
+  {
+    hold(BUTTON_ID_UP, 0);
+    return;
+  }
+  press(BUTTON_ID_SELECT);
+  for(i=0; (i<12) && (scba_team_data[team].scba_team_nr != team_nr); i++)
+  {
+    press(BUTTON_ID_UP);
+  }
+  press(BUTTON_ID_SELECT);
+  press(BUTTON_ID_SELECT);
+  press(BUTTON_ID_SELECT);
+}
+
+/**
+* Holds the button down for the bulk of the change, the rest one by one.
+*/
+static void report_pressure(uint8_t team, uint16_t pressure)
+{
+  uint16_t i = 0;
+
+  select_team(team);
+  if((get_scba_team_guards(team) & SCBA_GUARD_ALARM_PENDING) != 0)
+  {
+    press(BUTTON_ID_SELECT);
+  }
+  if(scba_team_data[team].scba_team_status == SCBA_NOT_STARTED)
+  {
+    return;
+  }
+  press(BUTTON_ID_SELECT);
+  if(scba_team_data[team].scba_team_bottle_pressure > (pressure + 20))
+  {
+    hold(BUTTON_ID_DOWN, (scba_team_data[team].scba_team_bottle_pressure - pressure - 10) * 50);
+  }
+  for(i=0; (i<400) && (scba_team_data[team].scba_team_bottle_pressure != pressure); i++)
+  {
+    press((scba_team_data[team].scba_team_bottle_pressure > pressure) ? BUTTON_ID_DOWN : BUTTON_ID_UP);
+  }
+  press(BUTTON_ID_SELECT);
+}
+
+/**
+*
+*/
+static void ack_alarms(void)
+{
+  uint8_t team = 0;
+
+  for(team=0; team<TEAMS; team++)
+  {
+    if((get_scba_team_guards(team) & SCBA_GUARD_ALARM_PENDING) != 0)
+    {
+      select_team(team);
+      press(BUTTON_ID_SELECT);
+    }
+  }
+}
+
+/**
+*
+*/
+static void stop_team(uint8_t team)
+{
+  select_team(team);
+  if(scba_team_data[team].scba_team_status == SCBA_NOT_STARTED)
+  {
+    return;
+  }
+  hold(BUTTON_ID_SELECT, 0);
+  if(screen_status == SCBA_STOP_MONITORING)
+  {
+    press(BUTTON_ID_SELECT);
+  }
+}
+
+/**
+* Overview, handover code, ack summary and the detail with its sectors.
+*/
+static void visit_screens(void)
+{
+  back_to_info();
+  hold(BUTTON_ID_DOWN, 0);
+  hold(BUTTON_ID_UP, 0);
+  press(BUTTON_ID_UP);
+  hold(BUTTON_ID_SELECT, 0);
+  press(BUTTON_ID_UP);
+  hold(BUTTON_ID_DOWN, 0);
+  back_to_info();
+
+  if(scba_team_data[active_scba].scba_team_status != SCBA_NOT_STARTED)
+  {
+    hold(BUTTON_ID_UP, 0);
+    hold(BUTTON_ID_DOWN, 0);
+    press(BUTTON_ID_SELECT);
+  }
+}
+
+/**
+* One reading as the phone batches them, see scba_telemetry.c.
+*/
+static void send_telemetry(uint8_t team_nr, uint16_t pressure)
+{
+  uint8_t message[4] = {team_nr, pressure & 0xFF, pressure >> 8, 0};
+
+  pebble_host_receive(MSG_KEY_TELEMETRY, message, sizeof(message));
+}
+
+/**
+*
+*/
+static void send_roster(void)
+{
+  static const uint8_t crews[][32] = {
+    "\x01" "Anna\0Ben",
+    "\x02" "Chris\0Dana\0Eli",
+    "\x03" "Anna\0Finn"
+  };
+  static const uint8_t lengths[] = {10, 16, 11};
+  uint8_t i = 0;
+
+  for(i=0; i<ARRAY_LENGTH(lengths); i++)
+  {
+    pebble_host_receive(MSG_KEY_ROSTER, crews[i], lengths[i]);
+    pebble_host_advance(PRESS_TIME);
+  }
+}
+
+/**
+* Every hour the same: team n starts at minute 1 + 4n and works for
+* TEAM_DURATION minutes, the last team reports by telemetry only.
+*/
+static void incident_loop(void)
+{
+  time_t start = pebble_host_time(NULL);
+  time_t minute_end = 0;
+  uint32_t hour = 0;
+  uint32_t minute = 0;
+  uint32_t elapsed = 0;
+  uint16_t pressure = 0;
+  uint8_t team = 0;
+
+  pebble_host_advance(2000);
+  send_roster();
+  for(hour=0; hour<incident_hours; hour++)
+  {
+    pebble_host_reset_heap_peak();
+    for(minute=0; minute<60; minute++)
+    {
+      for(team=0; team<TEAMS; team++)
+      {
+        if(minute == (1u + (4u * team)))
+        {
+          start_team(team, team + 1 + ((hour % 2) * TEAMS), (team == 0));
+          continue;
+        }
+        if((minute <= (1u + (4u * team))) || (scba_team_data[team].scba_team_status == SCBA_NOT_STARTED))
+        {
+          continue;
+        }
+        elapsed = minute - (1u + (4u * team));
+        pressure = 300 - (elapsed * BAR_PER_MINUTE);
+        if(elapsed >= TEAM_DURATION)
+        {
+          stop_team(team);
+        }
+        else if(team == (TEAMS - 1))
+        {
+          send_telemetry(scba_team_data[team].scba_team_nr, pressure);
+        }
+        else if((elapsed % REPORT_INTERVAL) == 0)
+        {
+          report_pressure(team, pressure);
+        }
+      }
+      ack_alarms();
+      if((minute == 15) || (minute == 45))
+      {
+        visit_screens();
+      }
+      minute_end = start + (hour * 3600) + ((minute + 1) * 60);
+      if(pebble_host_time(NULL) < minute_end)
+      {
+        pebble_host_advance((minute_end - pebble_host_time(NULL)) * 1000);
+      }
+    }
+    back_to_info();
+    hour_heap[hour] = heap_bytes_used();
+    hour_peak[hour] = pebble_host_heap_peak();
+  }
+}
+
+/**
+* Heap at the end of every hour of the incident, returns false if it grew.
+*/
+static bool report_heap(void)
+{
+  uint32_t hour = 0;
+  long growth = 0;
+
+  printf("  hour  heap at end  peak\n");
+  for(hour=0; hour<incident_hours; hour++)
+  {
+    printf("  %4u  %11u  %4u\n", (unsigned)(hour + 1), (unsigned)hour_heap[hour], (unsigned)hour_peak[hour]);
+  }
+  growth = (long)hour_heap[incident_hours-1] - (long)hour_heap[0];
+  for(hour=1; hour<incident_hours; hour++)
+  {
+    if(((long)hour_heap[hour] - (long)hour_heap[0]) > growth)
+    {
+      growth = (long)hour_heap[hour] - (long)hour_heap[0];
+    }
+  }
+  printf("  heap growth after the first hour: %ld bytes, %u messages sent\n", growth, (unsigned)pebble_host_outbox_count());
+  return (growth <= 0);
+}
+
+/**
+* Random buttons and waits, whatever screen they lead to.
+*/
+static void launch_loop(void)
+{
+  const ButtonId buttons[] = {BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN};
+  uint8_t step = 0;
+
+  pebble_host_advance(2000);
+  for(step=0; step<RANDOM_STEPS; step++)
+  {
+    switch(rand() % 6)
+    {
+      case 0:
+      case 1:
+        press(buttons[rand() % 3]);
+        break;
+
+      case 2:
+        hold(buttons[rand() % 3], rand() % 1500);
+        break;
+
+      case 3:
+        send_telemetry(1 + (rand() % 10), 100 + (rand() % 200));
+        break;
+
+      default:
+        pebble_host_advance((1 + (rand() % 120)) * 1000);
+        break;
+    }
+  }
+}
+
+/**
+* Launches the app in a process of its own until event_loop returns,
+* returns true if nothing leaked, the stand-in found no error and report
+* is happy.
+*/
+static bool run_app(void (*event_loop)(void), bool (*report)(void), const char *name)
+{
+  pid_t pid = 0;
+  int status = 0;
+  uint32_t leaks = 0;
+  bool passed = false;
+
+  fflush(stdout);
+  pid = fork();
+  if(pid < 0)
+  {
+    perror("fork");
+    exit(2);
+  }
+  if(pid == 0)
+  {
+    pebble_host_set_event_loop(event_loop);
+    pebble_app_main();
+    leaks = pebble_host_report_leaks(stdout);
+    passed = (leaks == 0) && (pebble_host_errors() == 0);
+    if(passed == false)
+    {
+      printf("%s: %u objects leaked, %u errors\n", name, (unsigned)leaks, (unsigned)pebble_host_errors());
+    }
+    if(report != NULL)
+    {
+      passed = (report() == true) && (passed == true);
+    }
+    fflush(stdout);
+    _exit((passed == true) ? 0 : 1);
+  }
+  waitpid(pid, &status, 0);
+  return (WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+//* ----------- main call -------------- *//
+//                                        //
+//* ------------------------------------ *//
+int main(int argc, char *argv[])
+{
+  uint32_t launches = DEFAULT_LAUNCHES;
+  uint32_t failed = 0;
+  bool incident_ok = false;
+  char name[32];
+  int i = 0;
+
+  for(i=1; i<argc; i++)
+  {
+    if((strcmp(argv[i], "--launches") == 0) && (i + 1 < argc))
+    {
+      launches = atoi(argv[++i]);
+    }
+    else if((strcmp(argv[i], "--hours") == 0) && (i + 1 < argc))
+    {
+      incident_hours = atoi(argv[++i]);
+      incident_hours = (incident_hours < 1) ? 1 : (incident_hours > MAX_HOURS) ? MAX_HOURS : incident_hours;
+    }
+    else if((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc))
+    {
+      random_seed = atoi(argv[++i]);
+    }
+    else if(strcmp(argv[i], "-v") == 0)
+    {
+      pebble_host_set_log_level(APP_LOG_LEVEL_INFO);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--launches count] [--hours count] [--seed number] [-v]\n", argv[0]);
+      return (2);
+    }
+  }
+
+  setenv("TZ", "UTC", 1);
+  tzset();
+  pebble_host_init();
+
+  printf("incident of %u hours\n", (unsigned)incident_hours);
+  incident_ok = run_app(incident_loop, report_heap, "incident");
+
+  printf("%u launch/unload cycles\n", (unsigned)launches);
+  for(i=0; i<(int)launches; i++)
+  {
+    srand(random_seed + i);
+    snprintf(name, sizeof(name), "launch %d", i + 1);
+    if(run_app(launch_loop, NULL, name) == false)
+    {
+      failed++;
+    }
+  }
+
+  printf("%u of %u launches failed\n", (unsigned)failed, (unsigned)launches);
+  printf("%s\n", ((incident_ok == true) && (failed == 0)) ? "PASS" : "FAIL");
+  return (((incident_ok == true) && (failed == 0)) ? 0 : 1);
+}
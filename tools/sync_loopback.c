@@ -0,0 +1,478 @@
+//**********************************************************************************//
+//                          PEBBLE SCBA TRACKER
+//
+//  DESCRIPTION:
+//
+//  Host stand-in for the phone relay: simulated watches start, update,
+//  acknowledge and stop teams concurrently and exchange their deltas over
+//  an in-memory loopback with random delays. One watch joins late and asks
+//  for a resend. Afterwards all watches have to show the same teams.
+//  The apply and send rules follow apply_sync_delta() and
+//  encode_sync_team() in main.c.
+//
+//  Build and run from the project root:
+//
+//    mkdir -p build/host
+//    cc -Wall -Isrc -o build/host/sync_loopback tools/sync_loopback.c src/scba_sync.c
+//    ./build/host/sync_loopback [runs]
+//
+//**********************************************************************************//
+
+//  ----------- include paths ----------  //
+//                                        //
+//  ------------------------------------  //
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scba_sync.h"
+
+//* -------- general definitions ------- *//
+//                                        //
+//* ------------------------------------ *//
+#define WATCHES 3
+#define TEAMS 3
+#define STEPS 400
+#define QUEUE_SIZE 256
+#define BATCH_SIZE (TEAMS * SCBA_SYNC_MAX_TEAM_SIZE)
+#define LATE_WATCH (WATCHES - 1)
+
+//* ------- structure definitions ------ *//
+//                                        //
+//* ------------------------------------ *//
+typedef struct
+{
+  bool     running;
+  uint8_t  team_nr;
+  uint8_t  bottle_type;
+  uint32_t start_time;
+  uint16_t air_volume;
+  uint8_t  status;
+}team_t;
+
+typedef struct
+{
+  uint8_t length;
+  uint8_t data[BATCH_SIZE];
+}message_t;
+
+typedef struct
+{
+  uint8_t  origin;
+  int32_t  clock_skew;
+  bool     online;
+  team_t   teams[TEAMS];
+  scba_sync_clock_t clocks[TEAMS][SCBA_SYNC_FIELDS];
+  uint8_t  pending[TEAMS];
+  message_t inbox[QUEUE_SIZE];  // FIFO, the relay keeps the order per receiver
+  uint16_t inbox_head;
+  uint16_t inbox_count;
+}watch_t;
+
+//* -------- global variables ---------- *//
+//                                        //
+//* ------------------------------------ *//
+static watch_t watches[WATCHES];
+static uint32_t now;
+static unsigned int missing_runs;
+
+//* ----------- functions -------------- *//
+//                                        //
+//* ------------------------------------ *//
+
+/**
+*
+*/
+static void relay(uint8_t sender, const uint8_t *data, uint8_t length)
+{
+  uint8_t i;
+
+  for(i=0; i<WATCHES; i++)
+  {
+    watch_t *w = &watches[i];
+
+    if((i == sender) || (w->online == false))
+    {
+      continue;
+    }
+    if(w->inbox_count == QUEUE_SIZE)
+    {
+      printf("inbox overflow\n");
+      exit(2);
+    }
+    message_t *m = &w->inbox[(w->inbox_head + w->inbox_count) % QUEUE_SIZE];
+    memcpy(m->data, data, length);
+    m->length = length;
+    w->inbox_count++;
+  }
+}
+
+/**
+*
+*/
+static void get_delta(const watch_t *w, uint8_t team, uint8_t type, scba_sync_delta_t *delta)
+{
+  memset(delta, 0, sizeof(*delta));
+  delta->type = type;
+  delta->team = team;
+
+  if((type == SCBA_SYNC_START) || (type == SCBA_SYNC_STOP))
+  {
+    delta->clock = w->clocks[team][SCBA_SYNC_FIELD_RUN];
+    delta->team_nr = w->teams[team].team_nr;
+    delta->bottle_type = w->teams[team].bottle_type;
+    delta->start_time = w->teams[team].start_time;
+    delta->air_volume = w->teams[team].air_volume;
+  }
+  else if(type == SCBA_SYNC_PRESSURE)
+  {
+    delta->clock = w->clocks[team][SCBA_SYNC_FIELD_AIR];
+    delta->run = w->clocks[team][SCBA_SYNC_FIELD_RUN];
+    delta->air_volume = w->teams[team].air_volume;
+  }
+  else
+  {
+    delta->clock = w->clocks[team][SCBA_SYNC_FIELD_STATUS];
+    delta->run = w->clocks[team][SCBA_SYNC_FIELD_RUN];
+    delta->status = w->teams[team].status;
+  }
+}
+
+/**
+*
+*/
+static void flush(uint8_t index)
+{
+  watch_t *w = &watches[index];
+  uint8_t buffer[BATCH_SIZE];
+  uint8_t length = 0;
+  scba_sync_delta_t delta;
+  uint8_t team;
+  uint8_t i;
+
+  if(w->online == false)
+  {
+    return;
+  }
+
+  for(team=0; team<TEAMS; team++)
+  {
+    uint8_t pending = w->pending[team];
+    const scba_sync_clock_t *clocks = w->clocks[team];
+
+    if((pending & (1 << SCBA_SYNC_FIELD_RUN)) != 0)
+    {
+      get_delta(w, team, (w->teams[team].running == true) ? SCBA_SYNC_START : SCBA_SYNC_STOP, &delta);
+      length += scba_sync_encode(&delta, &buffer[length], sizeof(buffer) - length);
+      for(i=0; i<SCBA_SYNC_FIELDS; i++)
+      {
+        if((clocks[i].stamp == clocks[SCBA_SYNC_FIELD_RUN].stamp) && (clocks[i].origin == clocks[SCBA_SYNC_FIELD_RUN].origin))
+        {
+          pending &= ~(1 << i);
+        }
+      }
+    }
+    if(w->teams[team].running == true)
+    {
+      if((pending & (1 << SCBA_SYNC_FIELD_AIR)) != 0)
+      {
+        get_delta(w, team, SCBA_SYNC_PRESSURE, &delta);
+        length += scba_sync_encode(&delta, &buffer[length], sizeof(buffer) - length);
+      }
+      if((pending & (1 << SCBA_SYNC_FIELD_STATUS)) != 0)
+      {
+        get_delta(w, team, SCBA_SYNC_ACK, &delta);
+        length += scba_sync_encode(&delta, &buffer[length], sizeof(buffer) - length);
+      }
+    }
+    w->pending[team] = 0;
+  }
+
+  if(length > 0)
+  {
+    relay(index, buffer, length);
+  }
+}
+
+/**
+*
+*/
+static void publish(watch_t *w, uint8_t team, uint8_t type)
+{
+  scba_sync_delta_t delta;
+
+  delta.type = type;
+  delta.team = team;
+  delta.run = w->clocks[team][SCBA_SYNC_FIELD_RUN];
+  delta.clock = scba_sync_local_clock(w->clocks[team], type, now + w->clock_skew, w->origin);
+  scba_sync_merge(w->clocks[team], &delta);
+  w->pending[team] |= scba_sync_fields(type);
+}
+
+/**
+*
+*/
+static void local_change(watch_t *w)
+{
+  uint8_t team = rand() % TEAMS;
+  team_t *t = &w->teams[team];
+
+  if(t->running == false)
+  {
+    t->running = true;
+    t->team_nr = 1 + (rand() % 10);
+    t->bottle_type = rand() % 6;
+    t->start_time = now + w->clock_skew;
+    t->air_volume = 1500 + (rand() % 500);
+    t->status = 1;
+    publish(w, team, SCBA_SYNC_START);
+    return;
+  }
+
+  switch(rand() % 5)
+  {
+    case 0:
+      t->running = false;
+      publish(w, team, SCBA_SYNC_STOP);
+      break;
+
+    case 1:
+      t->status = 3 + 2 * (rand() % 4);
+      publish(w, team, SCBA_SYNC_ACK);
+      break;
+
+    default:
+      t->air_volume = rand() % 2000;
+      publish(w, team, SCBA_SYNC_PRESSURE);
+      break;
+  }
+}
+
+/**
+*
+*/
+static void apply(watch_t *w, uint8_t index, const scba_sync_delta_t *delta)
+{
+  team_t *t = &w->teams[delta->team];
+  uint8_t resend = SCBA_SYNC_RESEND_REQUEST;
+  uint8_t won;
+
+  if(scba_sync_missing_run(w->clocks[delta->team], delta) == true)
+  {
+    missing_runs++;
+    relay(index, &resend, 1);
+    return;
+  }
+
+  won = scba_sync_merge(w->clocks[delta->team], delta);
+
+  if((won == 0) || ((delta->type != SCBA_SYNC_START) && (delta->type != SCBA_SYNC_STOP) && (t->running == false)))
+  {
+    return;
+  }
+
+  switch(delta->type)
+  {
+    case SCBA_SYNC_STOP:
+      t->running = false;
+      return;
+
+    case SCBA_SYNC_START:
+      t->running = true;
+      t->team_nr = delta->team_nr;
+      t->bottle_type = delta->bottle_type;
+      t->start_time = delta->start_time;
+      t->status = 1;
+      break;
+
+    case SCBA_SYNC_ACK:
+      t->status = delta->status;
+      break;
+
+    default:
+      break;
+  }
+
+  if((won & (1 << SCBA_SYNC_FIELD_AIR)) != 0)
+  {
+    t->air_volume = delta->air_volume;
+  }
+}
+
+/**
+*
+*/
+static void receive(uint8_t index)
+{
+  watch_t *w = &watches[index];
+  message_t *m;
+  scba_sync_delta_t delta;
+  uint8_t offset = 0;
+  uint8_t used;
+  uint8_t team;
+
+  if(w->inbox_count == 0)
+  {
+    return;
+  }
+  m = &w->inbox[w->inbox_head];
+  w->inbox_head = (w->inbox_head + 1) % QUEUE_SIZE;
+  w->inbox_count--;
+
+  if((m->length == 1) && (m->data[0] == SCBA_SYNC_RESEND_REQUEST))
+  {
+    for(team=0; team<TEAMS; team++)
+    {
+      if(w->clocks[team][SCBA_SYNC_FIELD_RUN].stamp != 0)
+      {
+        w->pending[team] |= SCBA_SYNC_ALL_FIELDS;
+      }
+    }
+    return;
+  }
+
+  while(offset < m->length)
+  {
+    used = scba_sync_decode(&m->data[offset], m->length - offset, &delta);
+    if(used == 0)
+    {
+      printf("undecodable message\n");
+      exit(2);
+    }
+    offset += used;
+    apply(w, index, &delta);
+  }
+}
+
+/**
+*
+*/
+static bool same_teams(const team_t *a, const team_t *b)
+{
+  if(a->running != b->running)
+  {
+    return (false);
+  }
+  if(a->running == false)
+  {
+    return (true);
+  }
+  return ((a->team_nr == b->team_nr) && (a->bottle_type == b->bottle_type) && (a->start_time == b->start_time) &&
+          (a->air_volume == b->air_volume) && (a->status == b->status));
+}
+
+/**
+*
+*/
+static bool run(unsigned int seed)
+{
+  uint8_t resend = SCBA_SYNC_RESEND_REQUEST;
+  uint16_t step;
+  uint8_t i;
+  uint8_t team;
+  bool busy = true;
+
+  srand(seed);
+  memset(watches, 0, sizeof(watches));
+  now = 1000000;
+
+  for(i=0; i<WATCHES; i++)
+  {
+    watches[i].origin = i + 1;
+    watches[i].clock_skew = (rand() % 11) - 5;
+    watches[i].online = (i != LATE_WATCH);
+  }
+
+  for(step=0; step<STEPS; step++)
+  {
+    now += rand() % 3;
+    i = rand() % WATCHES;
+
+    if((step == STEPS / 2) && (watches[LATE_WATCH].online == false))
+    {
+      // the late watch connects, pushes its teams and asks for the others
+      watches[LATE_WATCH].online = true;
+      for(team=0; team<TEAMS; team++)
+      {
+        if(watches[LATE_WATCH].clocks[team][SCBA_SYNC_FIELD_RUN].stamp != 0)
+        {
+          watches[LATE_WATCH].pending[team] |= SCBA_SYNC_ALL_FIELDS;
+        }
+      }
+      relay(LATE_WATCH, &resend, 1);
+    }
+
+    switch(rand() % 4)
+    {
+      case 0:
+        local_change(&watches[i]);
+        break;
+
+      case 1:
+        flush(i);
+        break;
+
+      default:
+        receive(i);
+        break;
+    }
+  }
+
+  // quiet phase, deliver everything
+  while(busy == true)
+  {
+    busy = false;
+    for(i=0; i<WATCHES; i++)
+    {
+      flush(i);
+      receive(i);
+    }
+    for(i=0; i<WATCHES; i++)
+    {
+      if(watches[i].inbox_count > 0)
+      {
+        busy = true;
+      }
+      for(team=0; team<TEAMS; team++)
+      {
+        if(watches[i].pending[team] != 0)
+        {
+          busy = true;
+        }
+      }
+    }
+  }
+
+  for(i=1; i<WATCHES; i++)
+  {
+    for(team=0; team<TEAMS; team++)
+    {
+      if(same_teams(&watches[0].teams[team], &watches[i].teams[team]) == false)
+      {
+        printf("seed %u: watch %d differs from watch 1 in team slot %d\n", seed, i + 1, team + 1);
+        return (false);
+      }
+    }
+  }
+  return (true);
+}
+
+//* ----------- main call -------------- *//
+//                                        //
+//* ------------------------------------ *//
+int main(int argc, char **argv)
+{
+  unsigned int runs = (argc > 1) ? (unsigned int)atoi(argv[1]) : 1000;
+  unsigned int failed = 0;
+  unsigned int seed;
+
+  for(seed=1; seed<=runs; seed++)
+  {
+    if(run(seed) == false)
+    {
+      failed++;
+    }
+  }
+
+  printf("%u runs, %u watches, %u diverged, %u resend requests for missing starts\n", runs, WATCHES, failed, missing_runs);
+  return ((failed == 0) ? 0 : 1);
+}